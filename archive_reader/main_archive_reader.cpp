@@ -0,0 +1,69 @@
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "../omp_soa/trajectory_archive.h"
+
+// lettore d'esempio degli archivi di traiettorie scritti dal driver SoA (trajectory_archive_on): senza time step
+// decodifica tutto l'archivio in streaming stampando centro e velocità media dello stormo ogni print_interval frame,
+// con un time step salta al keyframe precedente tramite l'indice e decodifica solo il frame richiesto
+// uso: PP_mid_assignment_archive_reader <archivio> [time step]
+
+#define print_interval 100
+
+static void print_frame(const TrajectoryFrame& frame)
+{
+    double cx = 0.0, cy = 0.0, speed = 0.0;
+    for (int i = 0; i < frame.count; ++i) {
+        cx += frame.x[i];
+        cy += frame.y[i];
+        speed += std::sqrt(frame.vx[i] * frame.vx[i] + frame.vy[i] * frame.vy[i]);
+    }
+    const int count = frame.count > 0 ? frame.count : 1;
+    std::cout << "frame " << frame.frame << " (time step " << frame.step << (frame.keyframe ? ", keyframe" : "") << "): centro ("
+              << cx / count << ", " << cy / count << "), velocità media " << speed / count << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <archive> [time step]" << std::endl;
+        return 1;
+    }
+
+    TrajectoryArchiveReader reader;
+    if (!reader.open(argv[1]))
+        return 1;
+    const ArchiveFileHeader& header = reader.header();
+    std::cout << "Archivio " << argv[1] << ": " << header.count << " boids, " << reader.frames() << " frame, "
+              << reader.keyframes().size() << " keyframe (uno ogni " << header.keyframeInterval << " frame), passo posizioni "
+              << header.positionStep << ", passo velocità " << header.velocityStep << "." << std::endl;
+
+    TrajectoryFrame frame;
+    if (argc > 2) {
+        // accesso casuale
+        const auto start = std::chrono::steady_clock::now();
+        if (!reader.seek(std::atoll(argv[2]), frame)) {
+            std::cerr << "Time step " << argv[2] << " not found." << std::endl;
+            return 1;
+        }
+        print_frame(frame);
+        std::cout << "Decodificato in " << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1000.0 << " ms." << std::endl;
+        return 0;
+    }
+
+    // streaming di tutto l'archivio
+    const auto start = std::chrono::steady_clock::now();
+    long long framesRead = 0;
+    while (reader.next(frame)) {
+        if (frame.frame % print_interval == 0)
+            print_frame(frame);
+        framesRead++;
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Frame decodificati: " << framesRead << " in " << seconds << " secondi (" << framesRead / std::max(1e-9, seconds)
+              << " frame/s)." << std::endl;
+    return framesRead == reader.frames() ? 0 : 1;
+}
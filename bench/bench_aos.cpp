@@ -0,0 +1,137 @@
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "../omp_aos/boids_omp_aos.h"
+#include "../omp_aos/spatial_grid.h"
+#include "bench_distributions.h"
+#include "bench_memory.h"
+
+// microbenchmark del motore AoS: griglia (hash map), query dei vicini, kernel per singolo boid e time step completo
+
+// numero di boids su cui si misura il kernel per singolo boid (le liste dei vicini sono precalcolate)
+#define kernel_sample_size 256
+
+static std::vector<Boid> make_boids(const benchmark::State& state)
+{
+    const std::vector<BoidSample> samples = make_distribution(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    std::vector<Boid> boids(samples.size());
+    for (size_t i = 0; i < samples.size(); ++i)
+        boids[i] = {samples[i].x, samples[i].y, samples[i].vx, samples[i].vy};
+    return boids;
+}
+
+#if alloc_tracking_on
+// allocazioni per time step a regime, byte per boid e picco di memoria (contatori in bench_memory.h)
+static void BM_AosStepMemory(benchmark::State& state)
+{
+    const AllocSnapshot start = memory_probe_begin();
+    std::vector<Boid> boids = make_boids(state);
+    std::vector<Boid> new_boids(boids.size());
+    AosWorkspace workspace;
+    Boid* current = boids.data();
+    Boid* next = new_boids.data();
+    auto advance = [&]() {
+        update_all_boids(current, next, static_cast<int>(boids.size()), workspace, bench_delta_time, bench_window_width, bench_window_height);
+        std::swap(current, next);
+    };
+    for (int step = 0; step < alloc_warmup_steps; ++step)
+        advance();
+
+    const AllocSnapshot steady = alloc_snapshot();
+    for (auto _ : state) {
+        advance();
+        benchmark::DoNotOptimize(current);
+    }
+    set_memory_counters(state, start, steady, static_cast<int>(boids.size()));
+    state.SetItemsProcessed(state.iterations() * boids.size());
+    state.SetLabel(distribution_name(static_cast<int>(state.range(0))));
+}
+BENCHMARK(BM_AosStepMemory)->ArgsProduct({{DIST_UNIFORM}, {1000, 10000, 100000}})->ArgNames({"dist", "n"})->Iterations(memory_bench_iterations)->Unit(benchmark::kMillisecond)->UseRealTime();
+#endif
+
+// costruzione della griglia da zero (come avviene ad ogni time step)
+static void BM_AosGridBuild(benchmark::State& state)
+{
+    std::vector<Boid> boids = make_boids(state);
+    for (auto _ : state) {
+        SpatialGrid grid(bench_cell_size);
+        grid.clear();
+        for (Boid& boid : boids)
+            grid.insert(&boid);
+        benchmark::DoNotOptimize(grid.cells.size());
+    }
+    state.SetItemsProcessed(state.iterations() * boids.size());
+    state.SetLabel(distribution_name(static_cast<int>(state.range(0))));
+}
+BENCHMARK(BM_AosGridBuild)->BENCH_DISTRIBUTION_ARGS;
+
+// query dei vicini (cella + 8 adiacenti) per tutti i boids
+static void BM_AosGridQuery(benchmark::State& state)
+{
+    std::vector<Boid> boids = make_boids(state);
+    SpatialGrid grid(bench_cell_size);
+    for (Boid& boid : boids)
+        grid.insert(&boid);
+
+    long long candidates = 0;
+    for (auto _ : state) {
+        for (Boid& boid : boids) {
+            const std::vector<Boid*> neighbors = grid.get_neighbors(&boid);
+            candidates += neighbors.size();
+            benchmark::DoNotOptimize(neighbors.data());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * boids.size());
+    state.counters["candidates_per_boid"] = benchmark::Counter(static_cast<double>(candidates) / (state.iterations() * boids.size()));
+    state.SetLabel(distribution_name(static_cast<int>(state.range(0))));
+}
+BENCHMARK(BM_AosGridQuery)->BENCH_DISTRIBUTION_ARGS;
+
+// kernel update_boid_position isolato, su liste di vicini già copiate
+static void BM_AosUpdateBoidPosition(benchmark::State& state)
+{
+    std::vector<Boid> boids = make_boids(state);
+    SpatialGrid grid(bench_cell_size);
+    for (Boid& boid : boids)
+        grid.insert(&boid);
+
+    // liste dei vicini in formato compatto (offset + array piatto) per un campione di boids
+    const int sampleSize = std::min<int>(kernel_sample_size, static_cast<int>(boids.size()));
+    std::vector<Boid> neighbors;
+    std::vector<int> offsets = {0};
+    for (int i = 0; i < sampleSize; ++i) {
+        for (Boid* np : grid.get_neighbors(&boids[i]))
+            neighbors.push_back(*np);
+        offsets.push_back(static_cast<int>(neighbors.size()));
+    }
+
+    for (auto _ : state) {
+        for (int i = 0; i < sampleSize; ++i) {
+            Boid boid = boids[i];
+            update_boid_position(&boid, &neighbors[offsets[i]], offsets[i + 1] - offsets[i], bench_delta_time, bench_window_width, bench_window_height);
+            benchmark::DoNotOptimize(boid);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * sampleSize);
+    state.counters["interactions_per_s"] = benchmark::Counter(static_cast<double>(state.iterations()) * neighbors.size(), benchmark::Counter::kIsRate);
+    state.SetLabel(distribution_name(static_cast<int>(state.range(0))));
+}
+BENCHMARK(BM_AosUpdateBoidPosition)->BENCH_DISTRIBUTION_ARGS->Unit(benchmark::kMicrosecond);
+
+// time step completo (griglia + update parallelo con il numero di thread OpenMP di default)
+static void BM_AosStep(benchmark::State& state)
+{
+    std::vector<Boid> boids = make_boids(state);
+    std::vector<Boid> new_boids(boids.size());
+    AosWorkspace workspace;
+    for (auto _ : state) {
+        update_all_boids(boids.data(), new_boids.data(), static_cast<int>(boids.size()), workspace, bench_delta_time, bench_window_width, bench_window_height);
+        benchmark::DoNotOptimize(new_boids.data());
+    }
+    state.SetItemsProcessed(state.iterations() * boids.size());
+    state.SetLabel(distribution_name(static_cast<int>(state.range(0))));
+}
+BENCHMARK(BM_AosStep)->BENCH_DISTRIBUTION_ARGS->Unit(benchmark::kMillisecond)->UseRealTime();
+
+BENCHMARK_MAIN();
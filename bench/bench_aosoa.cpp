@@ -0,0 +1,97 @@
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "../omp_aosoa/boids_omp_aosoa.h"
+#include "../omp_aosoa/spatial_grid.h"
+#include "bench_distributions.h"
+#include "bench_memory.h"
+
+// microbenchmark del motore AoSoA: ordinamento per cella nei blocchi e time step completo
+// (stessi argomenti e nomi di BM_AosStep / BM_SoaStep, per confrontare i tre layout)
+
+// buffer AoSoA posseduto dal benchmark
+struct BoidsStorage {
+    std::vector<BoidBlock> blocks;
+    BoidsAoSoA view;
+
+    explicit BoidsStorage(int n) : blocks(aosoa_num_blocks(n))
+    {
+        view = BoidsAoSoA{.blocks = blocks.data(), .count = n};
+    }
+};
+
+static BoidsStorage make_boids(const benchmark::State& state)
+{
+    const std::vector<BoidSample> samples = make_distribution(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    BoidsStorage boids(static_cast<int>(samples.size()));
+    for (size_t i = 0; i < samples.size(); ++i) {
+        BoidBlock& block = boids.blocks[i / aosoa_block_size];
+        block.x[i % aosoa_block_size] = samples[i].x;
+        block.y[i % aosoa_block_size] = samples[i].y;
+        block.vx[i % aosoa_block_size] = samples[i].vx;
+        block.vy[i % aosoa_block_size] = samples[i].vy;
+    }
+    return boids;
+}
+
+#if alloc_tracking_on
+// allocazioni per time step a regime, byte per boid e picco di memoria (contatori in bench_memory.h)
+static void BM_AosoaStepMemory(benchmark::State& state)
+{
+    const AllocSnapshot start = memory_probe_begin();
+    BoidsStorage boids = make_boids(state);
+    BoidsStorage new_boids(boids.view.count);
+    BlockSortedGrid grid;
+    BoidsAoSoA current = boids.view;
+    BoidsAoSoA next = new_boids.view;
+    auto advance = [&]() {
+        update_all_boids(current, next, grid, bench_delta_time, bench_window_width, bench_window_height);
+        std::swap(current, next);
+    };
+    for (int step = 0; step < alloc_warmup_steps; ++step)
+        advance();
+
+    const AllocSnapshot steady = alloc_snapshot();
+    for (auto _ : state) {
+        advance();
+        benchmark::ClobberMemory();
+    }
+    set_memory_counters(state, start, steady, boids.view.count);
+    state.SetItemsProcessed(state.iterations() * boids.view.count);
+    state.SetLabel(distribution_name(static_cast<int>(state.range(0))));
+}
+BENCHMARK(BM_AosoaStepMemory)->ArgsProduct({{DIST_UNIFORM}, {1000, 10000, 100000}})->ArgNames({"dist", "n"})->Iterations(memory_bench_iterations)->Unit(benchmark::kMillisecond)->UseRealTime();
+#endif
+
+// ordinamento per cella nella copia a blocchi, su un solo thread
+static void BM_AosoaGridBuild(benchmark::State& state)
+{
+    BoidsStorage boids = make_boids(state);
+    BlockSortedGrid grid;
+    grid.resize(bench_cell_size, bench_window_width, bench_window_height, boids.view.count);
+    for (auto _ : state) {
+        grid.build(boids.view);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * boids.view.count);
+    state.SetLabel(distribution_name(static_cast<int>(state.range(0))));
+}
+BENCHMARK(BM_AosoaGridBuild)->BENCH_DISTRIBUTION_ARGS;
+
+// time step completo (griglia + update parallelo con il numero di thread OpenMP di default)
+static void BM_AosoaStep(benchmark::State& state)
+{
+    BoidsStorage boids = make_boids(state);
+    BoidsStorage new_boids(boids.view.count);
+    BlockSortedGrid grid;
+    for (auto _ : state) {
+        update_all_boids(boids.view, new_boids.view, grid, bench_delta_time, bench_window_width, bench_window_height);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * boids.view.count);
+    state.SetLabel(distribution_name(static_cast<int>(state.range(0))));
+}
+BENCHMARK(BM_AosoaStep)->BENCH_DISTRIBUTION_ARGS->Unit(benchmark::kMillisecond)->UseRealTime();
+
+BENCHMARK_MAIN();
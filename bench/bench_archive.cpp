@@ -0,0 +1,130 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "../omp_soa/boids_omp_soa.h"
+#include "../omp_soa/trajectory_archive.h"
+#include "bench_distributions.h"
+
+// microbenchmark dell'archivio di traiettorie (omp_soa/trajectory_archive.h): codifica in background e decodifica in
+// streaming / ad accesso casuale di una sequenza di frame reali del motore SoA
+
+#define archive_bench_frames 32
+#define archive_bench_file "bench_trajectory.btra"
+
+// sequenza di frame: n boids uniformi fatti evolvere col motore a griglia (i gruppi densi di DIST_CLUSTERED renderebbero
+// la preparazione troppo lenta con 100000 boids)
+struct ArchiveBenchFrames {
+    int count = 0;
+    std::vector<std::vector<float>> x, y, vx, vy;
+};
+
+static ArchiveBenchFrames& archive_bench_frames_for(int n)
+{
+    static ArchiveBenchFrames frames;
+    if (frames.count == n)
+        return frames;
+
+    const std::vector<BoidSample> samples = make_distribution(DIST_UNIFORM, n);
+    std::vector<float> x(n), y(n), vx(n), vy(n), nx(n), ny(n), nvx(n), nvy(n);
+    for (int i = 0; i < n; ++i) {
+        x[i] = samples[i].x;
+        y[i] = samples[i].y;
+        vx[i] = samples[i].vx;
+        vy[i] = samples[i].vy;
+    }
+    Boids current = Boids{.x = x.data(), .y = y.data(), .vx = vx.data(), .vy = vy.data(), .count = n};
+    Boids next = Boids{.x = nx.data(), .y = ny.data(), .vx = nvx.data(), .vy = nvy.data(), .count = n};
+
+    frames = ArchiveBenchFrames();
+    frames.count = n;
+    for (int f = 0; f < archive_bench_frames; ++f) {
+        update_all_boids(current, next, bench_delta_time, bench_window_width, bench_window_height, SPATIAL_INDEX_GRID);
+        std::swap(current, next);
+        frames.x.emplace_back(current.x, current.x + n);
+        frames.y.emplace_back(current.y, current.y + n);
+        frames.vx.emplace_back(current.vx, current.vx + n);
+        frames.vy.emplace_back(current.vy, current.vy + n);
+    }
+    return frames;
+}
+
+static Boids archive_bench_view(ArchiveBenchFrames& frames, int f)
+{
+    return Boids{.x = frames.x[f].data(), .y = frames.y[f].data(), .vx = frames.vx[f].data(), .vy = frames.vy[f].data(), .count = frames.count};
+}
+
+static TrajectoryArchiveStats write_archive(ArchiveBenchFrames& frames, const TrajectoryArchiveOptions& options)
+{
+    TrajectoryArchiveWriter writer;
+    writer.open(archive_bench_file, frames.count, bench_window_width, bench_window_height, options);
+    for (int f = 0; f < archive_bench_frames; ++f)
+        writer.push(archive_bench_view(frames, f), f + 1);
+    writer.close();
+    return writer.stats();
+}
+
+// codifica di archive_bench_frames frame con state.range(1) encoder e keyframe ogni state.range(2) frame
+// (tempo dal primo push alla chiusura del file); byte per boid per frame e rapporto sui float grezzi come contatori
+static void BM_TrajectoryEncode(benchmark::State& state)
+{
+    ArchiveBenchFrames& frames = archive_bench_frames_for(static_cast<int>(state.range(0)));
+    TrajectoryArchiveOptions options;
+    options.encoderThreads = static_cast<int>(state.range(1));
+    options.keyframeInterval = static_cast<int>(state.range(2));
+
+    TrajectoryArchiveStats stats;
+    for (auto _ : state)
+        stats = write_archive(frames, options);
+    std::remove(archive_bench_file);
+
+    state.SetItemsProcessed(state.iterations() * archive_bench_frames);
+    state.counters["bytes_per_boid"] = static_cast<double>(stats.storedBytes) / stats.frames / frames.count;
+    state.counters["ratio"] = static_cast<double>(stats.rawBytes) / stats.storedBytes;
+    state.counters["stalls"] = static_cast<double>(stats.stalls);
+}
+BENCHMARK(BM_TrajectoryEncode)->ArgsProduct({{10000, 100000}, {1, 2}, {8, 64}})->ArgNames({"n", "encoders", "keyframe"})->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// decodifica: tutto l'archivio in streaming (state.range(1) == 0) o solo l'ultimo frame tramite l'indice (== 1);
+// riporta l'errore massimo di posizione e velocità rispetto ai float originali
+static void BM_TrajectoryDecode(benchmark::State& state)
+{
+    ArchiveBenchFrames& frames = archive_bench_frames_for(static_cast<int>(state.range(0)));
+    const bool seek = state.range(1) == 1;
+    write_archive(frames, TrajectoryArchiveOptions());
+
+    TrajectoryArchiveReader reader;
+    if (!reader.open(archive_bench_file)) {
+        state.SkipWithError("archive not readable");
+        return;
+    }
+    TrajectoryFrame frame;
+    float positionError = 0.0f, velocityError = 0.0f;
+    for (auto _ : state) {
+        if (seek) {
+            reader.seek(archive_bench_frames, frame);
+        } else {
+            reader.rewind();
+            while (reader.next(frame)) {
+            }
+        }
+        const int f = static_cast<int>(frame.frame);
+        for (int i = 0; i < frame.count; ++i) {
+            positionError = std::max({positionError, std::fabs(frame.x[i] - frames.x[f][i]), std::fabs(frame.y[i] - frames.y[f][i])});
+            velocityError = std::max({velocityError, std::fabs(frame.vx[i] - frames.vx[f][i]), std::fabs(frame.vy[i] - frames.vy[f][i])});
+        }
+    }
+    std::remove(archive_bench_file);
+
+    state.SetItemsProcessed(state.iterations() * (seek ? 1 : archive_bench_frames));
+    state.counters["max_position_error"] = positionError;
+    state.counters["max_velocity_error"] = velocityError;
+    state.SetLabel(seek ? "seek" : "stream");
+}
+BENCHMARK(BM_TrajectoryDecode)->ArgsProduct({{10000, 100000}, {0, 1}})->ArgNames({"n", "seek"})->Unit(benchmark::kMillisecond)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+// parametri comuni ai microbenchmark (devono coincidere con quelli dei motori)
+#define bench_cell_size 40.0f // = visual_range
+#define bench_delta_time 0.8f // ~ 1/60 s * speedUpSimulation
+#define bench_window_width 1280
+#define bench_window_height 720
+
+// distribuzioni sintetiche degli stati iniziali
+enum Distribution {
+    DIST_UNIFORM,   // posizioni uniformi su tutta la finestra
+    DIST_CLUSTERED, // alcuni gruppi gaussiani sparsi (stato intermedio tipico)
+    DIST_BLOB       // un unico gruppo molto denso al centro (stato tardivo, caso peggiore per la griglia)
+};
+
+inline const char* distribution_name(int distribution)
+{
+    static const char* names[] = {"uniform", "clustered", "blob"};
+    return names[distribution];
+}
+
+// stato di un boid indipendente dal layout, convertito da ogni benchmark nel proprio formato
+struct BoidSample {
+    float x, y;
+    float vx, vy;
+};
+
+// genera n boids secondo la distribuzione richiesta (seed fisso per confronti ripetibili)
+inline std::vector<BoidSample> make_distribution(int distribution, int n, unsigned seed = 42)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> ux(0.0f, static_cast<float>(bench_window_width));
+    std::uniform_real_distribution<float> uy(0.0f, static_cast<float>(bench_window_height));
+    std::uniform_real_distribution<float> uv(-3.0f, 3.0f);
+
+    // centri dei gruppi
+    const int numClusters = distribution == DIST_CLUSTERED ? 8 : 1;
+    const float sigma = distribution == DIST_CLUSTERED ? 40.0f : 60.0f;
+    std::vector<BoidSample> centers(numClusters);
+    for (BoidSample& c : centers) {
+        c.x = distribution == DIST_BLOB ? bench_window_width * 0.5f : ux(rng);
+        c.y = distribution == DIST_BLOB ? bench_window_height * 0.5f : uy(rng);
+        c.vx = uv(rng);
+        c.vy = uv(rng);
+    }
+    std::normal_distribution<float> offset(0.0f, sigma);
+
+    std::vector<BoidSample> boids(n);
+    for (int i = 0; i < n; ++i) {
+        if (distribution == DIST_UNIFORM) {
+            boids[i] = {ux(rng), uy(rng), uv(rng), uv(rng)};
+        } else {
+            // i boids di un gruppo hanno velocità simili, come in uno stormo formato
+            const BoidSample& c = centers[i % numClusters];
+            boids[i].x = std::clamp(c.x + offset(rng), 0.0f, bench_window_width - 1.0f);
+            boids[i].y = std::clamp(c.y + offset(rng), 0.0f, bench_window_height - 1.0f);
+            boids[i].vx = c.vx + uv(rng) * 0.1f;
+            boids[i].vy = c.vy + uv(rng) * 0.1f;
+        }
+    }
+    return boids;
+}
+
+// argomenti comuni: {distribuzione} x {numero di boids}
+#define BENCH_DISTRIBUTION_ARGS \
+    ArgsProduct({{DIST_UNIFORM, DIST_CLUSTERED, DIST_BLOB}, {1000, 5000, 20000}})->ArgNames({"dist", "n"})
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include "../common/alloc_tracking.h"
+
+// contatori comuni ai benchmark *StepMemory (registrati solo con alloc_tracking_on, -DBOIDS_ALLOC_TRACKING=ON):
+//  - allocs_per_step / bytes_per_step: allocazioni con new nei time step misurati, dopo alloc_warmup_steps time step
+//    di riscaldamento in cui le strutture persistenti dei motori raggiungono la loro dimensione
+//  - bytes_per_boid: picco della memoria allocata con new dall'inizio del benchmark (stato + workspace del motore, creato
+//    dal benchmark stesso) diviso N
+//  - peak_rss_mb: picco della memoria residente del processo dall'inizio del benchmark (VmHWM, se il kernel permette di azzerarlo)
+
+// iterazioni fisse: le allocazioni a regime si vedono già in pochi time step, senza le chiamate di stima di Google Benchmark
+#define memory_bench_iterations 10
+
+// da chiamare prima di allocare lo stato del benchmark
+inline AllocSnapshot memory_probe_begin()
+{
+    alloc_reset_peak();
+    return alloc_snapshot();
+}
+
+inline void set_memory_counters(benchmark::State& state, const AllocSnapshot& start, const AllocSnapshot& steady, int numBoids)
+{
+    const AllocSnapshot end = alloc_snapshot();
+    const double steps = static_cast<double>(state.iterations());
+    state.counters["allocs_per_step"] = static_cast<double>(end.allocations - steady.allocations) / steps;
+    state.counters["bytes_per_step"] = static_cast<double>(end.allocatedBytes - steady.allocatedBytes) / steps;
+    state.counters["bytes_per_boid"] = static_cast<double>(end.peakLiveBytes - start.liveBytes) / numBoids;
+    state.counters["peak_rss_mb"] = static_cast<double>(peak_rss_bytes()) / (1024.0 * 1024.0);
+}
@@ -0,0 +1,119 @@
+#include <algorithm>
+
+#include <benchmark/benchmark.h>
+
+#include "../omp_soa/boids_omp_soa.h"
+#include "../omp_soa/soa_workspace.h"
+#include "../omp_soa/spatial_grid.h"
+#include "../omp_soa/incremental_grid.h"
+#include "bench_soa_common.h"
+
+// microbenchmark del motore SoA: costruzione griglia, query dei vicini, ciclo di interazione e time step completo
+// (gli altri motori e le varianti sono negli altri file bench_soa_*.cpp, vedi bench_soa_common.h)
+
+// costruzione della griglia (conteggio, prefix sum, riempimento) su un solo thread
+static void BM_SoaGridBuild(benchmark::State& state)
+{
+    BoidsStorage boids = make_boids(state);
+    SpatialGrid grid(bench_cell_size, bench_window_width, bench_window_height, boids.view.count);
+    for (auto _ : state) {
+        build_grid(boids.view, grid);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * boids.view.count);
+    state.SetLabel(distribution_name(static_cast<int>(state.range(0))));
+}
+BENCHMARK(BM_SoaGridBuild)->BENCH_DISTRIBUTION_ARGS;
+
+// query dei vicini (cella + 8 adiacenti) per tutti i boids
+static void BM_SoaGridQuery(benchmark::State& state)
+{
+    BoidsStorage boids = make_boids(state);
+    SpatialGrid grid(bench_cell_size, bench_window_width, bench_window_height, boids.view.count);
+    build_grid(boids.view, grid);
+
+    long long candidates = 0;
+    for (auto _ : state) {
+        for (int i = 0; i < boids.view.count; ++i)
+            grid.query(boids.x[i], boids.y[i], [&](NeighborRange range) { candidates += range.end() - range.begin(); });
+        benchmark::DoNotOptimize(candidates);
+    }
+    state.SetItemsProcessed(state.iterations() * boids.view.count);
+    state.counters["candidates_per_boid"] = benchmark::Counter(static_cast<double>(candidates) / (state.iterations() * boids.view.count));
+    state.SetLabel(distribution_name(static_cast<int>(state.range(0))));
+}
+BENCHMARK(BM_SoaGridQuery)->BENCH_DISTRIBUTION_ARGS;
+
+// ciclo di interazione su griglia già costruita, su un solo thread
+static void BM_SoaInteraction(benchmark::State& state)
+{
+    BoidsStorage boids = make_boids(state);
+    BoidsStorage new_boids(boids.view.count);
+    SpatialGrid grid(bench_cell_size, bench_window_width, bench_window_height, boids.view.count);
+    build_grid(boids.view, grid);
+
+    for (auto _ : state) {
+        interact_boids(boids.view, new_boids.view, &grid, bench_delta_time, bench_window_width, bench_window_height);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * boids.view.count);
+    state.SetLabel(distribution_name(static_cast<int>(state.range(0))));
+}
+BENCHMARK(BM_SoaInteraction)->BENCH_DISTRIBUTION_ARGS->Unit(benchmark::kMillisecond);
+
+// time step completo (griglia + update parallelo con il numero di thread OpenMP di default)
+static void BM_SoaStep(benchmark::State& state)
+{
+    BoidsStorage boids = make_boids(state);
+    BoidsStorage new_boids(boids.view.count);
+    SoaWorkspace workspace;
+    for (auto _ : state) {
+        update_all_boids(boids.view, new_boids.view, workspace, bench_delta_time, bench_window_width, bench_window_height);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * boids.view.count);
+    state.SetLabel(distribution_name(static_cast<int>(state.range(0))));
+}
+BENCHMARK(BM_SoaStep)->BENCH_DISTRIBUTION_ARGS->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// time step completo con ricostruzione della griglia su una simulazione che avanza (riferimento per la griglia incrementale,
+// lo stato evolve e i boids si raggruppano, quindi il costo non è confrontabile con BM_SoaStep)
+static void BM_SoaStepAdvancing(benchmark::State& state)
+{
+    BoidsStorage boids = make_boids(state);
+    BoidsStorage new_boids(boids.view.count);
+    SoaWorkspace workspace;
+    Boids current = boids.view;
+    Boids next = new_boids.view;
+    for (auto _ : state) {
+        update_all_boids(current, next, workspace, bench_delta_time, bench_window_width, bench_window_height);
+        std::swap(current, next);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * boids.view.count);
+    state.SetLabel(distribution_name(static_cast<int>(state.range(0))));
+}
+BENCHMARK(BM_SoaStepAdvancing)->BENCH_DISTRIBUTION_ARGS->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// time step completo con la griglia incrementale: la simulazione avanza (scambio dei buffer), altrimenti
+// la griglia non descriverebbe più le posizioni di partenza
+static void BM_SoaStepIncremental(benchmark::State& state)
+{
+    BoidsStorage boids = make_boids(state);
+    BoidsStorage new_boids(boids.view.count);
+    Boids current = boids.view;
+    Boids next = new_boids.view;
+    IncrementalGrid grid;
+    for (auto _ : state) {
+        update_all_boids_incremental(current, next, grid, bench_delta_time, bench_window_width, bench_window_height);
+        std::swap(current, next);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * boids.view.count);
+    state.counters["migrations_per_step"] = benchmark::Counter(static_cast<double>(grid.migrationsApplied), benchmark::Counter::kAvgIterations);
+    state.counters["rebuilds"] = grid.rebuilds;
+    state.SetLabel(distribution_name(static_cast<int>(state.range(0))));
+}
+BENCHMARK(BM_SoaStepIncremental)->BENCH_DISTRIBUTION_ARGS->Unit(benchmark::kMillisecond)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,43 @@
+#include <algorithm>
+#include <cmath>
+
+#include <benchmark/benchmark.h>
+
+#include "../omp_soa/boids_omp_soa.h"
+#include "../omp_soa/soa_workspace.h"
+#include "bench_soa_common.h"
+
+// microbenchmark dell'approssimazione a campo lontano (aggregati per sotto-cella)
+
+// time step completo con gli aggregati per sotto-cella; i contatori riportano la tolleranza, la quota di vicini contata
+// in O(1) e l'errore sulle velocità dopo un time step rispetto al motore esatto (update_all_boids, stesso stato iniziale)
+static void BM_SoaStepApprox(benchmark::State& state)
+{
+    BoidsStorage boids = make_boids(state);
+    BoidsStorage exact(boids.view.count);
+    BoidsStorage new_boids(boids.view.count);
+    SoaWorkspace workspace;
+    const float farTolerance = static_cast<float>(state.range(2));
+
+    update_all_boids(boids.view, exact.view, workspace, bench_delta_time, bench_window_width, bench_window_height);
+    update_all_boids_approx(boids.view, new_boids.view, workspace, bench_delta_time, bench_window_width, bench_window_height, nullptr, farTolerance);
+    double errorSum = 0.0, errorMax = 0.0;
+    for (int i = 0; i < boids.view.count; ++i) {
+        const double error = std::hypot(new_boids.vx[i] - exact.vx[i], new_boids.vy[i] - exact.vy[i]);
+        errorSum += error;
+        errorMax = std::max(errorMax, error);
+    }
+
+    ApproxStats stats;
+    for (auto _ : state) {
+        update_all_boids_approx(boids.view, new_boids.view, workspace, bench_delta_time, bench_window_width, bench_window_height, &stats, farTolerance);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * boids.view.count);
+    state.counters["aggregated_share"] = static_cast<double>(stats.aggregatedBoids) / static_cast<double>(std::max(1LL, stats.aggregatedBoids + stats.exactCandidates));
+    state.counters["far_tolerance"] = stats.farTolerance;
+    state.counters["vel_err_mean"] = errorSum / boids.view.count;
+    state.counters["vel_err_max"] = errorMax;
+    state.SetLabel(distribution_name(static_cast<int>(state.range(0))));
+}
+BENCHMARK(BM_SoaStepApprox)->ArgsProduct({{DIST_UNIFORM, DIST_CLUSTERED, DIST_BLOB}, {1000, 5000, 20000}, {0, 5}})->ArgNames({"dist", "n", "tolerance"})->Unit(benchmark::kMillisecond)->UseRealTime();
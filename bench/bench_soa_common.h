@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "../omp_soa/boids_omp_soa.h"
+#include "bench_distributions.h"
+
+// fixture comune ai microbenchmark SoA, divisi per motore in più file dello stesso eseguibile:
+//  - bench_soa.cpp: griglia (costruzione, query, interazione, time step, griglia incrementale) e main
+//  - bench_soa_quadtree.cpp, bench_soa_tasks.cpp, bench_soa_approx.cpp: gli altri motori del time step esatto
+//  - bench_soa_variants.cpp: varianti del modello (specie, mondo toroidale, ostacoli, statistiche) e auto-tuner
+//  - bench_soa_fast.cpp: kernel veloce (compilato con le stesse opzioni di boids_omp_soa_fast.cpp)
+//  - bench_soa_memory.cpp: allocazioni e memoria di tutti i motori (l'unico che include bench_memory.h)
+
+// buffer SoA posseduto dal benchmark
+struct BoidsStorage {
+    std::vector<float> x, y, vx, vy;
+    Boids view;
+
+    explicit BoidsStorage(int n) : x(n), y(n), vx(n), vy(n)
+    {
+        view = Boids{.x = x.data(), .y = y.data(), .vx = vx.data(), .vy = vy.data(), .count = n};
+    }
+};
+
+// n boids secondo la distribuzione richiesta
+inline BoidsStorage make_boids(int distribution, int n)
+{
+    const std::vector<BoidSample> samples = make_distribution(distribution, n);
+    BoidsStorage boids(static_cast<int>(samples.size()));
+    for (size_t i = 0; i < samples.size(); ++i) {
+        boids.x[i] = samples[i].x;
+        boids.y[i] = samples[i].y;
+        boids.vx[i] = samples[i].vx;
+        boids.vy[i] = samples[i].vy;
+    }
+    return boids;
+}
+
+// distribuzione e numero di boids dai primi due argomenti del benchmark (BENCH_DISTRIBUTION_ARGS)
+inline BoidsStorage make_boids(const benchmark::State& state)
+{
+    return make_boids(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+}
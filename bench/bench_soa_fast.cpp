@@ -0,0 +1,107 @@
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "../omp_soa/boids_omp_soa.h"
+#include "../omp_soa/soa_workspace.h"
+#include "../common/fast_math.h"
+#include "bench_soa_common.h"
+
+// microbenchmark del kernel veloce (common/fast_math.h); compilato con le opzioni di boids_omp_soa_fast.cpp (FAST_MATH_OPTIONS
+// in CMake), così il ciclo di clamp_speed_fast in BM_SpeedClamp viene vettorizzato come nel motore
+
+// time step completo con il kernel veloce (fast == 1, update_all_boids_fast) o con quello preciso (fast == 0); fuori dal ciclo
+// misurato un time step veloce viene confrontato con update_all_boids dallo stesso stato (errore massimo su posizione e velocità)
+static void BM_SoaStepFastMath(benchmark::State& state)
+{
+    BoidsStorage boids = make_boids(state);
+    BoidsStorage new_boids(boids.view.count);
+    SoaWorkspace workspace;
+    BoidsStorage reference(boids.view.count);
+    const bool fast = state.range(2) == 1;
+
+    update_all_boids(boids.view, reference.view, workspace, bench_delta_time, bench_window_width, bench_window_height);
+    update_all_boids_fast(boids.view, new_boids.view, workspace, bench_delta_time, bench_window_width, bench_window_height);
+    float positionError = 0.0f, velocityError = 0.0f;
+    for (int i = 0; i < boids.view.count; ++i) {
+        positionError = std::max({positionError, std::fabs(new_boids.x[i] - reference.x[i]), std::fabs(new_boids.y[i] - reference.y[i])});
+        velocityError = std::max({velocityError, std::fabs(new_boids.vx[i] - reference.vx[i]), std::fabs(new_boids.vy[i] - reference.vy[i])});
+    }
+
+    for (auto _ : state) {
+        if (fast)
+            update_all_boids_fast(boids.view, new_boids.view, workspace, bench_delta_time, bench_window_width, bench_window_height);
+        else
+            update_all_boids(boids.view, new_boids.view, workspace, bench_delta_time, bench_window_width, bench_window_height);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * boids.view.count);
+    state.counters["max_position_error"] = positionError;
+    state.counters["max_velocity_error"] = velocityError;
+    state.SetLabel(distribution_name(static_cast<int>(state.range(0))));
+}
+BENCHMARK(BM_SoaStepFastMath)->ArgsProduct({{DIST_UNIFORM, DIST_CLUSTERED, DIST_BLOB}, {1000, 5000, 20000}, {0, 1}})->ArgNames({"dist", "n", "fast"})->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// solo il clamp della velocità su velocità casuali con componenti fra -6 e 6: sqrtf e divisioni nei rami (fast == 0) o
+// clamp_speed_fast (fast == 1), con l'errore relativo massimo della norma risultante
+static void BM_SpeedClamp(benchmark::State& state)
+{
+    const int n = static_cast<int>(state.range(0));
+    const bool fast = state.range(1) == 1;
+    const std::vector<BoidSample> samples = make_distribution(DIST_UNIFORM, n);
+    std::vector<float> vx(n), vy(n), outX(n), outY(n);
+    for (int i = 0; i < n; ++i) {
+        // norme fra 0 e 8.5: il clamp interviene sia sotto min_speed (3) sia sopra max_speed (6)
+        vx[i] = samples[i].x / bench_window_width * 12.0f - 6.0f;
+        vy[i] = samples[i].y / bench_window_height * 12.0f - 6.0f;
+    }
+
+    auto clamp_precise = [](float& x, float& y) {
+        const float speed = sqrtf(x * x + y * y);
+        if (speed < 3.0f && speed > 0.0f) {
+            x = (x / speed) * 3.0f;
+            y = (y / speed) * 3.0f;
+        }
+        if (speed > 6.0f) {
+            x = (x / speed) * 6.0f;
+            y = (y / speed) * 6.0f;
+        }
+    };
+
+    float relativeError = 0.0f;
+    for (int i = 0; i < n; ++i) {
+        float px = vx[i], py = vy[i], fx = vx[i], fy = vy[i];
+        clamp_precise(px, py);
+        clamp_speed_fast(fx, fy, 3.0f, 6.0f);
+        const float precise = std::sqrt(px * px + py * py);
+        if (precise > 0.0f)
+            relativeError = std::max(relativeError, std::fabs(std::sqrt(fx * fx + fy * fy) - precise) / precise);
+    }
+
+    for (auto _ : state) {
+        if (fast) {
+            #pragma omp simd
+            for (int i = 0; i < n; ++i) {
+                float x = vx[i], y = vy[i];
+                clamp_speed_fast(x, y, 3.0f, 6.0f);
+                outX[i] = x;
+                outY[i] = y;
+            }
+        } else {
+            for (int i = 0; i < n; ++i) {
+                float x = vx[i], y = vy[i];
+                clamp_precise(x, y);
+                outX[i] = x;
+                outY[i] = y;
+            }
+        }
+        benchmark::DoNotOptimize(outX.data());
+        benchmark::DoNotOptimize(outY.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+    state.counters["max_relative_error"] = relativeError;
+}
+BENCHMARK(BM_SpeedClamp)->ArgsProduct({{4096, 65536}, {0, 1}})->ArgNames({"n", "fast"});
@@ -0,0 +1,129 @@
+#include <algorithm>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "../omp_soa/boids_omp_soa.h"
+#include "../omp_soa/soa_workspace.h"
+#include "../omp_soa/incremental_grid.h"
+#include "../omp_soa/species.h"
+#include "../omp_soa/obstacles.h"
+#include "../omp_soa/flock_analytics.h"
+#include "bench_soa_common.h"
+#include "bench_memory.h"
+
+// allocazioni e memoria di tutti i motori SoA; è l'unico file del benchmark che include bench_memory.h, perché
+// common/alloc_tracking.h definisce la sostituzione di operator new / delete
+
+#if alloc_tracking_on
+// motori confrontati da BM_SoaStepMemory
+enum MemoryEngine {
+    MEMORY_GRID,
+    MEMORY_QUADTREE,
+    MEMORY_TASKS,
+    MEMORY_INCREMENTAL,
+    MEMORY_APPROX,
+    MEMORY_SPECIES,
+    MEMORY_TOROIDAL,
+    MEMORY_OBSTACLES,
+    MEMORY_ANALYTICS,
+    MEMORY_FAST,
+    MEMORY_NUM_ENGINES
+};
+
+static const char* memory_engine_name(int engine)
+{
+    static const char* names[MEMORY_NUM_ENGINES] = {"grid", "quadtree", "tasks", "incremental", "approx", "species", "toroidal",
+                                                    "obstacles", "analytics", "fast"};
+    return names[engine];
+}
+
+// allocazioni per time step a regime, byte per boid e picco di memoria di ogni motore (contatori in bench_memory.h)
+static void BM_SoaStepMemory(benchmark::State& state)
+{
+    const int engine = static_cast<int>(state.range(2));
+    const AllocSnapshot start = memory_probe_begin();
+
+    BoidsStorage boids = make_boids(state);
+    BoidsStorage new_boids(boids.view.count);
+    Boids current = boids.view;
+    Boids next = new_boids.view;
+
+    // strutture dei motori riusate fra i time step (contate nel picco di memoria)
+    SoaWorkspace workspace;
+
+    // stato proprio delle varianti (3 specie, 1000 ostacoli e 8 predatori, statistiche ogni 10 time step)
+    IncrementalGrid incrementalGrid;
+    const SpeciesBlocks blocks = make_default_species_blocks(boids.view.count);
+    std::vector<float> bias, new_bias;
+    BoidsStorage predators(engine == MEMORY_OBSTACLES ? 8 : 0);
+    BoidsStorage new_predators(predators.view.count);
+    ObstacleGrid obstacles;
+    FlockAnalytics analytics;
+    analytics.interval = 10;
+    if (engine == MEMORY_SPECIES) {
+        bias.assign(boids.view.count, 0.0f);
+        new_bias.assign(boids.view.count, 0.0f);
+    } else if (engine == MEMORY_OBSTACLES) {
+        for (int p = 0; p < predators.view.count; ++p) {
+            predators.x[p] = bench_window_width * (p + 0.5f) / predators.view.count;
+            predators.y[p] = bench_window_height * 0.5f;
+            predators.vx[p] = predator_min_speed;
+        }
+        obstacles.bake(make_obstacle_field(bench_window_width, bench_window_height, 1000), bench_cell_size, bench_window_width,
+                       bench_window_height, obstacle_margin);
+    }
+
+    auto advance = [&]() {
+        switch (engine) {
+            case MEMORY_GRID:
+                update_all_boids(current, next, workspace, bench_delta_time, bench_window_width, bench_window_height);
+                break;
+            case MEMORY_QUADTREE:
+                update_all_boids(current, next, workspace, bench_delta_time, bench_window_width, bench_window_height, SPATIAL_INDEX_QUADTREE);
+                break;
+            case MEMORY_TASKS:
+                update_all_boids_tasks(current, next, workspace, bench_delta_time, bench_window_width, bench_window_height);
+                break;
+            case MEMORY_INCREMENTAL:
+                update_all_boids_incremental(current, next, incrementalGrid, bench_delta_time, bench_window_width, bench_window_height);
+                break;
+            case MEMORY_APPROX:
+                update_all_boids_approx(current, next, workspace, bench_delta_time, bench_window_width, bench_window_height);
+                break;
+            case MEMORY_SPECIES:
+                update_all_boids_species(current, next, workspace, blocks, bias.data(), new_bias.data(), bench_delta_time, bench_window_width, bench_window_height);
+                std::swap(bias, new_bias);
+                break;
+            case MEMORY_TOROIDAL:
+                update_all_boids_toroidal(current, next, workspace, bench_delta_time, bench_window_width, bench_window_height);
+                break;
+            case MEMORY_OBSTACLES:
+                update_all_boids_obstacles(current, next, workspace, predators.view, new_predators.view, obstacles, bench_delta_time,
+                                           bench_window_width, bench_window_height);
+                std::swap(predators.view, new_predators.view);
+                break;
+            case MEMORY_ANALYTICS:
+                update_all_boids_analytics(current, next, workspace, analytics, bench_delta_time, bench_window_width, bench_window_height);
+                break;
+            case MEMORY_FAST:
+                update_all_boids_fast(current, next, workspace, bench_delta_time, bench_window_width, bench_window_height);
+                break;
+        }
+        std::swap(current, next);
+    };
+    for (int step = 0; step < alloc_warmup_steps; ++step)
+        advance();
+
+    const AllocSnapshot steady = alloc_snapshot();
+    for (auto _ : state) {
+        advance();
+        benchmark::ClobberMemory();
+    }
+    set_memory_counters(state, start, steady, boids.view.count);
+    state.SetItemsProcessed(state.iterations() * boids.view.count);
+    state.SetLabel(memory_engine_name(engine));
+}
+BENCHMARK(BM_SoaStepMemory)->ArgsProduct({{DIST_UNIFORM}, {1000, 10000, 100000}, benchmark::CreateDenseRange(0, MEMORY_NUM_ENGINES - 1, 1)})
+    ->ArgNames({"dist", "n", "engine"})->Iterations(memory_bench_iterations)->Unit(benchmark::kMillisecond)->UseRealTime();
+#endif
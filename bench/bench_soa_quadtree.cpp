@@ -0,0 +1,87 @@
+#include <algorithm>
+
+#include <benchmark/benchmark.h>
+
+#include "../omp_soa/boids_omp_soa.h"
+#include "../omp_soa/soa_workspace.h"
+#include "../omp_soa/quadtree.h"
+#include "bench_soa_common.h"
+
+// microbenchmark del quadtree lineare: costruzione, query dei vicini e time step, anche su stati tardivi raggruppati
+
+// costruzione del quadtree (codici di Morton, radix sort, nodi) su un solo thread
+static void BM_SoaQuadtreeBuild(benchmark::State& state)
+{
+    BoidsStorage boids = make_boids(state);
+    LinearQuadtree tree;
+    tree.resize(bench_cell_size, bench_window_width, bench_window_height, boids.view.count);
+    for (auto _ : state) {
+        build_quadtree(boids.view, tree);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * boids.view.count);
+    state.counters["leaves"] = tree.leaf_count();
+    state.SetLabel(distribution_name(static_cast<int>(state.range(0))));
+}
+BENCHMARK(BM_SoaQuadtreeBuild)->BENCH_DISTRIBUTION_ARGS;
+
+// query dei vicini sul quadtree (foglie il cui bounding box interseca il visual range)
+static void BM_SoaQuadtreeQuery(benchmark::State& state)
+{
+    BoidsStorage boids = make_boids(state);
+    LinearQuadtree tree;
+    tree.resize(bench_cell_size, bench_window_width, bench_window_height, boids.view.count);
+    build_quadtree(boids.view, tree);
+
+    long long candidates = 0;
+    for (auto _ : state) {
+        for (int i = 0; i < boids.view.count; ++i)
+            tree.query(boids.x[i], boids.y[i], [&](NeighborRange range) { candidates += range.end() - range.begin(); });
+        benchmark::DoNotOptimize(candidates);
+    }
+    state.SetItemsProcessed(state.iterations() * boids.view.count);
+    state.counters["candidates_per_boid"] = benchmark::Counter(static_cast<double>(candidates) / (state.iterations() * boids.view.count));
+    state.SetLabel(distribution_name(static_cast<int>(state.range(0))));
+}
+BENCHMARK(BM_SoaQuadtreeQuery)->BENCH_DISTRIBUTION_ARGS;
+
+// time step completo con il quadtree al posto della griglia
+static void BM_SoaStepQuadtree(benchmark::State& state)
+{
+    BoidsStorage boids = make_boids(state);
+    BoidsStorage new_boids(boids.view.count);
+    SoaWorkspace workspace;
+    for (auto _ : state) {
+        update_all_boids(boids.view, new_boids.view, workspace, bench_delta_time, bench_window_width, bench_window_height, SPATIAL_INDEX_QUADTREE);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * boids.view.count);
+    state.SetLabel(distribution_name(static_cast<int>(state.range(0))));
+}
+BENCHMARK(BM_SoaStepQuadtree)->BENCH_DISTRIBUTION_ARGS->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// stato tardivo reale: n boids uniformi fatti evolvere con update_all_boids per state.range(0) time step (0 = stato iniziale),
+// poi un time step misurato con griglia (state.range(2) == 0) o quadtree (state.range(2) == 1)
+static void BM_SoaStepEvolved(benchmark::State& state)
+{
+    const int evolveSteps = static_cast<int>(state.range(0));
+    const SpatialIndexKind spatialIndex = state.range(2) == 0 ? SPATIAL_INDEX_GRID : SPATIAL_INDEX_QUADTREE;
+
+    BoidsStorage boids = make_boids(DIST_UNIFORM, static_cast<int>(state.range(1)));
+    BoidsStorage new_boids(boids.view.count);
+    SoaWorkspace workspace;
+    Boids current = boids.view;
+    Boids next = new_boids.view;
+    for (int step = 0; step < evolveSteps; ++step) {
+        update_all_boids(current, next, workspace, bench_delta_time, bench_window_width, bench_window_height);
+        std::swap(current, next);
+    }
+
+    for (auto _ : state) {
+        update_all_boids(current, next, workspace, bench_delta_time, bench_window_width, bench_window_height, spatialIndex);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * boids.view.count);
+    state.SetLabel(spatialIndex == SPATIAL_INDEX_GRID ? "grid" : "quadtree");
+}
+BENCHMARK(BM_SoaStepEvolved)->ArgsProduct({{0, 500}, {5000, 10000}, {0, 1}})->ArgNames({"steps", "n", "index"})->Unit(benchmark::kMillisecond)->UseRealTime();
@@ -0,0 +1,22 @@
+#include <benchmark/benchmark.h>
+
+#include "../omp_soa/boids_omp_soa.h"
+#include "../omp_soa/soa_workspace.h"
+#include "bench_soa_common.h"
+
+// microbenchmark del motore a task sulle tile (da confrontare con BM_SoaStep)
+
+// time step completo con il motore a task sulle tile
+static void BM_SoaStepTasks(benchmark::State& state)
+{
+    BoidsStorage boids = make_boids(state);
+    BoidsStorage new_boids(boids.view.count);
+    SoaWorkspace workspace;
+    for (auto _ : state) {
+        update_all_boids_tasks(boids.view, new_boids.view, workspace, bench_delta_time, bench_window_width, bench_window_height);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * boids.view.count);
+    state.SetLabel(distribution_name(static_cast<int>(state.range(0))));
+}
+BENCHMARK(BM_SoaStepTasks)->BENCH_DISTRIBUTION_ARGS->Unit(benchmark::kMillisecond)->UseRealTime();
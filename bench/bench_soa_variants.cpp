@@ -0,0 +1,215 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "../omp_soa/boids_omp_soa.h"
+#include "../omp_soa/soa_workspace.h"
+#include "../omp_soa/species.h"
+#include "../omp_soa/obstacles.h"
+#include "../omp_soa/flock_analytics.h"
+#include "../omp_soa/autotune.h"
+#include "bench_soa_common.h"
+
+// microbenchmark delle varianti del modello SoA (specie, mondo toroidale, ostacoli e predatori, statistiche dello stormo)
+// e dell'auto-tuner
+
+// time step con le specie: con 1 specie misura il costo della variante rispetto a BM_SoaStep (somme salvate per boid,
+// integrazione separata), con 3 specie (stormo + due gruppi di scout) il costo dei blocchi e del bias
+static void BM_SoaStepSpecies(benchmark::State& state)
+{
+    BoidsStorage boids = make_boids(state);
+    BoidsStorage new_boids(boids.view.count);
+    SoaWorkspace workspace;
+    const SpeciesBlocks blocks = state.range(2) == 1 ? make_single_species_blocks(boids.view.count) : make_default_species_blocks(boids.view.count);
+    std::vector<float> bias(boids.view.count, 0.0f), new_bias(boids.view.count, 0.0f);
+    for (auto _ : state) {
+        update_all_boids_species(boids.view, new_boids.view, workspace, blocks, bias.data(), new_bias.data(), bench_delta_time, bench_window_width, bench_window_height);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * boids.view.count);
+    state.SetLabel(distribution_name(static_cast<int>(state.range(0))));
+}
+BENCHMARK(BM_SoaStepSpecies)->ArgsProduct({{0, 2}, {1000, 5000, 20000}, {1, 3}})->ArgNames({"dist", "n", "species"})->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// simulazione lunga da stato uniforme con bordi (turn_factor) o toroidale: i contatori riportano il costo medio per step
+// all'inizio e alla fine, il loro rapporto e l'occupazione della cella più piena rispetto alla media alla fine
+static void BM_SoaLongRun(benchmark::State& state)
+{
+    const int steps = static_cast<int>(state.range(0));
+    const bool toroidal = state.range(2) == 1;
+    const int window = std::max(1, steps / 10);
+    double firstSeconds = 0.0, lastSeconds = 0.0, hotCell = 0.0;
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        BoidsStorage boids = make_boids(DIST_UNIFORM, static_cast<int>(state.range(1)));
+        BoidsStorage new_boids(boids.view.count);
+        Boids current = boids.view, next = new_boids.view;
+        SoaWorkspace workspace;
+        state.ResumeTiming();
+
+        firstSeconds = lastSeconds = 0.0;
+        for (int step = 0; step < steps; ++step) {
+            const auto start = std::chrono::high_resolution_clock::now();
+            if (toroidal)
+                update_all_boids_toroidal(current, next, workspace, bench_delta_time, bench_window_width, bench_window_height);
+            else
+                update_all_boids(current, next, workspace, bench_delta_time, bench_window_width, bench_window_height);
+            const double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+            if (step < window)
+                firstSeconds += seconds;
+            if (step >= steps - window)
+                lastSeconds += seconds;
+            std::swap(current, next);
+        }
+
+        // occupazione delle celle di lato bench_cell_size nello stato finale
+        state.PauseTiming();
+        const int gridWidth = static_cast<int>(std::ceil(bench_window_width / bench_cell_size));
+        const int gridHeight = static_cast<int>(std::ceil(bench_window_height / bench_cell_size));
+        std::vector<int> occupancy(gridWidth * gridHeight, 0);
+        for (int i = 0; i < current.count; ++i) {
+            const int cx = std::clamp(static_cast<int>(current.x[i] / bench_cell_size), 0, gridWidth - 1);
+            const int cy = std::clamp(static_cast<int>(current.y[i] / bench_cell_size), 0, gridHeight - 1);
+            occupancy[cy * gridWidth + cx]++;
+        }
+        hotCell = *std::max_element(occupancy.begin(), occupancy.end()) * static_cast<double>(occupancy.size()) / current.count;
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * steps * state.range(1));
+    state.counters["first_step_ms"] = 1e3 * firstSeconds / window;
+    state.counters["last_step_ms"] = 1e3 * lastSeconds / window;
+    state.counters["drift"] = lastSeconds / firstSeconds;
+    state.counters["hot_cell"] = hotCell;
+    state.SetLabel(toroidal ? "toroidal" : "walls");
+}
+BENCHMARK(BM_SoaLongRun)->ArgsProduct({{1000}, {5000, 10000}, {0, 1}})->ArgNames({"steps", "n", "torus"})->Iterations(1)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// time step con ostacoli e predatori: i contatori riportano le capsule e i predatori controllati per boid, che dipendono
+// dalla densità locale e non dal numero totale di ostacoli (0 ostacoli e 0 predatori = costo della variante rispetto a BM_SoaStep)
+static void BM_SoaStepObstacles(benchmark::State& state)
+{
+    BoidsStorage boids = make_boids(state);
+    BoidsStorage new_boids(boids.view.count);
+    SoaWorkspace workspace;
+    const int numPredators = static_cast<int>(state.range(3));
+    BoidsStorage predators(numPredators);
+    BoidsStorage new_predators(numPredators);
+    for (int p = 0; p < numPredators; ++p) {
+        predators.x[p] = bench_window_width * (p + 0.5f) / numPredators;
+        predators.y[p] = bench_window_height * 0.5f;
+        predators.vx[p] = predator_min_speed;
+    }
+
+    ObstacleGrid obstacles;
+    obstacles.bake(make_obstacle_field(bench_window_width, bench_window_height, static_cast<int>(state.range(2))), bench_cell_size,
+                   bench_window_width, bench_window_height, obstacle_margin);
+
+    HazardStats stats;
+    for (auto _ : state) {
+        update_all_boids_obstacles(boids.view, new_boids.view, workspace, predators.view, new_predators.view, obstacles, bench_delta_time,
+                                   bench_window_width, bench_window_height, &stats);
+        benchmark::ClobberMemory();
+    }
+    const double boidSteps = static_cast<double>(state.iterations()) * boids.view.count;
+    state.SetItemsProcessed(state.iterations() * boids.view.count);
+    state.counters["obstacle_checks"] = stats.obstacleChecks / boidSteps;
+    state.counters["predator_checks"] = stats.predatorChecks / boidSteps;
+    state.counters["baked_items"] = static_cast<double>(obstacles.cellItems.size());
+    state.SetLabel(distribution_name(static_cast<int>(state.range(0))));
+}
+BENCHMARK(BM_SoaStepObstacles)->ArgsProduct({{0, 2}, {5000, 20000}, {0, 1000, 10000}, {0, 16}})->ArgNames({"dist", "n", "obstacles", "predators"})->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// solo la ricerca degli ostacoli vicini a ogni boid: capsule della cella nella ObstacleGrid oppure tutte le capsule (naive)
+static void BM_SoaObstacleLookup(benchmark::State& state)
+{
+    BoidsStorage boids = make_boids(state);
+    const bool naive = state.range(3) == 1;
+    const std::vector<ObstacleCapsule> field = make_obstacle_field(bench_window_width, bench_window_height, static_cast<int>(state.range(2)));
+    ObstacleGrid obstacles;
+    obstacles.bake(field, bench_cell_size, bench_window_width, bench_window_height, obstacle_margin);
+
+    for (auto _ : state) {
+        int close = 0;
+        for (int i = 0; i < boids.view.count; ++i) {
+            const int cell = obstacles.cell_of(boids.x[i], boids.y[i]);
+            const ObstacleCapsule* begin = naive ? field.data() : obstacles.cell_begin(cell);
+            const ObstacleCapsule* end = naive ? field.data() + field.size() : obstacles.cell_end(cell);
+            for (const ObstacleCapsule* c = begin; c != end; ++c) {
+                float dx, dy;
+                close += capsule_axis_distance(*c, boids.x[i], boids.y[i], dx, dy) - c->radius < obstacle_margin;
+            }
+        }
+        benchmark::DoNotOptimize(close);
+    }
+    state.SetItemsProcessed(state.iterations() * boids.view.count);
+    state.SetLabel(naive ? "naive" : "baked");
+}
+BENCHMARK(BM_SoaObstacleLookup)->ArgsProduct({{0}, {5000}, {1000, 10000}, {0, 1}})->ArgNames({"dist", "n", "obstacles", "naive"})->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// time step con le statistiche dello stormo ogni "interval" time step (0 = mai, costo della variante rispetto a BM_SoaStep);
+// analytics_share è la quota del tempo misurata dentro le statistiche (union-find, istogramma, medie), senza scrittura CSV
+static void BM_SoaStepAnalytics(benchmark::State& state)
+{
+    BoidsStorage boids = make_boids(state);
+    BoidsStorage new_boids(boids.view.count);
+    SoaWorkspace workspace;
+    FlockAnalytics analytics;
+    analytics.interval = static_cast<int>(state.range(2));
+
+    double seconds = 0.0;
+    for (auto _ : state) {
+        const auto start = std::chrono::steady_clock::now();
+        update_all_boids_analytics(boids.view, new_boids.view, workspace, analytics, bench_delta_time, bench_window_width, bench_window_height);
+        seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * boids.view.count);
+    state.counters["analytics_share"] = analytics.analyticsSeconds / std::max(1e-12, seconds);
+    state.counters["clusters"] = analytics.numClusters;
+    state.SetLabel(distribution_name(static_cast<int>(state.range(0))));
+}
+BENCHMARK(BM_SoaStepAnalytics)->ArgsProduct({{0, 1, 2}, {5000, 20000}, {0, 1, 10}})->ArgNames({"dist", "n", "interval"})->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// stormo uniforme fatto evolvere per state.range(2) time step con la configurazione di default (tuned == 0, come update_all_boids)
+// o con l'auto-tuner (tuned == 1): la calibrazione avviene durante l'evoluzione e viene riportata a parte,
+// il tempo misurato è quello dei time step successivi (file della cache temporaneo, ogni benchmark ricalibra)
+static void BM_SoaAutotune(benchmark::State& state)
+{
+    const bool tuned = state.range(0) == 1;
+    BoidsStorage boids = make_boids(DIST_UNIFORM, static_cast<int>(state.range(1)));
+    BoidsStorage new_boids(boids.view.count);
+    SoaWorkspace workspace;
+
+    const std::string cachePath = "bench_autotune_cache.txt";
+    std::remove(cachePath.c_str());
+    AutoTuner tuner(0, cachePath);
+    const TuningConfig defaults = default_tuning_config(tuner.config().threads);
+    Boids current = boids.view;
+    Boids next = new_boids.view;
+    auto advance = [&]() {
+        if (tuned)
+            tuner.step(current, next, bench_delta_time, bench_window_width, bench_window_height);
+        else
+            update_all_boids_configured(current, next, workspace, defaults, bench_delta_time, bench_window_width, bench_window_height);
+        std::swap(current, next);
+    };
+    for (int step = 0; step < state.range(2); ++step)
+        advance();
+
+    for (auto _ : state) {
+        advance();
+        benchmark::ClobberMemory();
+    }
+    std::remove(cachePath.c_str());
+    state.SetItemsProcessed(state.iterations() * boids.view.count);
+    state.counters["calibrations"] = tuner.calibrations;
+    state.counters["tuning_steps"] = static_cast<double>(tuner.tuningSteps);
+    state.SetLabel(tuned ? describe_tuning_config(tuner.config()) : "default");
+}
+BENCHMARK(BM_SoaAutotune)->ArgsProduct({{0, 1}, {5000, 20000}, {300}})->ArgNames({"tuned", "n", "steps"})->Unit(benchmark::kMillisecond)->UseRealTime();
@@ -0,0 +1,303 @@
+#pragma once
+
+// conteggio opzionale delle allocazioni (sostituzione di operator new / delete, solo Linux con glibc) e campionamento
+// della memoria residente (RSS) per motore e configurazione: allocazioni per time step, byte per boid e picco di memoria
+// conta solo le allocazioni fatte con new (contenitori della libreria standard compresi); malloc chiamata direttamente
+// (runtime OpenMP, driver grafici) compare solo nell'RSS
+// le funzioni di sostituzione sono definite qui: includere questo header solo nel file del main o del benchmark
+
+#ifndef alloc_tracking_on
+#define alloc_tracking_on false
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+#include <ostream>
+
+#if alloc_tracking_on && defined(__linux__) && defined(__GLIBC__)
+#define alloc_hooks_on true
+#include <malloc.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#else
+#define alloc_hooks_on false
+#endif
+
+#define alloc_warmup_steps 5 // time step iniziali esclusi dal regime (riempimento delle strutture persistenti)
+
+// contatori globali aggiornati dagli hook (atomici: new e delete arrivano da tutti i thread OpenMP)
+struct AllocCounters {
+    std::atomic<long long> allocations;
+    std::atomic<long long> allocatedBytes;
+    std::atomic<long long> liveBytes;     // byte allocati e non ancora liberati (dimensione effettiva dei blocchi)
+    std::atomic<long long> peakLiveBytes; // massimo di liveBytes dall'ultimo alloc_reset_peak
+};
+
+inline AllocCounters& alloc_counters()
+{
+    static AllocCounters counters = {};
+    return counters;
+}
+
+// fotografia dei contatori, le differenze fra due fotografie danno le allocazioni di un intervallo
+struct AllocSnapshot {
+    long long allocations = 0;
+    long long allocatedBytes = 0;
+    long long liveBytes = 0;
+    long long peakLiveBytes = 0;
+};
+
+inline AllocSnapshot alloc_snapshot()
+{
+    const AllocCounters& counters = alloc_counters();
+    AllocSnapshot snapshot;
+    snapshot.allocations = counters.allocations.load(std::memory_order_relaxed);
+    snapshot.allocatedBytes = counters.allocatedBytes.load(std::memory_order_relaxed);
+    snapshot.liveBytes = counters.liveBytes.load(std::memory_order_relaxed);
+    snapshot.peakLiveBytes = counters.peakLiveBytes.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+#if alloc_hooks_on
+
+inline void alloc_record_new(void* p)
+{
+    AllocCounters& counters = alloc_counters();
+    const long long size = static_cast<long long>(malloc_usable_size(p));
+    counters.allocations.fetch_add(1, std::memory_order_relaxed);
+    counters.allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    const long long live = counters.liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+    long long peak = counters.peakLiveBytes.load(std::memory_order_relaxed);
+    while (live > peak && !counters.peakLiveBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+}
+
+inline void alloc_record_delete(void* p)
+{
+    if (p != nullptr)
+        alloc_counters().liveBytes.fetch_sub(static_cast<long long>(malloc_usable_size(p)), std::memory_order_relaxed);
+}
+
+// memoria residente attuale e picco (VmHWM) del processo in byte, letti da /proc senza allocare con new
+inline long long rss_bytes()
+{
+    long long pages = 0, residentPages = 0;
+    FILE* file = std::fopen("/proc/self/statm", "r");
+    if (file == nullptr)
+        return 0;
+    if (std::fscanf(file, "%lld %lld", &pages, &residentPages) != 2)
+        residentPages = 0;
+    std::fclose(file);
+    return residentPages * sysconf(_SC_PAGESIZE);
+}
+
+inline long long peak_rss_bytes()
+{
+    long long peakKb = 0;
+    char line[128];
+    FILE* file = std::fopen("/proc/self/status", "r");
+    if (file != nullptr) {
+        while (std::fgets(line, sizeof(line), file) != nullptr)
+            if (std::sscanf(line, "VmHWM: %lld kB", &peakKb) == 1)
+                break;
+        std::fclose(file);
+    }
+    if (peakKb == 0) {
+        rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        peakKb = usage.ru_maxrss;
+    }
+    return peakKb * 1024;
+}
+
+// riporta i picchi al valore attuale: il picco di memoria viva e, se il kernel lo permette (Linux >= 4.0), VmHWM
+inline void alloc_reset_peak()
+{
+    AllocCounters& counters = alloc_counters();
+    counters.peakLiveBytes.store(counters.liveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    FILE* file = std::fopen("/proc/self/clear_refs", "w");
+    if (file != nullptr) {
+        std::fputs("5", file);
+        std::fclose(file);
+    }
+}
+
+#else
+
+inline long long rss_bytes()
+{
+    return 0;
+}
+
+inline long long peak_rss_bytes()
+{
+    return 0;
+}
+
+inline void alloc_reset_peak()
+{
+}
+
+#endif
+
+// accumulatori di una run dei driver: le allocazioni vengono contate solo dentro i time step (non la grafica)
+struct AllocRun {
+    AllocSnapshot start;     // contatori all'inizio della run, prima dell'allocazione dello stato
+    AllocSnapshot stepStart; // contatori all'inizio del time step corrente
+    long long steps;
+    long long warmupAllocations;
+    long long steadyAllocations; // allocazioni nei time step dopo alloc_warmup_steps
+    long long steadyBytes;
+};
+
+inline AllocRun& alloc_run()
+{
+    static AllocRun run = {};
+    return run;
+}
+
+// inizio di una run (da chiamare prima di allocare lo stato dei boids)
+inline void alloc_run_begin()
+{
+    #if alloc_hooks_on
+    alloc_reset_peak();
+    AllocRun& run = alloc_run();
+    run = {};
+    run.start = alloc_snapshot();
+    #endif
+}
+
+inline void alloc_step_begin()
+{
+    #if alloc_hooks_on
+    alloc_run().stepStart = alloc_snapshot();
+    #endif
+}
+
+inline void alloc_step_end()
+{
+    #if alloc_hooks_on
+    AllocRun& run = alloc_run();
+    const AllocSnapshot now = alloc_snapshot();
+    const long long allocations = now.allocations - run.stepStart.allocations;
+    if (run.steps < alloc_warmup_steps) {
+        run.warmupAllocations += allocations;
+    } else {
+        run.steadyAllocations += allocations;
+        run.steadyBytes += now.allocatedBytes - run.stepStart.allocatedBytes;
+    }
+    run.steps++;
+    #endif
+}
+
+// stampa allocazioni per time step a regime, byte per boid (picco della memoria allocata con new durante la run)
+// e picco della memoria residente del processo
+inline void alloc_report(std::ostream& out, int numBoids)
+{
+    #if alloc_hooks_on
+    const AllocRun& run = alloc_run();
+    const AllocSnapshot now = alloc_snapshot();
+    const long long steadySteps = run.steps > alloc_warmup_steps ? run.steps - alloc_warmup_steps : 0;
+
+    const std::ios_base::fmtflags flags = out.flags();
+    out << std::fixed << std::setprecision(2);
+    out << "  allocazioni: " << run.warmupAllocations << " nei primi " << alloc_warmup_steps << " time step, "
+        << (steadySteps > 0 ? static_cast<double>(run.steadyAllocations) / steadySteps : 0.0) << " per time step a regime ("
+        << (steadySteps > 0 ? static_cast<double>(run.steadyBytes) / steadySteps : 0.0) << " byte)" << std::endl;
+    out << "  memoria: " << static_cast<double>(now.peakLiveBytes - run.start.liveBytes) / std::max(1, numBoids)
+        << " byte per boid allocati con new (picco), RSS di picco " << peak_rss_bytes() / (1024.0 * 1024.0) << " MB" << std::endl;
+    out.flags(flags);
+    #else
+    (void)out;
+    (void)numBoids;
+    #endif
+}
+
+#if alloc_hooks_on
+
+// sostituzione globale di operator new / delete: le altre forme (array, nothrow, con dimensione) della libreria
+// standard passano da queste (GCC segnala come non corrispondente la free su un puntatore restituito da new,
+// che qui viene proprio da malloc)
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void* operator new(std::size_t size)
+{
+    void* p = std::malloc(size > 0 ? size : 1);
+    if (p == nullptr)
+        throw std::bad_alloc();
+    alloc_record_new(p);
+    return p;
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    const std::size_t align = static_cast<std::size_t>(alignment);
+    void* p = std::aligned_alloc(align, (size + align - 1) / align * align);
+    if (p == nullptr)
+        throw std::bad_alloc();
+    alloc_record_new(p);
+    return p;
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return operator new(size, alignment);
+}
+
+void operator delete(void* p) noexcept
+{
+    alloc_record_delete(p);
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    operator delete(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    operator delete(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+    operator delete(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept
+{
+    operator delete(p);
+}
+
+void operator delete[](void* p, std::align_val_t) noexcept
+{
+    operator delete(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept
+{
+    operator delete(p);
+}
+
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept
+{
+    operator delete(p);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif
@@ -0,0 +1,329 @@
+#pragma once
+
+// raccolta opzionale di contatori hardware (perf_event_open, solo Linux) per thread e per fase di update_all_boids
+// se i contatori non sono disponibili (container, perf_event_paranoid, kernel senza PMU) vengono riportati come n/a
+// e la simulazione procede normalmente
+
+#ifndef perf_counters_on
+#define perf_counters_on false
+#endif
+
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <ostream>
+
+#ifdef _OPENMP
+#include <omp.h> // for OpenMP library functions
+#endif
+
+#if perf_counters_on && defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+#endif
+
+// fasi misurate dentro update_all_boids (non tutti i motori le usano tutte)
+enum PerfPhase {
+    PHASE_GRID_COUNT,  // conteggio boids per cella
+    PHASE_GRID_BUILD,  // prefix sum / costruzione griglia
+    PHASE_GRID_FILL,   // riempimento indici
+    PHASE_UPDATE,      // interazioni e integrazione
+    PERF_NUM_PHASES
+};
+
+// eventi hardware raccolti
+enum PerfEvent {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_LLC_MISSES,
+    PERF_L1D_MISSES,
+    PERF_BRANCH_MISSES,
+    PERF_FP_VECTOR_OPS,
+    PERF_NUM_EVENTS
+};
+
+inline const char* perf_phase_name(int phase)
+{
+    static const char* names[PERF_NUM_PHASES] = {"grid_count", "grid_build", "grid_fill", "update"};
+    return names[phase];
+}
+
+inline const char* perf_event_name(int event)
+{
+    static const char* names[PERF_NUM_EVENTS] = {"cycles", "instructions", "llc_misses", "l1d_misses", "branch_misses", "fp_vector_ops"};
+    return names[event];
+}
+
+#define perf_max_threads 256
+
+// accumulatori globali, una riga per thread OpenMP
+struct PerfTable {
+    double value[perf_max_threads][PERF_NUM_PHASES][PERF_NUM_EVENTS];
+    double seconds[perf_max_threads][PERF_NUM_PHASES];
+    long long interactions[perf_max_threads];
+    int threadsSeen;
+};
+
+inline PerfTable& perf_table()
+{
+    static PerfTable table = {};
+    return table;
+}
+
+// eventi aperti con successo da almeno un thread (non azzerati da perf_reset, i descrittori restano aperti)
+inline bool* perf_event_available()
+{
+    static bool available[PERF_NUM_EVENTS] = {};
+    return available;
+}
+
+inline int perf_thread_id()
+{
+    #ifdef _OPENMP
+    return omp_get_thread_num();
+    #else
+    return 0;
+    #endif
+}
+
+inline double perf_wtime()
+{
+    #ifdef _OPENMP
+    return omp_get_wtime();
+    #else
+    return 0.0;
+    #endif
+}
+
+#if perf_counters_on && defined(__linux__)
+
+// descrittori dei contatori aperti dal thread corrente (aperti alla prima misura, chiusi all'uscita del thread)
+struct PerfThreadCounters {
+    int fd[PERF_NUM_EVENTS];
+    double startValue[PERF_NUM_EVENTS];
+    double startTime;
+    bool opened = false;
+
+    ~PerfThreadCounters()
+    {
+        if (!opened)
+            return;
+        for (int e = 0; e < PERF_NUM_EVENTS; ++e)
+            if (fd[e] >= 0)
+                close(fd[e]);
+    }
+};
+
+// gli eventi FP_ARITH_INST_RETIRED (128B|256B packed single) hanno questa codifica solo su Intel
+inline bool perf_is_intel()
+{
+    #if defined(__x86_64__) || defined(__i386__)
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(0, &eax, &ebx, &ecx, &edx))
+        return false;
+    char vendor[13];
+    std::memcpy(vendor, &ebx, 4);
+    std::memcpy(vendor + 4, &edx, 4);
+    std::memcpy(vendor + 8, &ecx, 4);
+    vendor[12] = '\0';
+    return std::strcmp(vendor, "GenuineIntel") == 0;
+    #else
+    return false;
+    #endif
+}
+
+inline int perf_open_event(int event)
+{
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.disabled = 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    switch (event) {
+        case PERF_CYCLES:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case PERF_INSTRUCTIONS:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case PERF_LLC_MISSES:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            break;
+        case PERF_L1D_MISSES:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            break;
+        case PERF_BRANCH_MISSES:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+            break;
+        case PERF_FP_VECTOR_OPS:
+            if (!perf_is_intel())
+                return -1;
+            attr.type = PERF_TYPE_RAW;
+            attr.config = 0x28C7; // FP_ARITH_INST_RETIRED.128B_PACKED_SINGLE | 256B_PACKED_SINGLE
+            break;
+        default:
+            return -1;
+    }
+
+    // pid = 0, cpu = -1: conta solo il thread chiamante su qualsiasi core
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+}
+
+// legge il valore scalato per il multiplexing dei contatori
+inline double perf_read_event(int fd)
+{
+    uint64_t buf[3] = {0, 0, 0};
+    if (fd < 0 || read(fd, buf, sizeof(buf)) != sizeof(buf) || buf[2] == 0)
+        return 0.0;
+    return static_cast<double>(buf[0]) * static_cast<double>(buf[1]) / static_cast<double>(buf[2]);
+}
+
+inline PerfThreadCounters& perf_thread_counters()
+{
+    thread_local PerfThreadCounters counters;
+    if (!counters.opened) {
+        for (int e = 0; e < PERF_NUM_EVENTS; ++e) {
+            counters.fd[e] = perf_open_event(e);
+            if (counters.fd[e] >= 0) {
+                #pragma omp critical(perf_open)
+                perf_event_available()[e] = true;
+            }
+        }
+        counters.opened = true;
+    }
+    return counters;
+}
+
+#endif
+
+// azzera gli accumulatori (da chiamare all'inizio di ogni run)
+inline void perf_reset()
+{
+    PerfTable& table = perf_table();
+    std::memset(&table, 0, sizeof(table));
+}
+
+// inizio di una fase per il thread corrente
+inline void perf_phase_begin(int phase)
+{
+    (void)phase;
+    #if perf_counters_on && defined(__linux__)
+    PerfThreadCounters& counters = perf_thread_counters();
+    for (int e = 0; e < PERF_NUM_EVENTS; ++e)
+        counters.startValue[e] = perf_read_event(counters.fd[e]);
+    counters.startTime = perf_wtime();
+    #endif
+}
+
+// fine di una fase per il thread corrente: accumula le differenze
+inline void perf_phase_end(int phase)
+{
+    (void)phase;
+    #if perf_counters_on && defined(__linux__)
+    const double stopTime = perf_wtime();
+    PerfThreadCounters& counters = perf_thread_counters();
+    const int tid = perf_thread_id();
+    if (tid >= perf_max_threads)
+        return;
+
+    PerfTable& table = perf_table();
+    for (int e = 0; e < PERF_NUM_EVENTS; ++e) {
+        if (counters.fd[e] < 0)
+            continue;
+        table.value[tid][phase][e] += perf_read_event(counters.fd[e]) - counters.startValue[e];
+    }
+    table.seconds[tid][phase] += stopTime - counters.startTime;
+
+    #pragma omp critical(perf_threads_seen)
+    if (tid + 1 > table.threadsSeen)
+        table.threadsSeen = tid + 1;
+    #endif
+}
+
+// accumula il numero di coppie candidate esaminate dal thread corrente
+inline void perf_add_interactions(long long count)
+{
+    (void)count;
+    #if perf_counters_on
+    const int tid = perf_thread_id();
+    if (tid < perf_max_threads)
+        perf_table().interactions[tid] += count;
+    #endif
+}
+
+// stampa le metriche per fase (totali su tutti i thread) e per thread, normalizzate per boid-step e per interazione
+inline void perf_report(std::ostream& out, long long boidSteps)
+{
+    #if perf_counters_on
+    const PerfTable& table = perf_table();
+    const bool* available = perf_event_available();
+
+    bool anyAvailable = false;
+    for (int e = 0; e < PERF_NUM_EVENTS; ++e)
+        anyAvailable = anyAvailable || available[e];
+    if (!anyAvailable)
+        out << "Contatori hardware non disponibili (perf_event_open fallita), riporto solo i tempi per fase." << std::endl;
+
+    long long interactions = 0;
+    for (int t = 0; t < table.threadsSeen; ++t)
+        interactions += table.interactions[t];
+
+    const std::ios_base::fmtflags flags = out.flags();
+    out << std::fixed << std::setprecision(3);
+
+    for (int p = 0; p < PERF_NUM_PHASES; ++p) {
+        double maxSeconds = 0.0;
+        double totalSeconds = 0.0;
+        for (int t = 0; t < table.threadsSeen; ++t) {
+            totalSeconds += table.seconds[t][p];
+            if (table.seconds[t][p] > maxSeconds)
+                maxSeconds = table.seconds[t][p];
+        }
+        if (totalSeconds == 0.0)
+            continue;
+
+        out << "  fase " << perf_phase_name(p) << ": max thread " << maxSeconds << " s, somma thread " << totalSeconds << " s" << std::endl;
+        for (int e = 0; e < PERF_NUM_EVENTS && anyAvailable; ++e) {
+            out << "    " << perf_event_name(e) << ": ";
+            if (!available[e]) {
+                out << "n/a" << std::endl;
+                continue;
+            }
+            double total = 0.0;
+            for (int t = 0; t < table.threadsSeen; ++t)
+                total += table.value[t][p][e];
+            out << total / static_cast<double>(boidSteps) << " per boid";
+            if (p == PHASE_UPDATE && interactions > 0)
+                out << ", " << total / static_cast<double>(interactions) << " per interazione";
+            out << std::endl;
+        }
+    }
+
+    // dettaglio per thread della fase di update (sbilanciamento del carico)
+    if (interactions > 0)
+        out << "  interazioni per boid: " << static_cast<double>(interactions) / static_cast<double>(boidSteps) << std::endl;
+    for (int t = 0; t < table.threadsSeen; ++t) {
+        out << "  thread " << t << " update: " << table.seconds[t][PHASE_UPDATE] << " s";
+        if (available[PERF_CYCLES] && available[PERF_INSTRUCTIONS] && table.value[t][PHASE_UPDATE][PERF_CYCLES] > 0.0)
+            out << ", IPC " << table.value[t][PHASE_UPDATE][PERF_INSTRUCTIONS] / table.value[t][PHASE_UPDATE][PERF_CYCLES];
+        out << ", interazioni " << table.interactions[t] << std::endl;
+    }
+
+    out.flags(flags);
+    #else
+    (void)out;
+    (void)boidSteps;
+    #endif
+}
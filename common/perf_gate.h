@@ -0,0 +1,87 @@
+#pragma once
+
+// modalità gate delle prestazioni condivisa dai driver: scenari fissi e ripetibili (seed, time step e mondo fissi)
+// per alcuni N e numeri di thread, con più ripetizioni per scenario; i tempi per time step vengono scritti in un CSV
+// che scripts/perf_gate.py confronta con una baseline JSON (test di Mann-Whitney sulle ripetizioni)
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h> // for OpenMP library functions
+#endif
+
+#ifndef perf_gate_on
+#define perf_gate_on false
+#endif
+
+// scenari del gate
+#define perf_gate_time_steps 100 // time step per ripetizione
+#define perf_gate_runs 7         // ripetizioni misurate per scenario
+#define perf_gate_warmup_runs 1  // ripetizioni scartate all'inizio di ogni scenario (cache, pagine, frequenza)
+#define perf_gate_delta_time 0.8f
+#define perf_gate_seed 4242
+
+// il gate si attiva a compile time (perf_gate_on) o a runtime con l'argomento --perf-gate, così gli eseguibili normali
+// servono anche al target perf_gate e al test CTest
+inline bool perf_gate_requested(int argc, char* argv[])
+{
+    for (int i = 1; i < argc; ++i)
+        if (std::string(argv[i]) == "--perf-gate")
+            return true;
+    return perf_gate_on;
+}
+
+// esegue gli scenari (agenti x {1 thread, tutti i thread}) con lo stesso stato iniziale per tutte le ripetizioni;
+// runSimulation ha la stessa firma usata da run_scaling_study e restituisce i secondi spesi nei time step
+// threadsLimit limita il numero massimo di thread (1 per i motori sequenziali, 0 = tutti i core)
+template <typename RunSimulation>
+int run_perf_gate(const std::string& engineName, int windowWidth, int windowHeight, RunSimulation runSimulation, int threadsLimit = 0)
+{
+    #ifdef _OPENMP
+    const int maxThreads = threadsLimit > 0 ? std::min(threadsLimit, omp_get_num_procs()) : omp_get_num_procs();
+    #else
+    const int maxThreads = 1;
+    (void)threadsLimit;
+    #endif
+    const int agentsCases[] = {1000, 5000, 20000};
+    std::vector<int> threadsCases = {1};
+    if (maxThreads > 1)
+        threadsCases.push_back(maxThreads);
+
+    const std::string fileName = "perfgate_" + engineName + ".csv";
+    std::ofstream csv(fileName);
+    if (!csv.is_open()) {
+        std::cerr << "Error opening perf gate file." << std::endl;
+        return 1;
+    }
+    csv << "engine,threads,agents,world_width,world_height,steps,run,step_seconds" << std::endl;
+
+    for (const int threads : threadsCases) {
+        #ifdef _OPENMP
+        omp_set_num_threads(threads);
+        #endif
+        for (const int agents : agentsCases) {
+            for (int ri = -perf_gate_warmup_runs; ri < perf_gate_runs; ++ri) {
+                srand(perf_gate_seed); // stesso stato iniziale per tutte le ripetizioni: varia solo il rumore di misura
+                const double seconds = runSimulation(agents, windowWidth, windowHeight, perf_gate_time_steps, perf_gate_delta_time);
+                if (ri < 0)
+                    continue;
+
+                const double stepSeconds = seconds / perf_gate_time_steps;
+                csv << engineName << "," << threads << "," << agents << "," << windowWidth << "," << windowHeight << ","
+                    << perf_gate_time_steps << "," << ri << "," << stepSeconds << std::endl;
+                std::cout << "Perf gate " << engineName << ": " << agents << " boids con " << threads << " threads (run " << (ri + 1)
+                          << "): " << 1000.0 * stepSeconds << " ms per time step." << std::endl;
+            }
+        }
+    }
+
+    csv.close();
+    std::cout << "Tempi del perf gate salvati in " << fileName << std::endl;
+    return 0;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+// modalità di studio della scalabilità (strong e weak scaling) condivisa dai driver OpenMP
+// i risultati grezzi vengono scritti in un file CSV, analizzato poi da scripts/scaling_report.py
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#ifdef _OPENMP
+#include <omp.h> // for OpenMP library functions
+#endif
+
+#include "perf_counters.h"
+
+#ifndef scaling_study_on
+#define scaling_study_on false
+#endif
+
+// parametri dello studio
+#define scaling_strong_agents 10000 // N fisso per lo strong scaling
+#define scaling_weak_agents 2000    // boids per thread nel weak scaling
+#define scaling_time_steps 200      // time steps per misura
+#define scaling_runs 5              // ripetizioni per ogni configurazione
+#define scaling_delta_time 0.8f     // time step fisso (~ 1/60 s * speedUpSimulation)
+
+// esegue strong scaling (N fisso, 1..tutti i core) e weak scaling (N proporzionale ai thread, densità costante)
+// runSimulation(numAgents, worldWidth, worldHeight, timeSteps, deltaTime) esegue una simulazione senza grafica
+// e restituisce il tempo in secondi speso in update_all_boids
+// threadsLimit limita il numero massimo di thread (1 per i motori sequenziali, 0 = tutti i core)
+template <typename RunSimulation>
+int run_scaling_study(const std::string& engineName, int windowWidth, int windowHeight, RunSimulation runSimulation, int threadsLimit = 0)
+{
+    #ifdef _OPENMP
+    const int maxThreads = threadsLimit > 0 ? std::min(threadsLimit, omp_get_num_procs()) : omp_get_num_procs();
+    #else
+    const int maxThreads = 1;
+    (void)threadsLimit;
+    #endif
+
+    const std::string fileName = "scaling_" + engineName + ".csv";
+    std::ofstream csv(fileName);
+    if (!csv.is_open()) {
+        std::cerr << "Error opening scaling file." << std::endl;
+        return 1;
+    }
+    csv << "engine,mode,threads,agents,world_width,world_height,run,seconds,grid_count_s,grid_build_s,grid_fill_s,update_s" << std::endl;
+
+    for (int mode = 0; mode < 2; ++mode) {
+        const bool weak = mode == 1;
+        for (int threads = 1; threads <= maxThreads; ++threads) {
+            #ifdef _OPENMP
+            omp_set_num_threads(threads);
+            #endif
+
+            // nel weak scaling l'area del mondo cresce con il numero di thread per mantenere la densità costante
+            const int agents = weak ? scaling_weak_agents * threads : scaling_strong_agents;
+            const float worldScale = weak ? std::sqrt(static_cast<float>(threads)) : 1.0f;
+            const int worldWidth = static_cast<int>(windowWidth * worldScale);
+            const int worldHeight = static_cast<int>(windowHeight * worldScale);
+
+            for (int ri = 0; ri < scaling_runs; ++ri) {
+                perf_reset();
+                srand(1234 + ri); // stato iniziale ripetibile
+                const double seconds = runSimulation(agents, worldWidth, worldHeight, scaling_time_steps, scaling_delta_time);
+
+                csv << engineName << "," << (weak ? "weak" : "strong") << "," << threads << "," << agents << ","
+                    << worldWidth << "," << worldHeight << "," << ri << "," << seconds;
+
+                // tempi per fase (thread più lento), disponibili solo con i contatori attivi
+                const PerfTable& table = perf_table();
+                for (int p = 0; p < PERF_NUM_PHASES; ++p) {
+                    csv << ",";
+                    #if perf_counters_on
+                    double phaseSeconds = 0.0;
+                    for (int t = 0; t < perf_max_threads; ++t)
+                        phaseSeconds = std::max(phaseSeconds, table.seconds[t][p]);
+                    csv << phaseSeconds;
+                    #endif
+                }
+                (void)table;
+                csv << std::endl;
+
+                std::cout << (weak ? "Weak" : "Strong") << " scaling: " << agents << " boids con " << threads << " threads (run "
+                          << (ri + 1) << "): " << seconds << " secondi." << std::endl;
+            }
+        }
+    }
+
+    csv.close();
+    std::cout << "Risultati dello studio di scalabilità salvati in " << fileName << std::endl;
+    return 0;
+}
@@ -0,0 +1,172 @@
+#pragma once
+
+// modalità di validazione incrociata condivisa dai driver: tutti i motori partono dagli stessi stati iniziali
+// (generati qui con un seed, non con rand()) e avanzano con lo stesso time step fisso; ogni driver scrive
+// validation_<engine>.bin con lo stato completo dei primi time step e alcune metriche dello stormo per tutti i time step,
+// poi scripts/validate_engines.py confronta i motori con quello di riferimento (seq)
+
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifndef validation_on
+#define validation_on false
+#endif
+
+// parametri della validazione
+#define validation_agents 1000
+#define validation_time_steps 300
+#define validation_exact_steps 40 // time step (oltre allo stato iniziale) con lo stato completo nel file
+#define validation_seeds 8        // stati iniziali diversi per ogni scenario (con 8 contro 8 il p minimo di Mann-Whitney è 1.6e-4)
+#define validation_delta_time 0.8f
+#define validation_magic 0x4c415642u // "BVAL"
+#define validation_version 1u
+
+// la validazione si attiva a compile time (validation_on) o a runtime con l'argomento --validate, così gli eseguibili normali
+// servono anche al target validate_engines e ai test CTest
+inline bool validation_requested(int argc, char* argv[])
+{
+    for (int i = 1; i < argc; ++i)
+        if (std::string(argv[i]) == "--validate")
+            return true;
+    return validation_on;
+}
+
+// scenari degli stati iniziali
+enum ValidationScenario {
+    VALIDATION_MOVING,        // posizioni nella finestra e velocità casuali fra min_speed e max_speed
+    VALIDATION_AT_REST,       // come i driver: velocità nulla (i boids isolati restano fermi)
+    VALIDATION_OUT_OF_WINDOW, // posizioni anche fino a 100 pixel fuori dalla finestra (celle di bordo e stencil)
+    VALIDATION_NUM_SCENARIOS
+};
+
+// metriche dello stormo salvate per ogni time step
+enum ValidationMetric {
+    METRIC_POLARIZATION, // modulo della media delle direzioni
+    METRIC_MEAN_SPEED,
+    METRIC_DISPERSION,   // distanza quadratica media dal baricentro
+    METRIC_OUTSIDE,      // frazione di boids fuori dalla finestra
+    VALIDATION_NUM_METRICS
+};
+
+// stato canonico in SoA, convertito da e verso il layout di ogni motore
+struct ValidationState {
+    std::vector<float> x, y, vx, vy;
+
+    void resize(int count)
+    {
+        x.resize(count);
+        y.resize(count);
+        vx.resize(count);
+        vy.resize(count);
+    }
+
+    int count() const
+    {
+        return static_cast<int>(x.size());
+    }
+};
+
+inline void make_validation_state(int scenario, int seed, int agents, int windowWidth, int windowHeight, ValidationState& state)
+{
+    std::mt19937 generator(static_cast<uint32_t>(1000 * scenario + seed));
+    const float margin = scenario == VALIDATION_OUT_OF_WINDOW ? 100.0f : 0.0f;
+    std::uniform_real_distribution<float> px(-margin, windowWidth + margin);
+    std::uniform_real_distribution<float> py(-margin, windowHeight + margin);
+    std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+    std::uniform_real_distribution<float> speed(3.0f, 6.0f);
+
+    state.resize(agents);
+    for (int i = 0; i < agents; ++i) {
+        state.x[i] = px(generator);
+        state.y[i] = py(generator);
+        if (scenario == VALIDATION_AT_REST) {
+            state.vx[i] = 0.0f;
+            state.vy[i] = 0.0f;
+        } else {
+            const float a = angle(generator);
+            const float s = speed(generator);
+            state.vx[i] = s * std::cos(a);
+            state.vy[i] = s * std::sin(a);
+        }
+    }
+}
+
+inline void validation_metrics(const ValidationState& state, int windowWidth, int windowHeight, float* metrics)
+{
+    double ux = 0.0, uy = 0.0, speed = 0.0, cx = 0.0, cy = 0.0;
+    int outside = 0;
+    const int n = state.count();
+    for (int i = 0; i < n; ++i) {
+        const double s = std::sqrt(static_cast<double>(state.vx[i]) * state.vx[i] + static_cast<double>(state.vy[i]) * state.vy[i]);
+        if (s > 0.0) {
+            ux += state.vx[i] / s;
+            uy += state.vy[i] / s;
+        }
+        speed += s;
+        cx += state.x[i];
+        cy += state.y[i];
+        outside += state.x[i] < 0.0f || state.x[i] >= windowWidth || state.y[i] < 0.0f || state.y[i] >= windowHeight;
+    }
+    cx /= n;
+    cy /= n;
+    double spread = 0.0;
+    for (int i = 0; i < n; ++i)
+        spread += (state.x[i] - cx) * (state.x[i] - cx) + (state.y[i] - cy) * (state.y[i] - cy);
+
+    metrics[METRIC_POLARIZATION] = static_cast<float>(std::sqrt(ux * ux + uy * uy) / n);
+    metrics[METRIC_MEAN_SPEED] = static_cast<float>(speed / n);
+    metrics[METRIC_DISPERSION] = static_cast<float>(std::sqrt(spread / n));
+    metrics[METRIC_OUTSIDE] = static_cast<float>(outside) / n;
+}
+
+// esegue tutti gli scenari; step(state, next, timeStep, deltaTime, worldWidth, worldHeight) avanza di un time step
+// leggendo state e scrivendo next (timeStep == 0 segnala l'inizio di una nuova simulazione, per i motori con stato proprio)
+//
+// file: intestazione di 8 uint32 (magic, versione, agenti, time step, time step completi, seed, scenari, metriche), poi per ogni
+// (scenario, seed) gli stati completi x, y, vx, vy dei time step 0..validation_exact_steps e le metriche dei time step 0..validation_time_steps
+template <typename Step>
+int run_validation(const std::string& engineName, int windowWidth, int windowHeight, Step step)
+{
+    const std::string fileName = "validation_" + engineName + ".bin";
+    std::ofstream file(fileName, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Error opening validation file." << std::endl;
+        return 1;
+    }
+    const uint32_t header[8] = {validation_magic, validation_version, validation_agents, validation_time_steps, validation_exact_steps,
+                                validation_seeds, VALIDATION_NUM_SCENARIOS, VALIDATION_NUM_METRICS};
+    file.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+    ValidationState state, next;
+    std::vector<float> metrics(static_cast<size_t>(validation_time_steps + 1) * VALIDATION_NUM_METRICS);
+    for (int scenario = 0; scenario < VALIDATION_NUM_SCENARIOS; ++scenario) {
+        for (int seed = 0; seed < validation_seeds; ++seed) {
+            make_validation_state(scenario, seed, validation_agents, windowWidth, windowHeight, state);
+            next.resize(validation_agents);
+
+            for (int t = 0; t <= validation_time_steps; ++t) {
+                if (t <= validation_exact_steps) {
+                    for (const std::vector<float>* field : {&state.x, &state.y, &state.vx, &state.vy})
+                        file.write(reinterpret_cast<const char*>(field->data()), field->size() * sizeof(float));
+                }
+                validation_metrics(state, windowWidth, windowHeight, &metrics[static_cast<size_t>(t) * VALIDATION_NUM_METRICS]);
+                if (t < validation_time_steps) {
+                    step(state, next, t, validation_delta_time, windowWidth, windowHeight);
+                    std::swap(state, next);
+                }
+            }
+            file.write(reinterpret_cast<const char*>(metrics.data()), metrics.size() * sizeof(float));
+            std::cout << "Validazione " << engineName << ": scenario " << scenario << ", seed " << seed << " completato." << std::endl;
+        }
+    }
+
+    file.close();
+    std::cout << "Stati per la validazione salvati in " << fileName << std::endl;
+    return 0;
+}
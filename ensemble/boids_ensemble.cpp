@@ -0,0 +1,93 @@
+#include <algorithm>
+
+#include "boids_ensemble.h"
+
+// boids per porzione di lavoro: gli stormi più grandi vengono divisi in più intervalli di righe,
+// così anche pochi stormi grandi occupano tutti i thread
+#define ensemble_tile_boids 256
+
+// algoritmo riadattato da https://vanhunteradams.com/Pico/Animal_Movement/Boids-algorithm.html
+
+// motore per ensemble di stormi piccoli (sweep di parametri): un solo stormo da 100-1000 boids non basta a occupare
+// molti thread, quindi il parallelismo è fra gli stormi; il kernel è quello di seq_grid (seq_grid/boids_kernel.h) con i parametri dello stormo
+
+void add_flock(Ensemble& ensemble, const FlockParams& params, int numBoids)
+{
+    if (ensemble.flockStart.empty())
+        ensemble.flockStart.push_back(0);
+    ensemble.params.push_back(params);
+    ensemble.flockStart.push_back(ensemble.flockStart.back() + numBoids);
+}
+
+void prepare_ensemble(Ensemble& ensemble, int windowWidth, int windowHeight)
+{
+    const int numFlocks = ensemble.num_flocks();
+    ensemble.grids.resize(numFlocks);
+    ensemble.tiles.clear();
+
+    for (int f = 0; f < numFlocks; ++f) {
+        SortedGrid& grid = ensemble.grids[f];
+        grid.resize(ensemble.params[f].visualRange, windowWidth, windowHeight, ensemble.flock_size(f));
+
+        // righe della griglia divise in parti uguali fra le porzioni dello stormo
+        const int numTiles = std::clamp(ensemble.flock_size(f) / ensemble_tile_boids, 1, grid.gridHeight);
+        for (int t = 0; t < numTiles; ++t)
+            ensemble.tiles.push_back(FlockTile{f, t * grid.gridHeight / numTiles, (t + 1) * grid.gridHeight / numTiles});
+    }
+
+    // costo stimato di una porzione: boids della porzione per candidati di ogni boid (proporzionali a densità e area dello stencil)
+    auto cost = [&](const FlockTile& tile) {
+        const float size = static_cast<float>(ensemble.flock_size(tile.flock));
+        const float range = ensemble.params[tile.flock].visualRange;
+        const int rows = ensemble.grids[tile.flock].gridHeight;
+        return size * (tile.rowEnd - tile.rowBegin) / rows * size * range * range;
+    };
+
+    // le porzioni più costose per prime: con schedule(dynamic) le ultime assegnate sono le più brevi
+    std::stable_sort(ensemble.tiles.begin(), ensemble.tiles.end(), [&](const FlockTile& a, const FlockTile& b) {
+        return cost(a) > cost(b);
+    });
+}
+
+// costruisce la griglia di uno stormo sul suo intervallo di boids
+static void build_flock_grid(const Boids& boids, Ensemble& ensemble, int flock)
+{
+    const int offset = ensemble.flockStart[flock];
+    ensemble.grids[flock].build(boids.x + offset, boids.y + offset, boids.vx + offset, boids.vy + offset, ensemble.flock_size(flock));
+}
+
+void update_ensemble(const Boids& boids, Boids& new_boids, Ensemble& ensemble, float deltaTime, int windowWidth, int windowHeight)
+{
+    const int numFlocks = ensemble.num_flocks();
+    const int numTiles = static_cast<int>(ensemble.tiles.size());
+
+    #pragma omp parallel
+    {
+        // fase 1: ogni griglia è costruita da un solo thread (gli stormi sono piccoli, il counting sort seriale basta)
+        #pragma omp for schedule(dynamic)
+        for (int f = 0; f < numFlocks; ++f)
+            build_flock_grid(boids, ensemble, f);
+
+        // fase 2: porzioni di lavoro di tutti gli stormi in un'unica coda, dalla più costosa
+        #pragma omp for schedule(dynamic)
+        for (int t = 0; t < numTiles; ++t) {
+            const FlockTile& tile = ensemble.tiles[t];
+            const int offset = ensemble.flockStart[tile.flock];
+            interact_rows(ensemble.grids[tile.flock], ensemble.params[tile.flock], tile.rowBegin, tile.rowEnd, new_boids.x + offset,
+                          new_boids.y + offset, new_boids.vx + offset, new_boids.vy + offset, deltaTime, windowWidth, windowHeight);
+        }
+    }
+}
+
+void update_single_flock(const Boids& boids, Boids& new_boids, Ensemble& ensemble, int flock, float deltaTime, int windowWidth, int windowHeight)
+{
+    build_flock_grid(boids, ensemble, flock);
+    const SortedGrid& grid = ensemble.grids[flock];
+    const int offset = ensemble.flockStart[flock];
+
+    // una riga della griglia per iterazione, come farebbe il motore a stormo singolo
+    #pragma omp parallel for schedule(dynamic)
+    for (int cy = 0; cy < grid.gridHeight; ++cy)
+        interact_rows(grid, ensemble.params[flock], cy, cy + 1, new_boids.x + offset, new_boids.y + offset, new_boids.vx + offset,
+                      new_boids.vy + offset, deltaTime, windowWidth, windowHeight);
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <vector>
+
+#include "../seq_grid/spatial_grid.h"
+#include "../seq_grid/boids_kernel.h" // FlockParams: parametri del modello, distinti per ogni stormo
+
+// boids di più stormi indipendenti in un unico SoA: gli stormi occupano intervalli contigui [flockStart[f], flockStart[f + 1])
+struct Boids {
+    float* x;
+    float* y;
+    float* vx;
+    float* vy;
+    int count;
+};
+
+// porzione di lavoro: un intervallo di righe della griglia di uno stormo
+struct FlockTile {
+    int flock;
+    int rowBegin, rowEnd;
+};
+
+// insieme di stormi simulati insieme (stesso mondo, parametri diversi)
+struct Ensemble {
+    std::vector<FlockParams> params;
+    std::vector<int> flockStart;   // numFlocks + 1 elementi
+    std::vector<SortedGrid> grids; // una griglia per stormo, riusata fra i time step
+    std::vector<FlockTile> tiles;  // porzioni di lavoro ordinate per costo stimato decrescente
+
+    int num_flocks() const
+    {
+        return static_cast<int>(params.size());
+    }
+
+    int flock_size(int flock) const
+    {
+        return flockStart[flock + 1] - flockStart[flock];
+    }
+};
+
+// aggiunge uno stormo di numBoids boids (i boids vanno poi inizializzati nell'intervallo corrispondente)
+void add_flock(Ensemble& ensemble, const FlockParams& params, int numBoids);
+
+// prepara griglie e porzioni di lavoro (da chiamare dopo aver aggiunto tutti gli stormi)
+void prepare_ensemble(Ensemble& ensemble, int windowWidth, int windowHeight);
+
+// aggiorna tutti gli stormi: griglie costruite in parallelo sugli stormi, interazioni in parallelo sulle porzioni di lavoro
+void update_ensemble(const Boids& boids, Boids& new_boids, Ensemble& ensemble, float deltaTime, int windowWidth, int windowHeight);
+
+// aggiorna un solo stormo parallelizzando al suo interno (equivale a eseguire il motore su ogni stormo separatamente)
+void update_single_flock(const Boids& boids, Boids& new_boids, Ensemble& ensemble, int flock, float deltaTime, int windowWidth, int windowHeight);
@@ -0,0 +1,181 @@
+#ifdef _OPENMP
+#include <omp.h> // for OpenMP library functions
+#endif
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "boids_ensemble.h"
+
+// sweep di default: prodotto cartesiano dei valori sotto, ripetuto ensemble_replicas volte con stati iniziali diversi
+#define ensemble_boids_per_flock 500
+#define ensemble_replicas 2
+#define ensemble_time_steps 200
+#define ensemble_delta_time 0.8f // time step fisso (~ 1/60 s * speedUpSimulation)
+
+// buffer SoA contiguo per tutti gli stormi
+struct BoidsStorage {
+    std::vector<float> x, y, vx, vy;
+
+    explicit BoidsStorage(int count) : x(count), y(count), vx(count), vy(count) {}
+
+    Boids view()
+    {
+        return Boids{.x = x.data(), .y = y.data(), .vx = vx.data(), .vy = vy.data(), .count = static_cast<int>(x.size())};
+    }
+};
+
+// indicatori aggregati di uno stormo: polarizzazione (modulo della velocità media normalizzata), velocità media
+// e dispersione (distanza quadratica media dal baricentro)
+static void flock_summary(const Boids& boids, int begin, int end, float& polarization, float& meanSpeed, float& dispersion)
+{
+    const int n = end - begin;
+    if (n <= 0) { // stormo vuoto: nessuna media da calcolare
+        polarization = meanSpeed = dispersion = 0.0f;
+        return;
+    }
+
+    double ux = 0.0, uy = 0.0, speed = 0.0, cx = 0.0, cy = 0.0;
+    for (int i = begin; i < end; ++i) {
+        const double s = std::sqrt(boids.vx[i] * boids.vx[i] + boids.vy[i] * boids.vy[i]);
+        if (s > 0.0) {
+            ux += boids.vx[i] / s;
+            uy += boids.vy[i] / s;
+        }
+        speed += s;
+        cx += boids.x[i];
+        cy += boids.y[i];
+    }
+    cx /= n;
+    cy /= n;
+    double spread = 0.0;
+    for (int i = begin; i < end; ++i)
+        spread += (boids.x[i] - cx) * (boids.x[i] - cx) + (boids.y[i] - cy) * (boids.y[i] - cy);
+
+    polarization = static_cast<float>(std::sqrt(ux * ux + uy * uy) / n);
+    meanSpeed = static_cast<float>(speed / n);
+    dispersion = static_cast<float>(std::sqrt(spread / n));
+}
+
+// uso: ./PP_mid_assignment_ensemble [boids per stormo] [repliche] [time steps]
+int main(int argc, char* argv[])
+{
+    const int boidsPerFlock = argc > 1 ? std::atoi(argv[1]) : ensemble_boids_per_flock;
+    const int replicas = argc > 2 ? std::atoi(argv[2]) : ensemble_replicas;
+    const int timeSteps = argc > 3 ? std::atoi(argv[3]) : ensemble_time_steps;
+
+    const int windowWidth = 1280;
+    const int windowHeight = 720;
+
+    // parametri dello sweep
+    const float centeringFactors[] = {0.001f, 0.002f, 0.004f};
+    const float avoidFactors[] = {0.0125f, 0.025f, 0.05f};
+    const float visualRanges[] = {30.0f, 40.0f, 50.0f};
+
+    Ensemble ensemble;
+    for (int r = 0; r < replicas; ++r)
+        for (float centering : centeringFactors)
+            for (float avoid : avoidFactors)
+                for (float visual : visualRanges) {
+                    FlockParams params;
+                    params.centeringFactor = centering;
+                    params.avoidFactor = avoid;
+                    params.visualRange = visual;
+                    add_flock(ensemble, params, boidsPerFlock);
+                }
+    prepare_ensemble(ensemble, windowWidth, windowHeight);
+
+    const int numFlocks = ensemble.num_flocks();
+    const int totalBoids = ensemble.flockStart.back();
+
+    // stato iniziale (posizione e velocità random), condiviso dalle due esecuzioni
+    BoidsStorage initial(totalBoids);
+    srand(1234);
+    for (int i = 0; i < totalBoids; ++i) {
+        initial.x[i] = rand() % windowWidth;
+        initial.y[i] = rand() % windowHeight;
+        initial.vx[i] = (rand() % 600) / 100.0f - 3.0f;
+        initial.vy[i] = (rand() % 600) / 100.0f - 3.0f;
+    }
+
+    #ifdef _OPENMP
+    const int threads = omp_get_max_threads();
+    #else
+    const int threads = 1;
+    #endif
+    std::cout << "Ensemble di " << numFlocks << " stormi da " << boidsPerFlock << " boids (" << ensemble.tiles.size()
+              << " porzioni di lavoro), " << timeSteps << " time steps, " << threads << " threads." << std::endl;
+
+    // esecuzione 1: tutti gli stormi insieme
+    BoidsStorage current = initial, next(totalBoids);
+    Boids boids = current.view(), new_boids = next.view();
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int step = 0; step < timeSteps; ++step) {
+        update_ensemble(boids, new_boids, ensemble, ensemble_delta_time, windowWidth, windowHeight);
+        std::swap(boids, new_boids);
+    }
+    auto stop = std::chrono::high_resolution_clock::now();
+    const double ensembleSeconds = std::chrono::duration<double>(stop - start).count();
+
+    // esecuzione 2: uno stormo alla volta, parallelizzato al suo interno (come eseguire il motore una volta per stormo)
+    BoidsStorage singleCurrent = initial, singleNext(totalBoids);
+    double singleSeconds = 0.0;
+    for (int f = 0; f < numFlocks; ++f) {
+        Boids flockBoids = singleCurrent.view(), new_flockBoids = singleNext.view();
+        start = std::chrono::high_resolution_clock::now();
+        for (int step = 0; step < timeSteps; ++step) {
+            update_single_flock(flockBoids, new_flockBoids, ensemble, f, ensemble_delta_time, windowWidth, windowHeight);
+            std::swap(flockBoids, new_flockBoids);
+        }
+        stop = std::chrono::high_resolution_clock::now();
+        singleSeconds += std::chrono::duration<double>(stop - start).count();
+    }
+    // stesso numero di time steps per ogni stormo: lo stato finale è nello stesso buffer per tutti
+    const Boids singleFinal = timeSteps % 2 == 0 ? singleCurrent.view() : singleNext.view();
+
+    // le due esecuzioni usano lo stesso kernel sugli stessi dati: i risultati devono coincidere
+    float maxDifference = 0.0f;
+    for (int i = 0; i < totalBoids; ++i)
+        maxDifference = std::max({maxDifference, std::fabs(boids.x[i] - singleFinal.x[i]), std::fabs(boids.y[i] - singleFinal.y[i]),
+                                  std::fabs(boids.vx[i] - singleFinal.vx[i]), std::fabs(boids.vy[i] - singleFinal.vy[i])});
+
+    // risultati aggregati: una riga per stormo
+    std::ofstream csv("ensemble_results.csv");
+    if (!csv.is_open()) {
+        std::cerr << "Error opening results file." << std::endl;
+        return 1;
+    }
+    csv << "flock,boids,visual_range,protected_range,centering_factor,matching_factor,avoid_factor,time_steps,polarization,mean_speed,dispersion" << std::endl;
+    for (int f = 0; f < numFlocks; ++f) {
+        const FlockParams& p = ensemble.params[f];
+        float polarization, meanSpeed, dispersion;
+        flock_summary(boids, ensemble.flockStart[f], ensemble.flockStart[f + 1], polarization, meanSpeed, dispersion);
+        csv << f << "," << ensemble.flock_size(f) << "," << p.visualRange << "," << p.protectedRange << "," << p.centeringFactor << ","
+            << p.matchingFactor << "," << p.avoidFactor << "," << timeSteps << "," << polarization << "," << meanSpeed << "," << dispersion << std::endl;
+    }
+    csv.close();
+
+    // throughput in boid-steps al secondo
+    std::ofstream logFile("logfile_ensemble.txt");
+    if (!logFile.is_open())
+        std::cerr << "Error opening log file." << std::endl;
+
+    const double boidSteps = static_cast<double>(totalBoids) * timeSteps;
+    const std::string report =
+        "Ensemble (" + std::to_string(numFlocks) + " stormi, " + std::to_string(threads) + " threads): " + std::to_string(ensembleSeconds)
+        + " secondi, " + std::to_string(boidSteps / ensembleSeconds) + " boid-steps/s.\n"
+        + "Uno stormo alla volta: " + std::to_string(singleSeconds) + " secondi, " + std::to_string(boidSteps / singleSeconds) + " boid-steps/s.\n"
+        + "Speedup dell'ensemble: " + std::to_string(singleSeconds / ensembleSeconds) + "x, differenza massima fra i risultati: "
+        + std::to_string(maxDifference) + ".\n";
+    std::cout << report << "Risultati per stormo salvati in ensemble_results.csv" << std::endl;
+    logFile << report;
+    logFile.close();
+
+    return maxDifference == 0.0f ? 0 : 1;
+}
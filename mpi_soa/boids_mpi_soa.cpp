@@ -0,0 +1,359 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+#ifdef _OPENMP
+#include <omp.h> // for OpenMP library functions
+#endif
+
+#include "boids_mpi_soa.h"
+#include "../omp_soa/spatial_grid.h"
+
+#define visual_range 40.0f
+#define visual_range_squared (visual_range * visual_range)
+#define protected_range 8.0f
+#define protected_range_squared (protected_range * protected_range)
+#define centering_factor 0.002f
+#define matching_factor 0.05f
+#define avoid_factor 0.025f
+#define turn_factor 0.4f
+#define min_speed 3.0f
+#define max_speed 6.0f
+
+// algoritmo riadattato da https://vanhunteradams.com/Pico/Animal_Movement/Boids-algorithm.html
+
+// boid impacchettato per lo scambio di halo e la migrazione
+struct PackedBoid {
+    float x, y;
+    float vx, vy;
+    int id;
+};
+
+// somme sui vicini di un boid
+struct NeighborSums {
+    float xpos_avg = 0.0f, ypos_avg = 0.0f;
+    float xvel_avg = 0.0f, yvel_avg = 0.0f;
+    int neighboring_boids = 0;
+    float close_dx = 0.0f, close_dy = 0.0f;
+};
+
+StripDomain make_strip_domain(MPI_Comm comm, int worldWidth, int worldHeight, float deltaTime)
+{
+    StripDomain domain;
+    domain.comm = comm;
+    MPI_Comm_rank(comm, &domain.rank);
+    MPI_Comm_size(comm, &domain.size);
+
+    const float stripWidth = static_cast<float>(worldWidth) / domain.size;
+    if (stripWidth < visual_range) {
+        if (domain.rank == 0)
+            std::fprintf(stderr, "Strisce troppo strette: %d rank su un mondo largo %d (minimo %g per rank).\n", domain.size, worldWidth, visual_range);
+        MPI_Abort(comm, 1);
+    }
+
+    // condizione di tipo CFL: in un time step un boid percorre al più max_speed * deltaTime, che deve restare sotto
+    // la larghezza di una striscia perché la migrazione scambia i boids solo con i rank vicini
+    domain.maxDeltaTime = stripWidth / max_speed;
+    if (deltaTime >= domain.maxDeltaTime) {
+        if (domain.rank == 0)
+            std::fprintf(stderr, "Time step troppo lungo: %g con strisce larghe %g (massimo %g, max_speed * deltaTime < larghezza).\n",
+                         deltaTime, stripWidth, domain.maxDeltaTime);
+        MPI_Abort(comm, 1);
+    }
+
+    domain.x0 = domain.rank * stripWidth;
+    domain.x1 = (domain.rank + 1) * stripWidth;
+    domain.left = domain.rank > 0 ? domain.rank - 1 : MPI_PROC_NULL;
+    domain.right = domain.rank < domain.size - 1 ? domain.rank + 1 : MPI_PROC_NULL;
+    domain.worldWidth = worldWidth;
+    domain.worldHeight = worldHeight;
+    return domain;
+}
+
+int strip_owner(const StripDomain& domain, float x)
+{
+    const float stripWidth = static_cast<float>(domain.worldWidth) / domain.size;
+    const int owner = static_cast<int>(std::floor(x / stripWidth));
+    return std::clamp(owner, 0, domain.size - 1);
+}
+
+void take_owned_boids(const StripDomain& domain, const float* x, const float* y, const float* vx, const float* vy, int count, LocalBoids& local)
+{
+    local.clear();
+    for (int i = 0; i < count; ++i)
+        if (strip_owner(domain, x[i]) == domain.rank)
+            local.push_back(x[i], y[i], vx[i], vy[i], i);
+}
+
+void gather_boids(const StripDomain& domain, const LocalBoids& local, int root, float* x, float* y, float* vx, float* vy, int count)
+{
+    std::vector<PackedBoid> packed(local.count());
+    for (int i = 0; i < local.count(); ++i)
+        packed[i] = {local.x[i], local.y[i], local.vx[i], local.vy[i], local.id[i]};
+
+    // dimensioni (in byte) dei contributi di ogni rank
+    const int bytes = static_cast<int>(packed.size() * sizeof(PackedBoid));
+    std::vector<int> recvBytes(domain.size), displs(domain.size);
+    MPI_Gather(&bytes, 1, MPI_INT, recvBytes.data(), 1, MPI_INT, root, domain.comm);
+
+    std::vector<PackedBoid> all;
+    if (domain.rank == root) {
+        int total = 0;
+        for (int r = 0; r < domain.size; ++r) {
+            displs[r] = total;
+            total += recvBytes[r];
+        }
+        all.resize(total / sizeof(PackedBoid));
+    }
+    MPI_Gatherv(packed.data(), bytes, MPI_BYTE, all.data(), recvBytes.data(), displs.data(), MPI_BYTE, root, domain.comm);
+
+    if (domain.rank == root) {
+        for (const PackedBoid& b : all) {
+            if (b.id < 0 || b.id >= count)
+                continue;
+            x[b.id] = b.x;
+            y[b.id] = b.y;
+            vx[b.id] = b.vx;
+            vy[b.id] = b.vy;
+        }
+    }
+}
+
+// accumula i contributi dei boids di una griglia (cella + 8 adiacenti dentro la griglia), self = indice da escludere (-1 se nessuno);
+// la griglia copre solo la striscia allargata, con origine originX (le distanze restano in coordinate del mondo)
+static inline void accumulate_neighbors(const SpatialGrid& grid, float originX, const float* gx, const float* gy, const float* gvx, const float* gvy,
+                                        float bx, float by, int self, NeighborSums& sums)
+{
+    grid.query(bx - originX, by, [&](NeighborRange range) {
+        for (const int* it = range.begin(); it != range.end(); ++it) {
+            const int j = *it;
+            if (j == self)
+                continue;
+
+            // calcola la differenza di posizione con l'altro boid
+            const float dxw = bx - gx[j];
+            const float dyw = by - gy[j];
+
+            // le due differenze sono minori del visual range?
+            if (std::fabs(dxw) < visual_range && std::fabs(dyw) < visual_range) {
+                const float squared_distance = dxw * dxw + dyw * dyw;
+
+                // il quadrato della distanza è minore del quadrato del protected range?
+                if (squared_distance < protected_range_squared) {
+                    sums.close_dx += dxw;
+                    sums.close_dy += dyw;
+                } else if (squared_distance < visual_range_squared) { // il quadrato della distanza è minore del quadrato del visual range?
+                    // aggiungi i contributi per calcolare il centro dello stormo
+                    sums.xpos_avg += gx[j];
+                    sums.ypos_avg += gy[j];
+                    sums.xvel_avg += gvx[j];
+                    sums.yvel_avg += gvy[j];
+                    sums.neighboring_boids++;
+                }
+            }
+        }
+    });
+}
+
+// applica le regole al boid i e scrive il nuovo stato nello stesso indice di new_boids
+static inline void steer_and_integrate(const LocalBoids& boids, LocalBoids& new_boids, int i, NeighborSums sums, float deltaTime, int windowWidth, int windowHeight)
+{
+    const float px = boids.x[i];
+    const float py = boids.y[i];
+    float vx = boids.vx[i];
+    float vy = boids.vy[i];
+
+    // se ci sono boids vicini, calcola il centro dello stormo
+    if (sums.neighboring_boids > 0) {
+        sums.xpos_avg /= static_cast<float>(sums.neighboring_boids);
+        sums.ypos_avg /= static_cast<float>(sums.neighboring_boids);
+        sums.xvel_avg /= static_cast<float>(sums.neighboring_boids);
+        sums.yvel_avg /= static_cast<float>(sums.neighboring_boids);
+
+        // aggiusta la velocità del boid con il centering factor per avvicinarsi al centro dei vicini (cohesion rule)
+        vx += (sums.xpos_avg - px) * centering_factor;
+        vy += (sums.ypos_avg - py) * centering_factor;
+
+        // aggiusta la velocità del boid con il matching factor per avvicinarsi alla velocità media dei vicini (alignment rule)
+        vx += (sums.xvel_avg - vx) * matching_factor;
+        vy += (sums.yvel_avg - vy) * matching_factor;
+    }
+
+    // aggiusta la velocità con il avoid factor per allontanarsi dai boids vicini (separation rule)
+    vx += sums.close_dx * avoid_factor;
+    vy += sums.close_dy * avoid_factor;
+
+    // gestione dei margini dello schermo
+    if (py < windowHeight * 0.05f) vy += turn_factor;
+    if (px > windowWidth  * 0.95f) vx -= turn_factor;
+    if (px < windowWidth  * 0.05f) vx += turn_factor;
+    if (py > windowHeight * 0.95f) vy -= turn_factor;
+
+    // calcolo della norma della velocità e clamp fra minima e massima velocità
+    float speed = sqrtf(vx * vx + vy * vy);
+    if (speed < min_speed && speed > 0.0f) {
+        vx = (vx / speed) * min_speed;
+        vy = (vy / speed) * min_speed;
+    }
+    if (speed > max_speed) {
+        vx = (vx / speed) * max_speed;
+        vy = (vy / speed) * max_speed;
+    }
+
+    // aggiornamento finale della posizione (e della velocità)
+    new_boids.vx[i] = vx;
+    new_boids.vy[i] = vy;
+    new_boids.x[i] = px + vx * deltaTime;
+    new_boids.y[i] = py + vy * deltaTime;
+    new_boids.id[i] = boids.id[i];
+}
+
+// costruisce la griglia (seriale) sugli array di posizioni dati, spostati nel sistema della griglia che parte da originX
+static void build_local_grid(SpatialGrid& grid, float originX, const float* x, const float* y, int count)
+{
+    grid.clear();
+    for (int i = 0; i < count; ++i)
+        grid.insert(x[i] - originX, y[i]);
+    grid.build();
+    for (int i = 0; i < count; ++i)
+        grid.insert_index(i, x[i] - originX, y[i]);
+}
+
+// scambia con i vicini sinistro e destro i boids impacchettati (prima le dimensioni, poi i dati)
+static void exchange_with_neighbors(const StripDomain& domain, const std::vector<PackedBoid>& toLeft, const std::vector<PackedBoid>& toRight,
+                                    std::vector<PackedBoid>& fromLeft, std::vector<PackedBoid>& fromRight, MPI_Request requests[4], int tag)
+{
+    int sendCounts[2] = {static_cast<int>(toLeft.size()), static_cast<int>(toRight.size())};
+    int recvCounts[2] = {0, 0};
+    MPI_Sendrecv(&sendCounts[0], 1, MPI_INT, domain.left, tag, &recvCounts[1], 1, MPI_INT, domain.right, tag, domain.comm, MPI_STATUS_IGNORE);
+    MPI_Sendrecv(&sendCounts[1], 1, MPI_INT, domain.right, tag + 1, &recvCounts[0], 1, MPI_INT, domain.left, tag + 1, domain.comm, MPI_STATUS_IGNORE);
+
+    fromLeft.resize(recvCounts[0]);
+    fromRight.resize(recvCounts[1]);
+
+    // scambio dei dati non bloccante: il chiamante attende le richieste quando ha bisogno dei dati
+    MPI_Irecv(fromLeft.data(), recvCounts[0] * sizeof(PackedBoid), MPI_BYTE, domain.left, tag + 2, domain.comm, &requests[0]);
+    MPI_Irecv(fromRight.data(), recvCounts[1] * sizeof(PackedBoid), MPI_BYTE, domain.right, tag + 3, domain.comm, &requests[1]);
+    MPI_Isend(toLeft.data(), sendCounts[0] * sizeof(PackedBoid), MPI_BYTE, domain.left, tag + 3, domain.comm, &requests[2]);
+    MPI_Isend(toRight.data(), sendCounts[1] * sizeof(PackedBoid), MPI_BYTE, domain.right, tag + 2, domain.comm, &requests[3]);
+}
+
+// funzione per aggiornare le posizioni di tutti i boids del rank
+void update_all_boids(const LocalBoids& boids, LocalBoids& new_boids, const StripDomain& domain, StripWorkspace& workspace, float deltaTime)
+{
+    if (deltaTime >= domain.maxDeltaTime) {
+        std::fprintf(stderr, "Time step %g oltre il massimo %g della decomposizione.\n", deltaTime, domain.maxDeltaTime);
+        MPI_Abort(domain.comm, 1);
+    }
+
+    const int count = boids.count();
+    const bool hasLeft = domain.left != MPI_PROC_NULL;
+    const bool hasRight = domain.right != MPI_PROC_NULL;
+
+    // fase 1: halo in uscita (boids entro visual_range dai confini con altri rank) e classificazione interni / di bordo
+    std::vector<PackedBoid> haloToLeft, haloToRight;
+    std::vector<int> interior, boundary;
+    for (int i = 0; i < count; ++i) {
+        const bool nearLeft = hasLeft && boids.x[i] < domain.x0 + visual_range;
+        const bool nearRight = hasRight && boids.x[i] >= domain.x1 - visual_range;
+        if (nearLeft)
+            haloToLeft.push_back({boids.x[i], boids.y[i], boids.vx[i], boids.vy[i], boids.id[i]});
+        if (nearRight)
+            haloToRight.push_back({boids.x[i], boids.y[i], boids.vx[i], boids.vy[i], boids.id[i]});
+        if (nearLeft || nearRight)
+            boundary.push_back(i);
+        else
+            interior.push_back(i);
+    }
+
+    std::vector<PackedBoid> haloFromLeft, haloFromRight;
+    MPI_Request haloRequests[4];
+    exchange_with_neighbors(domain, haloToLeft, haloToRight, haloFromLeft, haloFromRight, haloRequests, 100);
+
+    // fase 2: griglia sui boids posseduti e update dei boids interni, mentre gli halo sono in viaggio
+    new_boids.x.resize(count);
+    new_boids.y.resize(count);
+    new_boids.vx.resize(count);
+    new_boids.vy.resize(count);
+    new_boids.id.resize(count);
+
+    // griglie della sola striscia allargata di visual_range per lato [x0 - visual_range, x1 + visual_range): memoria e costo
+    // di costruzione scalano con la striscia; i boids fuori (strisce di bordo del mondo) finiscono nelle celle estreme
+    // come nella griglia del mondo intero; prese dal workspace e ridimensionate, quindi nessuna allocazione a regime
+    SpatialGrid& grid = workspace.grid;
+    SpatialGrid& haloGrid = workspace.haloGrid;
+    const float originX = domain.x0 - visual_range;
+    const int localWidth = static_cast<int>(std::ceil(domain.x1 - domain.x0 + 2.0f * visual_range));
+    grid.resize(visual_range, localWidth, domain.worldHeight, count);
+    build_local_grid(grid, originX, boids.x.data(), boids.y.data(), count);
+
+    const int numInterior = static_cast<int>(interior.size());
+    #pragma omp parallel for schedule(static)
+    for (int k = 0; k < numInterior; ++k) {
+        const int i = interior[k];
+        NeighborSums sums;
+        accumulate_neighbors(grid, originX, boids.x.data(), boids.y.data(), boids.vx.data(), boids.vy.data(), boids.x[i], boids.y[i], i, sums);
+        steer_and_integrate(boids, new_boids, i, sums, deltaTime, domain.worldWidth, domain.worldHeight);
+    }
+
+    // fase 3: attesa degli halo, griglia separata sugli halo e update dei boids di bordo
+    MPI_Waitall(4, haloRequests, MPI_STATUSES_IGNORE);
+
+    const int numHalo = static_cast<int>(haloFromLeft.size() + haloFromRight.size());
+    std::vector<float> hx(numHalo), hy(numHalo), hvx(numHalo), hvy(numHalo);
+    int h = 0;
+    for (const std::vector<PackedBoid>* halo : {&haloFromLeft, &haloFromRight}) {
+        for (const PackedBoid& b : *halo) {
+            hx[h] = b.x;
+            hy[h] = b.y;
+            hvx[h] = b.vx;
+            hvy[h] = b.vy;
+            h++;
+        }
+    }
+    haloGrid.resize(visual_range, localWidth, domain.worldHeight, numHalo);
+    build_local_grid(haloGrid, originX, hx.data(), hy.data(), numHalo);
+
+    const int numBoundary = static_cast<int>(boundary.size());
+    #pragma omp parallel for schedule(static)
+    for (int k = 0; k < numBoundary; ++k) {
+        const int i = boundary[k];
+        NeighborSums sums;
+        accumulate_neighbors(grid, originX, boids.x.data(), boids.y.data(), boids.vx.data(), boids.vy.data(), boids.x[i], boids.y[i], i, sums);
+        accumulate_neighbors(haloGrid, originX, hx.data(), hy.data(), hvx.data(), hvy.data(), boids.x[i], boids.y[i], -1, sums);
+        steer_and_integrate(boids, new_boids, i, sums, deltaTime, domain.worldWidth, domain.worldHeight);
+    }
+
+    // fase 4: migrazione dei boids usciti dalla striscia (si muovono al massimo di max_speed * deltaTime, meno di una striscia
+    // per il controllo in make_strip_domain, quindi solo verso i vicini)
+    std::vector<PackedBoid> migrateToLeft, migrateToRight;
+    int kept = 0;
+    for (int i = 0; i < count; ++i) {
+        const int owner = strip_owner(domain, new_boids.x[i]);
+        if (owner == domain.rank) {
+            new_boids.x[kept] = new_boids.x[i];
+            new_boids.y[kept] = new_boids.y[i];
+            new_boids.vx[kept] = new_boids.vx[i];
+            new_boids.vy[kept] = new_boids.vy[i];
+            new_boids.id[kept] = new_boids.id[i];
+            kept++;
+        } else {
+            const PackedBoid b = {new_boids.x[i], new_boids.y[i], new_boids.vx[i], new_boids.vy[i], new_boids.id[i]};
+            (owner < domain.rank ? migrateToLeft : migrateToRight).push_back(b);
+        }
+    }
+    new_boids.x.resize(kept);
+    new_boids.y.resize(kept);
+    new_boids.vx.resize(kept);
+    new_boids.vy.resize(kept);
+    new_boids.id.resize(kept);
+
+    std::vector<PackedBoid> migrateFromLeft, migrateFromRight;
+    MPI_Request migrateRequests[4];
+    exchange_with_neighbors(domain, migrateToLeft, migrateToRight, migrateFromLeft, migrateFromRight, migrateRequests, 200);
+    MPI_Waitall(4, migrateRequests, MPI_STATUSES_IGNORE);
+
+    for (const std::vector<PackedBoid>* incoming : {&migrateFromLeft, &migrateFromRight})
+        for (const PackedBoid& b : *incoming)
+            new_boids.push_back(b.x, b.y, b.vx, b.vy, b.id);
+}
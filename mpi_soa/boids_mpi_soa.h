@@ -0,0 +1,77 @@
+#pragma once
+
+#include <vector>
+
+#include <mpi.h>
+
+#include "../omp_soa/spatial_grid.h"
+
+// boids posseduti da un rank: SoA a dimensione variabile (i boids migrano fra i rank) con identificativo globale
+struct LocalBoids {
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> vx;
+    std::vector<float> vy;
+    std::vector<int> id;
+
+    int count() const
+    {
+        return static_cast<int>(x.size());
+    }
+
+    void clear()
+    {
+        x.clear();
+        y.clear();
+        vx.clear();
+        vy.clear();
+        id.clear();
+    }
+
+    void push_back(float px, float py, float pvx, float pvy, int pid)
+    {
+        x.push_back(px);
+        y.push_back(py);
+        vx.push_back(pvx);
+        vy.push_back(pvy);
+        id.push_back(pid);
+    }
+};
+
+// decomposizione del mondo in strisce verticali, una per rank
+struct StripDomain {
+    MPI_Comm comm;
+    int rank;
+    int size;
+    int left;        // rank a sinistra (MPI_PROC_NULL sul bordo del mondo)
+    int right;       // rank a destra (MPI_PROC_NULL sul bordo del mondo)
+    float x0, x1;    // striscia posseduta [x0, x1)
+    int worldWidth;
+    int worldHeight;
+    float maxDeltaTime; // time step massimo: max_speed * deltaTime deve restare sotto la larghezza di una striscia
+};
+
+// crea la decomposizione per il comunicatore dato e il time step della simulazione: le strisce devono essere larghe
+// almeno visual_range (gli halo arrivano solo dai vicini) e più di max_speed * deltaTime (un boid migra solo verso un vicino)
+StripDomain make_strip_domain(MPI_Comm comm, int worldWidth, int worldHeight, float deltaTime);
+
+// rank che possiede la posizione x (i boids fuori dal mondo appartengono alle strisce di bordo)
+int strip_owner(const StripDomain& domain, float x);
+
+// tiene solo i boids dello stato globale (identico su tutti i rank) posseduti da questo rank
+void take_owned_boids(const StripDomain& domain, const float* x, const float* y, const float* vx, const float* vy, int count, LocalBoids& local);
+
+// raccoglie lo stato globale ordinato per identificativo sul rank root (array di dimensione count validi solo su root)
+void gather_boids(const StripDomain& domain, const LocalBoids& local, int root, float* x, float* y, float* vx, float* vy, int count);
+
+// griglie della striscia allargata (boids posseduti e halo) riusate fra i time step: appartengono al chiamante,
+// una per simulazione e usata da una sola chiamata alla volta
+struct StripWorkspace {
+    SpatialGrid grid;
+    SpatialGrid haloGrid;
+};
+
+// funzione per aggiornare la posizione di tutti i boids del rank: scambio degli halo sovrapposto al calcolo
+// delle celle interne, poi celle di bordo e migrazione dei boids che cambiano striscia
+// (deltaTime deve essere minore di domain.maxDeltaTime, altrimenti il programma termina con MPI_Abort)
+void update_all_boids(const LocalBoids& boids, LocalBoids& new_boids, const StripDomain& domain, StripWorkspace& workspace, float deltaTime);
@@ -0,0 +1,184 @@
+#ifdef _OPENMP
+#include <omp.h> // for OpenMP library functions
+#endif
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <mpi.h>
+
+#include "boids_mpi_soa.h"
+
+// passi e tolleranza della verifica contro l'esecuzione su un solo rank
+#define verify_agents 2000
+#define verify_time_steps 10
+#define verify_tolerance 1e-3f
+
+// stato iniziale globale (identico su tutti i rank dato lo stesso seed)
+static void make_initial_state(int agents, int windowWidth, int windowHeight, unsigned seed, bool randomVelocity,
+                               std::vector<float>& x, std::vector<float>& y, std::vector<float>& vx, std::vector<float>& vy)
+{
+    x.resize(agents);
+    y.resize(agents);
+    vx.resize(agents);
+    vy.resize(agents);
+    srand(seed);
+    for (int i = 0; i < agents; ++i) {
+        x[i] = rand() % windowWidth;
+        y[i] = rand() % windowHeight;
+        vx[i] = randomVelocity ? (rand() % 600) / 100.0f - 3.0f : 0;
+        vy[i] = randomVelocity ? (rand() % 600) / 100.0f - 3.0f : 0;
+    }
+}
+
+// esegue la stessa simulazione distribuita e su un solo rank (MPI_COMM_SELF sul rank 0) e confronta gli stati finali
+static int verify_against_single_rank(const StripDomain& domain, float deltaTime)
+{
+    std::vector<float> x, y, vx, vy;
+    make_initial_state(verify_agents, domain.worldWidth, domain.worldHeight, 42, true, x, y, vx, vy);
+
+    // simulazione distribuita
+    LocalBoids boids, new_boids;
+    StripWorkspace workspace;
+    take_owned_boids(domain, x.data(), y.data(), vx.data(), vy.data(), verify_agents, boids);
+    for (int step = 0; step < verify_time_steps; ++step) {
+        update_all_boids(boids, new_boids, domain, workspace, deltaTime);
+        std::swap(boids, new_boids);
+    }
+
+    // nessun boid deve essere perso o duplicato durante le migrazioni
+    int localCount = boids.count();
+    int globalCount = 0;
+    MPI_Reduce(&localCount, &globalCount, 1, MPI_INT, MPI_SUM, 0, domain.comm);
+
+    std::vector<float> gx(verify_agents, NAN), gy(verify_agents, NAN), gvx(verify_agents, NAN), gvy(verify_agents, NAN);
+    gather_boids(domain, boids, 0, gx.data(), gy.data(), gvx.data(), gvy.data(), verify_agents);
+
+    int failed = 0;
+    if (domain.rank == 0) {
+        // riferimento su un solo rank
+        const StripDomain single = make_strip_domain(MPI_COMM_SELF, domain.worldWidth, domain.worldHeight, deltaTime);
+        LocalBoids ref, new_ref;
+        StripWorkspace singleWorkspace; // griglie del mondo intero, distinte da quelle della striscia
+        take_owned_boids(single, x.data(), y.data(), vx.data(), vy.data(), verify_agents, ref);
+        for (int step = 0; step < verify_time_steps; ++step) {
+            update_all_boids(ref, new_ref, single, singleWorkspace, deltaTime);
+            std::swap(ref, new_ref);
+        }
+        std::vector<float> rx(verify_agents), ry(verify_agents), rvx(verify_agents), rvy(verify_agents);
+        gather_boids(single, ref, 0, rx.data(), ry.data(), rvx.data(), rvy.data(), verify_agents);
+
+        float maxError = 0.0f;
+        for (int i = 0; i < verify_agents; ++i) {
+            const float error = std::max({std::fabs(gx[i] - rx[i]), std::fabs(gy[i] - ry[i]), std::fabs(gvx[i] - rvx[i]), std::fabs(gvy[i] - rvy[i])});
+            maxError = std::isnan(error) ? INFINITY : std::max(maxError, error);
+        }
+
+        std::cout << "Verifica con " << domain.size << " rank: " << globalCount << " boids su " << verify_agents
+                  << ", errore massimo rispetto a un solo rank " << maxError << std::endl;
+        failed = globalCount != verify_agents || !(maxError <= verify_tolerance);
+        std::cout << (failed ? "Verifica fallita." : "Verifica superata.") << std::endl;
+    }
+    MPI_Bcast(&failed, 1, MPI_INT, 0, domain.comm);
+    return failed;
+}
+
+int main(int argc, char* argv[])
+{
+    // le chiamate MPI avvengono solo fuori dalle regioni OpenMP
+    int provided;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+
+    // esegui il programma per un numero diverso di agenti (boids)
+    const int numberOfAgentsCases = 6;
+    const int numberOfAgents[numberOfAgentsCases] = {1000, 5000, 10000, 20000, 50000, 100000};
+    // esegui il ogni caso di agents per tot volte
+    const int numberOfRuns = 5;
+    // fattore di velocità globale di simulazione (time step fisso: nessuna finestra da cui misurarlo)
+    const float speedUpSimulation = 50;
+    const float deltaTime = speedUpSimulation / 60.0f;
+    // esegui il programma per un certo numero di time steps
+    const int maxTimeSteps = 500;
+
+    const int windowWidth = 1280;
+    const int windowHeight = 720;
+    const StripDomain domain = make_strip_domain(MPI_COMM_WORLD, windowWidth, windowHeight, deltaTime);
+
+    // mpirun -np <rank> ./PP_mid_assignment_mpi_soa --verify
+    if (argc > 1 && std::string(argv[1]) == "--verify") {
+        const int failed = verify_against_single_rank(domain, deltaTime);
+        MPI_Finalize();
+        return failed;
+    }
+
+    // array per raccogliere i tempi di esecuzione
+    double simulationTimes[numberOfAgentsCases][numberOfRuns];
+
+    // file di log per salvare i risultati (solo rank 0)
+    std::ofstream logFile;
+    if (domain.rank == 0) {
+        logFile.open("logfile_mpi_soa.txt");
+        if (!logFile.is_open())
+            std::cerr << "Error opening log file." << std::endl;
+        std::cout << "Rank MPI: " << domain.size << std::endl;
+        #ifdef _OPENMP
+        std::cout << "Thread OpenMP per rank: " << omp_get_max_threads() << std::endl;
+        #endif
+    }
+
+    for (int ai = 0; ai < numberOfAgentsCases; ai++)
+    {
+        for (int ri = 0; ri < numberOfRuns; ri++)
+        {
+            if (domain.rank == 0)
+                std::cout << "Inizio simulazione n. " << (ri + 1) << " su " << numberOfAgents[ai] << " boids con " << domain.size << " rank." << std::endl;
+
+            // inizializzazione stato boids (posizione iniziale random e velocità nulla), ogni rank tiene solo la propria striscia
+            std::vector<float> x, y, vx, vy;
+            make_initial_state(numberOfAgents[ai], windowWidth, windowHeight, ri, false, x, y, vx, vy);
+            LocalBoids boids, new_boids;
+            StripWorkspace workspace;
+            take_owned_boids(domain, x.data(), y.data(), vx.data(), vy.data(), numberOfAgents[ai], boids);
+
+            // ciclo principale di esecuzione
+            MPI_Barrier(domain.comm);
+            const double start = MPI_Wtime();
+            for (int step = 0; step < maxTimeSteps; ++step)
+            {
+                update_all_boids(boids, new_boids, domain, workspace, deltaTime);
+                std::swap(boids, new_boids);
+            }
+            const double localTime = MPI_Wtime() - start;
+
+            // il tempo della simulazione è quello del rank più lento
+            double totalSimulationTime = 0.0;
+            MPI_Reduce(&localTime, &totalSimulationTime, 1, MPI_DOUBLE, MPI_MAX, 0, domain.comm);
+
+            if (domain.rank == 0) {
+                std::cout << "Tempo di esecuzione per simulazione boids: " << totalSimulationTime << " secondi." << std::endl;
+                simulationTimes[ai][ri] = totalSimulationTime;
+            }
+        }
+    }
+
+    // calcolo tempo di esecuzione medio per ogni numero di agenti e stampa delle misurazioni ottenute a schermo e su file di log
+    if (domain.rank == 0) {
+        for (int ai = 0; ai < numberOfAgentsCases; ai++)
+        {
+            double meanTime = 0.0;
+            for (int ri = 0; ri < numberOfRuns; ri++)
+                meanTime += simulationTimes[ai][ri];
+            meanTime /= numberOfRuns;
+            std::cout << "Tempo di esecuzione medio per " << numberOfAgents[ai] << " boids con " << domain.size << " rank: " << meanTime << " secondi." << std::endl;
+            logFile << "Tempo di esecuzione medio per " << numberOfAgents[ai] << " boids con " << domain.size << " rank: " << meanTime << " secondi." << std::endl;
+        }
+        logFile.close();
+    }
+
+    MPI_Finalize();
+}
@@ -1,5 +1,7 @@
 #include "boids_omp_aos.h"
 #include "spatial_grid.h"
+#include "../common/perf_counters.h"
+#include "../common/fast_math.h"
 #include <cmath>
 
 #ifdef _OPENMP
@@ -14,8 +16,6 @@
 #define matching_factor 0.05f
 #define avoid_factor 0.025f
 #define turn_factor 0.4f
-#define max_bias 0.01f
-#define bias_increment 0.00004f
 #define min_speed 3.0f
 #define max_speed 6.0f
 
@@ -24,39 +24,90 @@
 // algoritmo riadattato da https://vanhunteradams.com/Pico/Animal_Movement/Boids-algorithm.html
 
 // funzione per aggiornare la posizione di tutti i boids per un time step
-void update_all_boids(const Boid* boids, Boid* new_boids, int num_boids, float deltaTime, int windowWidth, int windowHeight)
+void update_all_boids(const Boid* boids, Boid* new_boids, int num_boids, AosWorkspace& workspace, float deltaTime, int windowWidth, int windowHeight)
 {
     #if spatial_partitioning_on
-    // crea la griglia prima del ciclo OpenMP
-    SpatialGrid grid(visual_range); // cell size = visual_range
+    // crea la griglia prima del ciclo OpenMP (riusata fra i time step, nessuna allocazione a regime)
+    perf_phase_begin(PHASE_GRID_BUILD);
+    SpatialGrid& grid = workspace.grid;
+    grid.cellSize = visual_range;
     grid.clear();
     for (int i = 0; i < num_boids; ++i)
         grid.insert((Boid*)&boids[i]);
+    perf_phase_end(PHASE_GRID_BUILD);
+
+    // liste dei vicini di ogni thread (riusate fra i boids e fra i time step)
+    std::vector<std::vector<Boid*>>& threadNeighborPtrs = workspace.threadNeighborPtrs;
+    std::vector<std::vector<Boid>>& threadNeighbors = workspace.threadNeighbors;
+    #else
+    (void)workspace;
     #endif
 
     // aggiorna lo stato dei boids
-    #pragma omp parallel for schedule(static)
-    for (int i = 0; i < num_boids; ++i)
+    #pragma omp parallel
     {
-        // copia dal vecchio al nuovo buffer
-        new_boids[i] = boids[i];
-
         #if spatial_partitioning_on
-        // prendi solo vicini rilevanti dalla griglia
-        const std::vector<Boid*> neighborPtrs = grid.get_neighbors((Boid*)&boids[i]);
-        std::vector<Boid> neighbors = {};
-        for (Boid* np: neighborPtrs)
-            neighbors.push_back(*np);
-
-        // aggiorna posizione basandosi solo sui vicini
-        update_boid_position(&new_boids[i], neighbors.data(), neighbors.size(), deltaTime, windowWidth, windowHeight);
+        #ifdef _OPENMP
+        const int numThreads = omp_get_num_threads();
+        const int thread = omp_get_thread_num();
         #else
-        // aggiorna il nuovo elemento leggendo gli altri boids dal vecchio buffer per evitare di sporcare il nuovo con scritture concorrenti
-        update_boid_position(&new_boids[i], boids, num_boids, deltaTime, windowWidth, windowHeight);
+        const int numThreads = 1;
+        const int thread = 0;
+        #endif
+
+        #pragma omp single
+        {
+            threadNeighborPtrs.resize(numThreads);
+            threadNeighbors.resize(numThreads);
+        }
+        std::vector<Boid*>& neighborPtrs = threadNeighborPtrs[thread];
+        std::vector<Boid>& neighbors = threadNeighbors[thread];
+        #endif
+
+        perf_phase_begin(PHASE_UPDATE);
+        #if perf_counters_on
+        long long interactions = 0;
         #endif
+        #pragma omp for schedule(static) nowait
+        for (int i = 0; i < num_boids; ++i)
+        {
+            // copia dal vecchio al nuovo buffer
+            new_boids[i] = boids[i];
+
+            #if spatial_partitioning_on
+            // prendi solo vicini rilevanti dalla griglia
+            grid.get_neighbors((Boid*)&boids[i], neighborPtrs);
+            neighbors.clear();
+            for (Boid* np: neighborPtrs)
+                neighbors.push_back(*np);
+            #if perf_counters_on
+            interactions += neighbors.size();
+            #endif
+
+            // aggiorna posizione basandosi solo sui vicini
+            update_boid_position(&new_boids[i], neighbors.data(), neighbors.size(), deltaTime, windowWidth, windowHeight);
+            #else
+            #if perf_counters_on
+            interactions += num_boids;
+            #endif
+            // aggiorna il nuovo elemento leggendo gli altri boids dal vecchio buffer per evitare di sporcare il nuovo con scritture concorrenti
+            update_boid_position(&new_boids[i], boids, num_boids, deltaTime, windowWidth, windowHeight);
+            #endif
+        }
+        #if perf_counters_on
+        perf_add_interactions(interactions);
+        #endif
+        perf_phase_end(PHASE_UPDATE);
     }
 }
 
+// come sopra con un workspace locale: rientrante, ma alloca griglia e liste dei vicini a ogni chiamata
+void update_all_boids(const Boid* boids, Boid* new_boids, int num_boids, float deltaTime, int windowWidth, int windowHeight)
+{
+    AosWorkspace workspace;
+    update_all_boids(boids, new_boids, num_boids, workspace, deltaTime, windowWidth, windowHeight);
+}
+
 // funzione per aggiornare la posizione di un boid per un time step
 void update_boid_position(Boid* boid, const Boid* otherboids, const int num_boids, float deltaTime, int windowWidth, int windowHeight)
 {
@@ -67,6 +118,27 @@ void update_boid_position(Boid* boid, const Boid* otherboids, const int num_boid
     float close_dx = 0.0f, close_dy = 0.0f;
 
     // itera su tutti gli altri boids dello stormo
+    #if fast_math_on
+    // kernel veloce: un solo test sul quadrato della distanza e contributi scelti senza rami
+    // (il boid stesso, se presente fra gli altri, ha distanza nulla e contribuisce solo con differenze nulle)
+    #pragma omp simd reduction(+:xpos_avg, ypos_avg, xvel_avg, yvel_avg, neighboring_boids, close_dx, close_dy)
+    for (int i = 0; i < num_boids; i++) {
+        const Boid* otherboid = &otherboids[i];
+        const float dx = boid->x - otherboid->x;
+        const float dy = boid->y - otherboid->y;
+        const float squared_distance = dx * dx + dy * dy;
+        const bool close = squared_distance < protected_range_squared;
+        const bool visible = !close && squared_distance < visual_range_squared;
+
+        close_dx += close ? dx : 0.0f;
+        close_dy += close ? dy : 0.0f;
+        xpos_avg += visible ? otherboid->x : 0.0f;
+        ypos_avg += visible ? otherboid->y : 0.0f;
+        xvel_avg += visible ? otherboid->vx : 0.0f;
+        yvel_avg += visible ? otherboid->vy : 0.0f;
+        neighboring_boids += visible;
+    }
+    #else
     #pragma omp simd reduction(+:xpos_avg, ypos_avg, xvel_avg, yvel_avg, neighboring_boids, close_dx, close_dy)
     for (int i = 0; i < num_boids; i++) {
         const Boid* otherboid = &otherboids[i];
@@ -93,6 +165,7 @@ void update_boid_position(Boid* boid, const Boid* otherboids, const int num_boid
             }
         }
     }
+    #endif
 
     // se ci sono boids vicini, calcola il centro dello stormo
     if (neighboring_boids > 0) {
@@ -120,11 +193,15 @@ void update_boid_position(Boid* boid, const Boid* otherboids, const int num_boid
     if (boid->x < windowWidth * 0.05f) boid->vx += turn_factor;
     if (boid->y > windowHeight * 0.95f) boid->vy -= turn_factor;
 
+    #if fast_math_on
+    // clamp fra minima e massima velocità con la norma inversa approssimata (common/fast_math.h)
+    clamp_speed_fast(boid->vx, boid->vy, min_speed, max_speed);
+    #else
     //# Calculate the boid's speed
     //# Slow step! Lookup the "alpha max plus beta min" algorithm
     // calcolo della norma della velocità e clamp fra minima e massima velocità
     float speed = sqrtf(boid->vx * boid->vx + boid->vy * boid->vy);
-    if (speed < min_speed) {
+    if (speed < min_speed && speed > 0.0f) {
         boid->vx = (boid->vx / speed) * min_speed;
         boid->vy = (boid->vy / speed) * min_speed;
     }
@@ -132,6 +209,7 @@ void update_boid_position(Boid* boid, const Boid* otherboids, const int num_boid
         boid->vx = (boid->vx / speed) * max_speed;
         boid->vy = (boid->vy / speed) * max_speed;
     }
+    #endif
 
     // aggiornamento finale della posizione
     boid->x += boid->vx * deltaTime;
@@ -6,7 +6,12 @@ typedef struct {
     float vx, vy;    // velocità
 } Boid;
 
-// funzione per aggiornare la posizione di tutti i boids
+struct AosWorkspace;
+
+// funzione per aggiornare la posizione di tutti i boids; griglia e liste dei vicini vengono da un AosWorkspace
+// (spatial_grid.h) del chiamante, riusato fra i time step
+void update_all_boids(const Boid* boids, Boid* new_boids, int num_boids, AosWorkspace& workspace, float deltaTime, int windowWidth, int windowHeight);
+// come sopra con un workspace locale (alloca griglia e liste a ogni chiamata)
 void update_all_boids(const Boid* boids, Boid* new_boids, int num_boids, float deltaTime, int windowWidth, int windowHeight);
 
 // funzione per aggiornare la posizione di un boid
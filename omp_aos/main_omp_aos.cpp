@@ -7,20 +7,37 @@
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <vector>
 
 #include <SFML/Graphics.hpp>
 #include <SFML/System.hpp>
 #include <SFML/Window.hpp>
 
+#include "../common/perf_counters.h"
+#include "../common/scaling_study.h"
+#include "../common/perf_gate.h"
+#include "../common/validation.h"
+#include "../common/fast_math.h"
+#include "../common/alloc_tracking.h"
+
 #include "boids_omp_aos.h"
+#include "spatial_grid.h"
 
 #define visuals_on true
 #define spatial_partitioning_on true
 
-#if spatial_partitioning_on
+#if spatial_partitioning_on && fast_math_on
+#define log_file_name "logfile_omp_aos_sp_fast.txt"
+#define scaling_engine_name "omp_aos_sp_fast"
+#elif spatial_partitioning_on
 #define log_file_name "logfile_omp_aos_sp.txt"
+#define scaling_engine_name "omp_aos_sp"
+#elif fast_math_on
+#define log_file_name "logfile_omp_aos_fast.txt"
+#define scaling_engine_name "omp_aos_fast"
 #else
 #define log_file_name "logfile_omp_aos.txt"
+#define scaling_engine_name "omp_aos"
 #endif
 
 int main(int argc, char* argv[])
@@ -56,6 +73,56 @@ int main(int argc, char* argv[])
 
     const int windowWidth = 1280;
     const int windowHeight = 720;
+
+    if (validation_requested(argc, argv)) {
+        // validazione incrociata: stessi stati iniziali e time step fisso del motore di riferimento (seq)
+        std::vector<Boid> current, updated;
+        AosWorkspace workspace;
+        return run_validation(scaling_engine_name, windowWidth, windowHeight, [&](const ValidationState& state, ValidationState& next, int, float deltaTime, int worldWidth, int worldHeight) {
+            const int agents = state.count();
+            current.resize(agents);
+            updated.resize(agents);
+            for (int i = 0; i < agents; ++i)
+                current[i] = Boid{state.x[i], state.y[i], state.vx[i], state.vy[i]};
+            update_all_boids(current.data(), updated.data(), agents, workspace, deltaTime, worldWidth, worldHeight);
+            for (int i = 0; i < agents; ++i) {
+                next.x[i] = updated[i].x;
+                next.y[i] = updated[i].y;
+                next.vx[i] = updated[i].vx;
+                next.vy[i] = updated[i].vy;
+            }
+        });
+    }
+    // studio di scalabilità o perf gate senza grafica e con time step fisso, al posto dei casi di test standard
+    auto runSimulation = [](int agents, int worldWidth, int worldHeight, int timeSteps, float deltaTime) {
+        Boid* boids = new Boid[agents];
+        Boid* new_boids = new Boid[agents];
+        for (int i = 0; i < agents; ++i) {
+            boids[i].x = rand() % worldWidth;
+            boids[i].y = rand() % worldHeight;
+            boids[i].vx = 0;
+            boids[i].vy = 0;
+        }
+
+        // griglia e liste dei vicini della simulazione, riusate fra i suoi time step
+        AosWorkspace workspace;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int step = 0; step < timeSteps; ++step)
+        {
+            update_all_boids(boids, new_boids, agents, workspace, deltaTime, worldWidth, worldHeight);
+            std::swap(boids, new_boids);
+        }
+        auto stop = std::chrono::high_resolution_clock::now();
+
+        delete[] boids;
+        delete[] new_boids;
+        return std::chrono::duration<double>(stop - start).count();
+    };
+    if (perf_gate_requested(argc, argv))
+        return run_perf_gate(scaling_engine_name, windowWidth, windowHeight, runSimulation);
+    #if scaling_study_on
+    return run_scaling_study(scaling_engine_name, windowWidth, windowHeight, runSimulation);
+    #endif
     #if visuals_on
     sf::RenderWindow window(sf::VideoMode(windowWidth, windowHeight), "Boids Simulation");
     #endif
@@ -72,6 +139,9 @@ int main(int argc, char* argv[])
                 window.setTitle("Boids Simulation (n. " + std::to_string(ri + 1) + ", " + std::to_string(numberOfAgents[ai]) + " agents, " + std::to_string(numberOfThreads[ti]) + " threads)");
                 #endif
 
+                // azzera i contatori delle allocazioni prima di allocare lo stato di questa run
+                alloc_run_begin();
+
                 // inizializzazione stato boids (posizione iniziale random e velocità nulla), i buffer rappresentano rispettivamente lo stato corrente e successivo
                 Boid* boids = new Boid[numberOfAgents[ai]];
                 Boid* new_boids = new Boid[numberOfAgents[ai]];
@@ -95,6 +165,12 @@ int main(int argc, char* argv[])
                 }
                 #endif
 
+                // azzera i contatori hardware per questa run
+                perf_reset();
+
+                // griglia e liste dei vicini di questa run, riusate fra i suoi time step
+                AosWorkspace workspace;
+
                 // ciclo principale di esecuzione
                 float totalSimulationTime = 0.0f;
                 int elapsedTimeSteps = 0;
@@ -118,14 +194,18 @@ int main(int argc, char* argv[])
                     // clock SFML per smoothing della simulazione
                     sf::Time deltaTime = clock.restart();
 
+                    // allocazioni contate solo dentro l'aggiornamento dei boids
+                    alloc_step_begin();
+
                     // campiona il punto di inizio di questo time step con un clock ad alta risoluzione
                     auto start = std::chrono::high_resolution_clock::now();
 
                     // aggiorna tutti i boids per questo time step
-                    update_all_boids(boids, new_boids, numberOfAgents[ai], deltaTime.asSeconds() * speedUpSimulation, windowWidth, windowHeight);
+                    update_all_boids(boids, new_boids, numberOfAgents[ai], workspace, deltaTime.asSeconds() * speedUpSimulation, windowWidth, windowHeight);
 
                     // campiona il punto di fine di questo time step con un clock ad alta risoluzione
                     auto stop = std::chrono::high_resolution_clock::now();
+                    alloc_step_end();
 
                     // somma al tempo di esecuzione dell'algoritmo sugli altri boids
                     totalSimulationTime += std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count();
@@ -170,6 +250,21 @@ int main(int argc, char* argv[])
                 std::cout << "Simulazione terminata dopo " << elapsedTimeSteps << " time steps." << std::endl;
                 std::cout << "Tempo di esecuzione per simulazione boids: " << totalSimulationTime / 1000000 << " secondi." << std::endl;
                 simulationTimes[ti][ai][ri] = totalSimulationTime / 1000000;
+
+                #if perf_counters_on
+                // metriche hardware per fase accanto ai tempi
+                const long long boidSteps = static_cast<long long>(numberOfAgents[ai]) * elapsedTimeSteps;
+                perf_report(std::cout, boidSteps);
+                logFile << "Contatori per " << numberOfAgents[ai] << " boids con " << numberOfThreads[ti] << " threads (run " << (ri + 1) << "):" << std::endl;
+                perf_report(logFile, boidSteps);
+                #endif
+
+                #if alloc_tracking_on
+                // allocazioni per time step e memoria di picco di questa run
+                alloc_report(std::cout, numberOfAgents[ai]);
+                logFile << "Allocazioni per " << numberOfAgents[ai] << " boids con " << numberOfThreads[ti] << " threads (run " << (ri + 1) << "):" << std::endl;
+                alloc_report(logFile, numberOfAgents[ai]);
+                #endif
             }
         }
     }
@@ -28,8 +28,11 @@ public:
 
     SpatialGrid(float _cellSize) : cellSize(_cellSize) {}
 
+    // svuota le celle mantenendo chiavi e capacità dei vettori: una griglia riusata fra i time step smette di allocare
+    // quando tutte le celle occupate sono già state viste
     void clear() {
-        cells.clear();
+        for (auto& cell : cells)
+            cell.second.clear();
     }
 
     // calcola coordinate cella da posizione
@@ -45,6 +48,13 @@ public:
     // restituisce tutti i boid nella cella e nelle 8 celle adiacenti
     std::vector<Boid*> get_neighbors(Boid* boid) const {
         std::vector<Boid*> neighbors;
+        get_neighbors(boid, neighbors);
+        return neighbors;
+    }
+
+    // come sopra, riscrivendo un vettore del chiamante (nessuna allocazione se la capacità basta)
+    void get_neighbors(Boid* boid, std::vector<Boid*>& neighbors) const {
+        neighbors.clear();
         CellKey base = getCell(boid->x, boid->y);
         for (int dx = -1; dx <= 1; ++dx) {
             for (int dy = -1; dy <= 1; ++dy) {
@@ -55,6 +65,13 @@ public:
                 }
             }
         }
-        return neighbors;
     }
 };
+
+// strutture di appoggio di update_all_boids riusate fra i time step (nessuna allocazione a regime): appartengono al
+// chiamante, uno per simulazione e usato da una sola chiamata alla volta
+struct AosWorkspace {
+    SpatialGrid grid{0.0f}; // lato delle celle impostato da update_all_boids
+    std::vector<std::vector<Boid*>> threadNeighborPtrs; // liste dei vicini di ogni thread
+    std::vector<std::vector<Boid>> threadNeighbors;
+};
@@ -0,0 +1,163 @@
+#include <cmath>
+
+#ifdef _OPENMP
+#include <omp.h> // for OpenMP library functions
+#endif
+
+#include "boids_omp_aosoa.h"
+#include "spatial_grid.h"
+#include "../common/perf_counters.h"
+
+#define visual_range 40.0f
+#define visual_range_squared (visual_range * visual_range)
+#define protected_range 8.0f
+#define protected_range_squared (protected_range * protected_range)
+#define centering_factor 0.002f
+#define matching_factor 0.05f
+#define avoid_factor 0.025f
+#define turn_factor 0.4f
+#define min_speed 3.0f
+#define max_speed 6.0f
+
+// algoritmo riadattato da https://vanhunteradams.com/Pico/Animal_Movement/Boids-algorithm.html
+
+// motore con layout AoSoA: i boids ordinati per cella sono raggruppati in blocchi di aosoa_block_size, ogni blocco occupa
+// 2 cache line contigue, quindi i vicini di una riga dello stencil arrivano con pochi accessi sequenziali e ogni
+// componente di un blocco si carica con un solo load vettoriale
+
+// funzione per aggiornare le posizioni di tutti i boids
+void update_all_boids(const BoidsAoSoA& boids, BoidsAoSoA& new_boids, BlockSortedGrid& grid, float deltaTime, int windowWidth, int windowHeight)
+{
+    grid.resize(visual_range, windowWidth, windowHeight, boids.count);
+
+    #pragma omp parallel
+    {
+        perf_phase_begin(PHASE_GRID_BUILD);
+        grid.build(boids);
+        perf_phase_end(PHASE_GRID_BUILD);
+
+        perf_phase_begin(PHASE_UPDATE);
+        #if perf_counters_on
+        long long interactions = 0;
+        #endif
+        #pragma omp for schedule(static) nowait
+        for (int k = 0; k < boids.count; ++k) {
+            const int cx = grid.sortedCell[k] % grid.gridWidth;
+            const int cy = grid.sortedCell[k] / grid.gridWidth;
+            const BoidBlock& self = grid.blocks[k / aosoa_block_size];
+            const float bx = self.x[k % aosoa_block_size];
+            const float by = self.y[k % aosoa_block_size];
+
+            // inizializza le variabili necessarie
+            float xpos_avg = 0.0f, ypos_avg = 0.0f;
+            float xvel_avg = 0.0f, yvel_avg = 0.0f;
+            int neighboring_boids = 0;
+            float close_dx = 0.0f, close_dy = 0.0f;
+
+            // intervalli contigui delle 3 righe dello stencil 3x3 (celle fuori dalla griglia escluse)
+            const int firstX = cx > 0 ? cx - 1 : cx;
+            const int lastX = cx < grid.gridWidth - 1 ? cx + 1 : cx;
+            for (int ry = cy > 0 ? cy - 1 : cy; ry <= cy + 1 && ry < grid.gridHeight; ++ry) {
+                const int rowBegin = grid.cellStart[grid.cell_index(firstX, ry)];
+                const int rowEnd = grid.cellStart[grid.cell_index(lastX, ry) + 1];
+                #if perf_counters_on
+                interactions += rowEnd - rowBegin;
+                #endif
+                if (rowBegin == rowEnd)
+                    continue;
+                const int firstBlock = rowBegin / aosoa_block_size;
+                const int lastBlock = (rowEnd - 1) / aosoa_block_size;
+
+                // vettorizzazione sulle corsie: la corsia l del registro scorre la corsia l di tutti i blocchi della riga,
+                // quindi ogni componente di un blocco arriva con un load a piena larghezza e le somme restano per corsia
+                // fino alla riduzione; il boid stesso ha distanza nulla e contribuisce zero alla separazione
+                #pragma omp simd simdlen(aosoa_block_size) reduction(+:xpos_avg,ypos_avg,xvel_avg,yvel_avg,close_dx,close_dy,neighboring_boids)
+                for (int l = 0; l < aosoa_block_size; ++l) {
+                    for (int b = firstBlock; b <= lastBlock; ++b) {
+                        const BoidBlock& block = grid.blocks[b];
+
+                        // corsie fuori dall'intervallo della riga (blocchi di confine) mascherate
+                        const int j = b * aosoa_block_size + l;
+                        const bool inRow = (j >= rowBegin) & (j < rowEnd);
+
+                        // calcola la differenza di posizione con l'altro boid
+                        const float dx = bx - block.x[l];
+                        const float dy = by - block.y[l];
+                        const float squared_distance = dx * dx + dy * dy;
+
+                        // maschere al posto dei branch (protected range oppure visual range), combinate senza short-circuit
+                        const bool close = inRow & (squared_distance < protected_range_squared);
+                        const bool visible = inRow & !close & (squared_distance < visual_range_squared);
+
+                        close_dx += close ? dx : 0.0f;
+                        close_dy += close ? dy : 0.0f;
+                        xpos_avg += visible ? block.x[l] : 0.0f;
+                        ypos_avg += visible ? block.y[l] : 0.0f;
+                        xvel_avg += visible ? block.vx[l] : 0.0f;
+                        yvel_avg += visible ? block.vy[l] : 0.0f;
+                        neighboring_boids += visible ? 1 : 0;
+                    }
+                }
+            }
+
+            float vx = self.vx[k % aosoa_block_size];
+            float vy = self.vy[k % aosoa_block_size];
+
+            // se ci sono boids vicini, calcola il centro dello stormo
+            if (neighboring_boids > 0) {
+                xpos_avg /= static_cast<float>(neighboring_boids);
+                ypos_avg /= static_cast<float>(neighboring_boids);
+                xvel_avg /= static_cast<float>(neighboring_boids);
+                yvel_avg /= static_cast<float>(neighboring_boids);
+
+                // aggiusta la velocità del boid con il centering factor per avvicinarsi al centro dei vicini (cohesion rule)
+                vx += (xpos_avg - bx) * centering_factor;
+                vy += (ypos_avg - by) * centering_factor;
+
+                // aggiusta la velocità del boid con il matching factor per avvicinarsi alla velocità media dei vicini (alignment rule)
+                vx += (xvel_avg - vx) * matching_factor;
+                vy += (yvel_avg - vy) * matching_factor;
+            }
+
+            // aggiusta la velocità con il avoid factor per allontanarsi dai boids vicini (separation rule)
+            vx += close_dx * avoid_factor;
+            vy += close_dy * avoid_factor;
+
+            // gestione dei margini dello schermo
+            if (by < windowHeight * 0.05f) vy += turn_factor;
+            if (bx > windowWidth  * 0.95f) vx -= turn_factor;
+            if (bx < windowWidth  * 0.05f) vx += turn_factor;
+            if (by > windowHeight * 0.95f) vy -= turn_factor;
+
+            // calcolo della norma della velocità e clamp fra minima e massima velocità
+            float speed = sqrtf(vx * vx + vy * vy);
+            if (speed < min_speed && speed > 0.0f) {
+                vx = (vx / speed) * min_speed;
+                vy = (vy / speed) * min_speed;
+            }
+            if (speed > max_speed) {
+                vx = (vx / speed) * max_speed;
+                vy = (vy / speed) * max_speed;
+            }
+
+            // aggiornamento finale nel nuovo buffer, all'indice originale del boid
+            const int i = grid.id[k];
+            BoidBlock& out = new_boids.blocks[i / aosoa_block_size];
+            out.vx[i % aosoa_block_size] = vx;
+            out.vy[i % aosoa_block_size] = vy;
+            out.x[i % aosoa_block_size] = bx + vx * deltaTime;
+            out.y[i % aosoa_block_size] = by + vy * deltaTime;
+        }
+        #if perf_counters_on
+        perf_add_interactions(interactions);
+        #endif
+        perf_phase_end(PHASE_UPDATE);
+    }
+}
+
+// come sopra con una griglia locale: rientrante, ma alloca la griglia a ogni chiamata
+void update_all_boids(const BoidsAoSoA& boids, BoidsAoSoA& new_boids, float deltaTime, int windowWidth, int windowHeight)
+{
+    BlockSortedGrid grid;
+    update_all_boids(boids, new_boids, grid, deltaTime, windowWidth, windowHeight);
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+// numero di boids per blocco (larghezza SIMD: 8 float = un registro AVX)
+#define aosoa_block_size 8
+
+// blocco di boids in layout AoSoA: le 4 componenti di 8 boids consecutivi, 128 byte allineati alla cache line
+struct alignas(64) BoidBlock {
+    float x[aosoa_block_size];
+    float y[aosoa_block_size];
+    float vx[aosoa_block_size];
+    float vy[aosoa_block_size];
+};
+
+// struttura per rappresentare dei boids: il boid i sta nel blocco i / aosoa_block_size, corsia i % aosoa_block_size
+struct BoidsAoSoA {
+    BoidBlock* blocks;
+    int count;
+};
+
+// numero di blocchi necessari per count boids (l'ultimo può essere parziale)
+inline int aosoa_num_blocks(int count)
+{
+    return (count + aosoa_block_size - 1) / aosoa_block_size;
+}
+
+class BlockSortedGrid;
+
+// funzione per aggiornare la posizione di tutti i boids; grid (spatial_grid.h) appartiene al chiamante ed è riusata
+// fra i time step, quindi nessuna allocazione a regime
+void update_all_boids(const BoidsAoSoA& boids, BoidsAoSoA& new_boids, BlockSortedGrid& grid, float deltaTime, int windowWidth, int windowHeight);
+// come sopra con una griglia locale (alloca a ogni chiamata)
+void update_all_boids(const BoidsAoSoA& boids, BoidsAoSoA& new_boids, float deltaTime, int windowWidth, int windowHeight);
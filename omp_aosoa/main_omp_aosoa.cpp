@@ -0,0 +1,299 @@
+#ifdef _OPENMP
+#include <omp.h> // for OpenMP library functions
+#endif
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <SFML/Graphics.hpp>
+#include <SFML/System.hpp>
+#include <SFML/Window.hpp>
+
+#include "../common/perf_counters.h"
+#include "../common/scaling_study.h"
+#include "../common/perf_gate.h"
+#include "../common/validation.h"
+#include "../common/alloc_tracking.h"
+
+#include "boids_omp_aosoa.h"
+#include "spatial_grid.h"
+
+#define visuals_on true
+
+#define log_file_name "logfile_omp_aosoa.txt"
+#define scaling_engine_name "omp_aosoa"
+
+int main(int argc, char* argv[])
+{
+    // esegui il programma per un certo numero di threads
+    const int numberOfThreadsCases = 4;
+    const int numberOfThreads[numberOfThreadsCases] = {2, 4, 6, 8};
+    // esegui il programma per un numero diverso di agenti (boids)
+    const int numberOfAgentsCases = 6;
+    const int numberOfAgents[numberOfAgentsCases] = {100, 500, 1000, 2000, 5000, 10000};
+    // esegui il ogni caso di agents per tot volte
+    const int numberOfRuns = 10;
+    // fattore di velocità globale di simulazione
+    const float speedUpSimulation = 50;
+    // esegui il programma per un certo numero di time steps
+    const int maxTimeSteps = 1500;
+
+    // array per raccogliere i tempi di esecuzione
+    float simulationTimes[numberOfThreadsCases][numberOfAgentsCases][numberOfRuns];
+
+    // file di log per salvare i risultati
+    std::ofstream logFile(log_file_name);
+    if (!logFile.is_open())
+        std::cerr << "Error opening log file." << std::endl;
+
+    // check OpenMP
+    #ifdef _OPENMP
+    std::cout << "_OPENMP is defined." << std::endl;
+    std::cout << "Number of processors (Phys+HT): " << omp_get_num_procs() << std::endl;
+    #endif
+
+    const int windowWidth = 1280;
+    const int windowHeight = 720;
+
+    if (validation_requested(argc, argv)) {
+        // validazione incrociata: stessi stati iniziali e time step fisso del motore di riferimento (seq)
+        std::vector<BoidBlock> current, updated;
+        BlockSortedGrid grid;
+        return run_validation(scaling_engine_name, windowWidth, windowHeight, [&](const ValidationState& state, ValidationState& next, int, float deltaTime, int worldWidth, int worldHeight) {
+            const int agents = state.count();
+            current.assign(aosoa_num_blocks(agents), BoidBlock{});
+            updated.assign(aosoa_num_blocks(agents), BoidBlock{});
+            for (int i = 0; i < agents; ++i) {
+                BoidBlock& block = current[i / aosoa_block_size];
+                block.x[i % aosoa_block_size] = state.x[i];
+                block.y[i % aosoa_block_size] = state.y[i];
+                block.vx[i % aosoa_block_size] = state.vx[i];
+                block.vy[i % aosoa_block_size] = state.vy[i];
+            }
+            BoidsAoSoA boids = BoidsAoSoA{.blocks = current.data(), .count = agents};
+            BoidsAoSoA new_boids = BoidsAoSoA{.blocks = updated.data(), .count = agents};
+            update_all_boids(boids, new_boids, grid, deltaTime, worldWidth, worldHeight);
+            for (int i = 0; i < agents; ++i) {
+                const BoidBlock& block = updated[i / aosoa_block_size];
+                next.x[i] = block.x[i % aosoa_block_size];
+                next.y[i] = block.y[i % aosoa_block_size];
+                next.vx[i] = block.vx[i % aosoa_block_size];
+                next.vy[i] = block.vy[i % aosoa_block_size];
+            }
+        });
+    }
+    // studio di scalabilità o perf gate senza grafica e con time step fisso, al posto dei casi di test standard
+    auto runSimulation = [](int agents, int worldWidth, int worldHeight, int timeSteps, float deltaTime) {
+        BoidsAoSoA boids = BoidsAoSoA{
+            .blocks = new BoidBlock[aosoa_num_blocks(agents)](),
+            .count = agents,
+        };
+        BoidsAoSoA new_boids = BoidsAoSoA{
+            .blocks = new BoidBlock[aosoa_num_blocks(agents)](),
+            .count = agents,
+        };
+        for (int i = 0; i < agents; ++i)
+        {
+            BoidBlock& block = boids.blocks[i / aosoa_block_size];
+            block.x[i % aosoa_block_size] = rand() % worldWidth;
+            block.y[i % aosoa_block_size] = rand() % worldHeight;
+            block.vx[i % aosoa_block_size] = 0;
+            block.vy[i % aosoa_block_size] = 0;
+        }
+
+        // griglia della simulazione, riusata fra i suoi time step
+        BlockSortedGrid grid;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int step = 0; step < timeSteps; ++step)
+        {
+            update_all_boids(boids, new_boids, grid, deltaTime, worldWidth, worldHeight);
+            std::swap(boids, new_boids);
+        }
+        auto stop = std::chrono::high_resolution_clock::now();
+
+        delete[] boids.blocks;
+        delete[] new_boids.blocks;
+        return std::chrono::duration<double>(stop - start).count();
+    };
+    if (perf_gate_requested(argc, argv))
+        return run_perf_gate(scaling_engine_name, windowWidth, windowHeight, runSimulation);
+    #if scaling_study_on
+    return run_scaling_study(scaling_engine_name, windowWidth, windowHeight, runSimulation);
+    #endif
+    #if visuals_on
+    sf::RenderWindow window(sf::VideoMode(windowWidth, windowHeight), "Boids Simulation");
+    #endif
+
+    for (int ti = 0; ti < numberOfThreadsCases; ti++)
+    {
+        omp_set_num_threads(numberOfThreads[ti]);
+        for (int ai = 0; ai < numberOfAgentsCases; ai++)
+        {
+            for (int ri = 0; ri < numberOfRuns; ri++)
+            {
+                std::cout << "Inizio simulazione n. " << (ri + 1) << " su " << numberOfAgents[ai] << " boids con " << numberOfThreads[ti] << " threads." << std::endl;
+                #if visuals_on
+                window.setTitle("Boids Simulation (n. " + std::to_string(ri + 1) + ", " + std::to_string(numberOfAgents[ai]) + " agents, " + std::to_string(numberOfThreads[ti]) + " threads)");
+                #endif
+
+                // azzera i contatori delle allocazioni prima di allocare lo stato di questa run
+                alloc_run_begin();
+
+                // inizializzazione stato boids (posizione iniziale random e velocità nulla), i buffer rappresentano rispettivamente lo stato corrente e successivo
+                BoidsAoSoA boids = BoidsAoSoA{
+                    .blocks = new BoidBlock[aosoa_num_blocks(numberOfAgents[ai])](),
+                    .count = numberOfAgents[ai],
+                };
+                BoidsAoSoA new_boids = BoidsAoSoA{
+                    .blocks = new BoidBlock[aosoa_num_blocks(numberOfAgents[ai])](),
+                    .count = numberOfAgents[ai],
+                };
+                for (int i = 0; i < numberOfAgents[ai]; ++i)
+                {
+                    BoidBlock& block = boids.blocks[i / aosoa_block_size];
+                    block.x[i % aosoa_block_size] = rand() % windowWidth;
+                    block.y[i % aosoa_block_size] = rand() % windowHeight;
+                    block.vx[i % aosoa_block_size] = 0;
+                    block.vy[i % aosoa_block_size] = 0;
+                }
+
+                #if visuals_on
+                // inizializzazione grafica dei boids: ogni boid è un quadrato bianco (4 vertici)
+                sf::VertexArray* boidsQuads = new sf::VertexArray(sf::Quads, numberOfAgents[ai] * 4);
+                const int quadSize = 3;
+                for (int i = 0; i < numberOfAgents[ai]; ++i)
+                {
+                    sf::Color boidColor(255, 255, 255);
+                    for (int j = 0; j < 4; ++j) {
+                        (*boidsQuads)[i * 4 + j].color = boidColor;
+                    }
+                }
+                #endif
+
+                // azzera i contatori hardware per questa run
+                perf_reset();
+
+                // griglia di questa run, riusata fra i suoi time step
+                BlockSortedGrid grid;
+
+                // ciclo principale di esecuzione
+                float totalSimulationTime = 0.0f;
+                int elapsedTimeSteps = 0;
+                sf::Clock clock;
+                while
+                (
+                    elapsedTimeSteps < maxTimeSteps
+                    #if visuals_on
+                    && window.isOpen()
+                    #endif
+                )
+                {
+                    #if visuals_on
+                    sf::Event event;
+                    while (window.pollEvent(event))
+                    {
+                        if (event.type == sf::Event::Closed)
+                            window.close();
+                    }
+                    #endif
+                    // clock SFML per smoothing della simulazione
+                    sf::Time deltaTime = clock.restart();
+
+                    // allocazioni contate solo dentro l'aggiornamento dei boids
+                    alloc_step_begin();
+
+                    // campiona il punto di inizio di questo time step con un clock ad alta risoluzione
+                    auto start = std::chrono::high_resolution_clock::now();
+
+                    // aggiorna lo stato dei boids
+                    update_all_boids(boids, new_boids, grid, deltaTime.asSeconds() * speedUpSimulation, windowWidth, windowHeight);
+
+                    // campiona il punto di fine di questo time step con un clock ad alta risoluzione
+                    auto stop = std::chrono::high_resolution_clock::now();
+                    alloc_step_end();
+
+                    // somma al tempo di esecuzione dell'algoritmo sugli altri boids
+                    totalSimulationTime += std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count();
+
+                    #if visuals_on
+                    // aggiorna i 4 vertici dei quadrati (i boids)
+                    #pragma omp parallel for schedule(static)
+                    for (int i = 0; i < numberOfAgents[ai]; ++i)
+                    {
+                        float x = new_boids.blocks[i / aosoa_block_size].x[i % aosoa_block_size];
+                        float y = new_boids.blocks[i / aosoa_block_size].y[i % aosoa_block_size];
+
+                        (*boidsQuads)[i * 4].position = sf::Vector2f(x - quadSize * 0.5f, y - quadSize * 0.5f);
+                        (*boidsQuads)[i * 4 + 1].position = sf::Vector2f(x + quadSize * 0.5f, y - quadSize * 0.5f);
+                        (*boidsQuads)[i * 4 + 2].position = sf::Vector2f(x + quadSize * 0.5f, y + quadSize * 0.5f);
+                        (*boidsQuads)[i * 4 + 3].position = sf::Vector2f(x - quadSize * 0.5f, y + quadSize * 0.5f);
+                    }
+
+                    // disegno dei quads (boids) nella finestra SFML
+                    window.clear();
+                    window.draw(*boidsQuads);
+                    window.display();
+                    #endif
+
+                    // ricopio il nuovo buffer nel vecchio per il prossimo time step
+                    std::swap(boids, new_boids);
+
+                    // incremento time steps e stampa intervalli intermedi
+                    elapsedTimeSteps++;
+                    if (elapsedTimeSteps % 50 == 0)
+                        std::cout << "Time steps: " << elapsedTimeSteps << std::endl;
+                }
+
+                // dealloca gli array per evitare memory leaks
+                delete[] boids.blocks;
+                delete[] new_boids.blocks;
+                #if visuals_on
+                delete boidsQuads;
+                #endif
+
+                // stampa della misurazione ottenuta a schermo
+                std::cout << "Simulazione terminata dopo " << elapsedTimeSteps << " time steps." << std::endl;
+                std::cout << "Tempo di esecuzione per simulazione boids: " << totalSimulationTime / 1000000 << " secondi." << std::endl;
+                simulationTimes[ti][ai][ri] = totalSimulationTime / 1000000;
+
+                #if perf_counters_on
+                // metriche hardware per fase accanto ai tempi
+                const long long boidSteps = static_cast<long long>(numberOfAgents[ai]) * elapsedTimeSteps;
+                perf_report(std::cout, boidSteps);
+                logFile << "Contatori per " << numberOfAgents[ai] << " boids con " << numberOfThreads[ti] << " threads (run " << (ri + 1) << "):" << std::endl;
+                perf_report(logFile, boidSteps);
+                #endif
+
+                #if alloc_tracking_on
+                // allocazioni per time step e memoria di picco di questa run
+                alloc_report(std::cout, numberOfAgents[ai]);
+                logFile << "Allocazioni per " << numberOfAgents[ai] << " boids con " << numberOfThreads[ti] << " threads (run " << (ri + 1) << "):" << std::endl;
+                alloc_report(logFile, numberOfAgents[ai]);
+                #endif
+            }
+        }
+    }
+    #if visuals_on
+    // chiudi la finestra alla fine di tutte le simulazioni
+    window.close();
+    #endif
+
+    // calcolo tempo di esecuzione medio per ogni numero di threads e di agenti e stampa delle misurazioni ottenute a schermo e su file di log
+    for (int ti = 0; ti < numberOfThreadsCases; ti++)
+    {
+        for (int ai = 0; ai < numberOfAgentsCases; ai++)
+        {
+            float meanTime = 0.0f;
+            for (int ri = 0; ri < numberOfRuns; ri++)
+                meanTime += simulationTimes[ti][ai][ri];
+            meanTime /= numberOfRuns;
+            std::cout << "Tempo di esecuzione medio per " << numberOfAgents[ai] << " boids con " << numberOfThreads[ti] << " threads: " << meanTime << " secondi." << std::endl;
+            logFile << "Tempo di esecuzione medio per " << numberOfAgents[ai] << " boids con " << numberOfThreads[ti] << " threads: " << meanTime << " secondi." << std::endl;
+        }
+    }
+    logFile.close();
+}
\ No newline at end of file
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h> // for OpenMP library functions
+#endif
+
+#include "boids_omp_aosoa.h"
+
+// griglia uniforme con copia dei boids ordinata per cella in layout AoSoA: le 3 celle di una riga dello stencil 3x3
+// formano un unico intervallo contiguo, che il kernel scorre un blocco alla volta con load vettoriali a piena larghezza
+class BlockSortedGrid
+{
+public:
+    // copia ordinata per cella dello stato corrente
+    std::vector<BoidBlock> blocks;
+    // indice originale e cella di ogni boid ordinato
+    std::vector<int> id;
+    std::vector<int> sortedCell;
+    // inizio di ogni cella nella copia ordinata (numCells + 1 elementi)
+    std::vector<int> cellStart;
+
+    int gridWidth = 0;
+    int gridHeight = 0;
+
+    // adatta le dimensioni della griglia e dei buffer (nessuna allocazione se non cambiano)
+    void resize(float cellSize, int worldWidth, int worldHeight, int numBoids)
+    {
+        this->cellSize = cellSize;
+        gridWidth  = static_cast<int>(std::ceil(worldWidth  / cellSize));
+        gridHeight = static_cast<int>(std::ceil(worldHeight / cellSize));
+
+        cellStart.resize(gridWidth * gridHeight + 1);
+        cellOf.resize(numBoids);
+        id.resize(numBoids);
+        sortedCell.resize(numBoids);
+        blocks.resize(aosoa_num_blocks(numBoids));
+    }
+
+    // ordina i boids per cella (da chiamare dentro una regione parallela, usa worksharing orfano);
+    // i conteggi sono privati per thread e lo scatter usa la stessa suddivisione statica, quindi l'ordine è deterministico
+    void build(const BoidsAoSoA& boids)
+    {
+        const int numCells = gridWidth * gridHeight;
+        #ifdef _OPENMP
+        const int numThreads = omp_get_num_threads();
+        const int thread = omp_get_thread_num();
+        #else
+        const int numThreads = 1;
+        const int thread = 0;
+        #endif
+
+        #pragma omp single
+        threadCellCount.assign(numThreads * numCells, 0);
+
+        // conteggio
+        int* cellCount = &threadCellCount[thread * numCells];
+        #pragma omp for schedule(static)
+        for (int i = 0; i < boids.count; ++i) {
+            const BoidBlock& block = boids.blocks[i / aosoa_block_size];
+            cellOf[i] = world_to_cell(block.x[i % aosoa_block_size], block.y[i % aosoa_block_size]);
+            cellCount[cellOf[i]]++;
+        }
+
+        // prefix sum per (cella, thread): ogni thread riceve il proprio cursore di scrittura per cella
+        #pragma omp single
+        {
+            int offset = 0;
+            for (int c = 0; c < numCells; ++c) {
+                cellStart[c] = offset;
+                for (int t = 0; t < numThreads; ++t) {
+                    const int count = threadCellCount[t * numCells + c];
+                    threadCellCount[t * numCells + c] = offset;
+                    offset += count;
+                }
+            }
+            cellStart[numCells] = offset;
+        }
+
+        // scatter nella copia ordinata
+        #pragma omp for schedule(static)
+        for (int i = 0; i < boids.count; ++i) {
+            const int k = cellCount[cellOf[i]]++;
+            const BoidBlock& src = boids.blocks[i / aosoa_block_size];
+            BoidBlock& dst = blocks[k / aosoa_block_size];
+            const int lane = i % aosoa_block_size;
+            const int sortedLane = k % aosoa_block_size;
+            dst.x[sortedLane] = src.x[lane];
+            dst.y[sortedLane] = src.y[lane];
+            dst.vx[sortedLane] = src.vx[lane];
+            dst.vy[sortedLane] = src.vy[lane];
+            id[k] = i;
+            sortedCell[k] = cellOf[i];
+        }
+    }
+
+    // indice 1d della cella (cx, cy)
+    inline int cell_index(int cx, int cy) const
+    {
+        return cy * gridWidth + cx;
+    }
+
+private:
+    float cellSize = 1.0f;
+    std::vector<int> cellOf;
+    std::vector<int> threadCellCount;
+
+    // trasforma coordinate da world a grid 1d (i boids fuori dal mondo finiscono nelle celle di bordo)
+    inline int world_to_cell(float px, float py) const
+    {
+        int cx = static_cast<int>(std::floor(px / cellSize));
+        int cy = static_cast<int>(std::floor(py / cellSize));
+
+        cx = std::clamp(cx, 0, gridWidth  - 1);
+        cy = std::clamp(cy, 0, gridHeight - 1);
+
+        return cy * gridWidth + cx;
+    }
+};
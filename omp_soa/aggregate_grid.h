@@ -0,0 +1,110 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "spatial_grid.h"
+
+// griglia fine (sotto-celle di visual_range / aggregate_subdivisions) con aggregati per sotto-cella:
+// numero di boids, somme di posizioni e velocità e bounding box dei boids contenuti, calcolati durante la costruzione
+
+#define aggregate_subdivisions 4
+
+class AggregateGrid
+{
+public:
+    // dimensiona la griglia (nessuna allocazione se le dimensioni non cambiano)
+    void resize(float cellSize, int worldWidth, int worldHeight, int numBoids)
+    {
+        this->cellSize = cellSize;
+        gridWidth  = static_cast<int>(std::ceil(worldWidth  / cellSize));
+        gridHeight = static_cast<int>(std::ceil(worldHeight / cellSize));
+        numCells   = gridWidth * gridHeight;
+
+        cellOf.resize(numBoids);
+        boidIndices.resize(numBoids);
+        cellStart.resize(numCells + 1);
+        count.resize(numCells);
+        sumX.resize(numCells);
+        sumY.resize(numCells);
+        sumVx.resize(numCells);
+        sumVy.resize(numCells);
+        minX.resize(numCells);
+        maxX.resize(numCells);
+        minY.resize(numCells);
+        maxY.resize(numCells);
+    }
+
+    // svuota i contatori: come in SpatialGrid ogni thread ha una riga propria di contatori per sotto-cella
+    void clear(int numThreads = 1)
+    {
+        cellCount.assign(static_cast<size_t>(numThreads) * numCells, 0);
+    }
+
+    // sotto-cella del boid (prima fase), contata nella riga del thread
+    void insert(int boidIndex, float x, float y, int thread = 0)
+    {
+        const int cell = world_to_cell_y(y) * gridWidth + world_to_cell_x(x);
+        cellOf[boidIndex] = cell;
+        cellCount[thread * numCells + cell]++;
+    }
+
+    // prefix sum per (sotto-cella, thread): i contatori diventano i cursori di scrittura di ogni thread,
+    // count riceve il totale di ogni sotto-cella
+    void build(int numThreads = 1)
+    {
+        int offset = 0;
+        for (int c = 0; c < numCells; ++c) {
+            cellStart[c] = offset;
+            for (int t = 0; t < numThreads; ++t) {
+                const int n = cellCount[t * numCells + c];
+                cellCount[t * numCells + c] = offset;
+                offset += n;
+            }
+            count[c] = offset - cellStart[c];
+        }
+        cellStart[numCells] = offset;
+    }
+
+    // posiziona il boid (seconda fase) nell'intervallo riservato al thread
+    void insert_index(int boidIndex, int thread = 0)
+    {
+        boidIndices[cellCount[thread * numCells + cellOf[boidIndex]]++] = boidIndex;
+    }
+
+    // leggi il contenuto della sotto-cella
+    NeighborRange cell_content(int cell) const
+    {
+        return {
+            &boidIndices[cellStart[cell]],
+            &boidIndices[cellStart[cell + 1]]
+        };
+    }
+
+    // trasforma coordinate da world a grid (clamp sulle celle di bordo)
+    inline int world_to_cell_x(float x) const
+    {
+        return std::clamp(static_cast<int>(std::floor(x / cellSize)), 0, gridWidth - 1);
+    }
+
+    inline int world_to_cell_y(float y) const
+    {
+        return std::clamp(static_cast<int>(std::floor(y / cellSize)), 0, gridHeight - 1);
+    }
+
+    float cellSize = 0.0f;
+    int gridWidth = 0;
+    int gridHeight = 0;
+    int numCells = 0;
+
+    std::vector<int> cellOf;      // sotto-cella di ogni boid
+    std::vector<int> boidIndices; // indici dei boids ordinati per sotto-cella
+    std::vector<int> cellStart;   // intervallo [cellStart[c], cellStart[c + 1]) in boidIndices
+    std::vector<int> cellCount;   // (thread, sotto-cella) -> conteggio, poi cursore di scrittura
+
+    // aggregati per sotto-cella (SoA)
+    std::vector<int> count;
+    std::vector<float> sumX, sumY, sumVx, sumVy;
+    std::vector<float> minX, maxX, minY, maxY;
+};
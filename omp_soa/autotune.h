@@ -0,0 +1,304 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#ifdef _OPENMP
+#include <omp.h> // for OpenMP library functions
+#endif
+
+#include "boids_omp_soa.h"
+#include "soa_workspace.h"
+
+// auto-tuning a runtime: brevi finestre di calibrazione (time step reali della simulazione) su numero di thread, motore,
+// lato delle celle e schedule del ciclo delle interazioni; la configurazione più veloce viene salvata su file per
+// (macchina, fascia di N) e ricalibrata quando il tempo per time step si allontana troppo da quello misurato al tuning
+// (ad esempio quando lo stormo si raggruppa)
+
+#define autotune_window 8              // time step misurati per ogni candidato (più un time step di riscaldamento)
+#define autotune_drift_ratio 1.5f      // ricalibra se la mediana recente esce da [riferimento / ratio, riferimento * ratio]
+#define autotune_min_steps_between 200 // time step minimi fra due calibrazioni
+#define autotune_cache_file "autotune_cache.txt"
+
+// la configurazione di default corrisponde a update_all_boids (griglia con celle di visual_range, schedule statico)
+inline TuningConfig default_tuning_config(int threads)
+{
+    return TuningConfig{threads, TUNED_ENGINE_GRID, 1.0f, TUNED_SCHEDULE_STATIC, 0};
+}
+
+inline std::string describe_tuning_config(const TuningConfig& config)
+{
+    static const char* engines[] = {"grid", "quadtree", "tasks"};
+    static const char* schedules[] = {"static", "dynamic", "guided"};
+    std::ostringstream text;
+    text << config.threads << " threads, " << engines[config.engine];
+    if (config.engine == TUNED_ENGINE_GRID)
+        text << ", cell x" << config.cellFactor << ", " << schedules[config.schedule] << "," << config.chunk;
+    return text.str();
+}
+
+class AutoTuner
+{
+public:
+    int calibrations = 0;     // calibrazioni eseguite (la prima compresa)
+    int cacheHits = 0;        // configurazioni prese dal file senza calibrare
+    long long tuningSteps = 0; // time step eseguiti durante le calibrazioni
+
+    // maxThreads: limite superiore dei thread provati (0 = tutti i processori)
+    explicit AutoTuner(int maxThreads = 0, std::string cachePath = autotune_cache_file) : cachePath(std::move(cachePath))
+    {
+        #ifdef _OPENMP
+        this->maxThreads = maxThreads > 0 ? std::min(maxThreads, omp_get_num_procs()) : omp_get_num_procs();
+        #else
+        this->maxThreads = 1;
+        (void)maxThreads;
+        #endif
+        current = best = default_tuning_config(this->maxThreads);
+        load_cache();
+    }
+
+    const TuningConfig& config() const
+    {
+        return current;
+    }
+
+    // esegue un time step: con la configurazione corrente, oppure con il candidato in prova durante una calibrazione
+    void step(const Boids& boids, Boids& new_boids, float deltaTime, int windowWidth, int windowHeight)
+    {
+        // nuova fascia di N: configurazione dal file se presente, altrimenti calibrazione
+        const int bucket = n_bucket(boids.count);
+        if (bucket != currentBucket) {
+            currentBucket = bucket;
+            const auto cached = cache.find(cache_key());
+            if (cached != cache.end()) {
+                current = best = cached->second.config;
+                referenceSeconds = cached->second.seconds;
+                cacheHits++;
+                recent.clear();
+                stepsSinceTuning = 0;
+                calibrating = false;
+            } else {
+                start_calibration();
+            }
+        }
+
+        const TuningConfig& config = calibrating ? candidates[candidate] : current;
+        const auto start = std::chrono::steady_clock::now();
+        update_all_boids_configured(boids, new_boids, workspace, config, deltaTime, windowWidth, windowHeight);
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        if (calibrating)
+            record_calibration(seconds);
+        else
+            monitor_drift(seconds);
+    }
+
+private:
+    struct CacheEntry {
+        TuningConfig config;
+        double seconds;
+    };
+
+    std::string cachePath;
+    std::map<std::string, CacheEntry> cache;
+    SoaWorkspace workspace; // strutture dei motori candidati, riusate fra i time step dello stormo
+    int maxThreads = 1;
+    int currentBucket = -1;
+
+    TuningConfig current, best;
+    double referenceSeconds = 0.0; // mediana della configurazione scelta al momento del tuning
+    std::vector<double> recent;    // ultimi autotune_window tempi fuori calibrazione
+    long long stepsSinceTuning = 0;
+
+    // calibrazione a coordinate: una dimensione alla volta, le altre fissate al migliore trovato finora
+    bool calibrating = false;
+    int stage = 0;
+    std::vector<TuningConfig> candidates;
+    size_t candidate = 0;
+    std::vector<double> samples;
+    double bestSeconds = 0.0;
+
+    // fascia di N: potenze di 2 (N fra 2^k e 2^(k+1) - 1 condividono la configurazione)
+    static int n_bucket(int count)
+    {
+        int bucket = 0;
+        while ((count >> (bucket + 1)) > 0)
+            bucket++;
+        return bucket;
+    }
+
+    // macchina: host, modello della CPU, processori e limite dei thread
+    std::string cache_key() const
+    {
+        char host[256] = {};
+        gethostname(host, sizeof(host) - 1);
+        std::string cpu = "unknown";
+        std::ifstream cpuinfo("/proc/cpuinfo");
+        for (std::string line; std::getline(cpuinfo, line);) {
+            if (line.rfind("model name", 0) == 0) {
+                cpu = line.substr(line.find(':') + 2);
+                break;
+            }
+        }
+        std::replace(cpu.begin(), cpu.end(), ' ', '_');
+        #ifdef _OPENMP
+        const int procs = omp_get_num_procs();
+        #else
+        const int procs = 1;
+        #endif
+        return std::string(host) + "/" + cpu + "/procs=" + std::to_string(procs) + "/threads=" + std::to_string(maxThreads)
+            + "/n=2^" + std::to_string(currentBucket);
+    }
+
+    void load_cache()
+    {
+        // una riga per chiave: chiave threads engine cellFactor schedule chunk secondi
+        std::ifstream file(cachePath);
+        std::string key;
+        int engine, schedule;
+        CacheEntry entry;
+        while (file >> key >> entry.config.threads >> engine >> entry.config.cellFactor >> schedule >> entry.config.chunk >> entry.seconds) {
+            entry.config.engine = static_cast<TunedEngine>(engine);
+            entry.config.schedule = static_cast<TunedSchedule>(schedule);
+            cache[key] = entry;
+        }
+    }
+
+    void save_cache() const
+    {
+        std::ofstream file(cachePath);
+        if (!file.is_open()) {
+            std::cerr << "Error writing autotune cache " << cachePath << "." << std::endl;
+            return;
+        }
+        for (const auto& [key, entry] : cache)
+            file << key << ' ' << entry.config.threads << ' ' << entry.config.engine << ' ' << entry.config.cellFactor << ' '
+                 << entry.config.schedule << ' ' << entry.config.chunk << ' ' << entry.seconds << '\n';
+    }
+
+    void start_calibration()
+    {
+        calibrating = true;
+        calibrations++;
+        stage = 0;
+        best = default_tuning_config(maxThreads);
+        build_stage();
+    }
+
+    // candidati della dimensione stage a partire dal migliore corrente
+    void build_stage()
+    {
+        candidates.clear();
+        candidate = 0;
+        samples.clear();
+
+        TuningConfig config = best;
+        if (stage == 0) {
+            // thread: potenze di 2 fino al massimo, più il massimo stesso
+            for (int threads = 1; threads < maxThreads; threads *= 2) {
+                config.threads = threads;
+                candidates.push_back(config);
+            }
+            config.threads = maxThreads;
+            candidates.push_back(config);
+        } else if (stage == 1) {
+            for (const TunedEngine engine : {TUNED_ENGINE_GRID, TUNED_ENGINE_QUADTREE, TUNED_ENGINE_TASKS}) {
+                config.engine = engine;
+                candidates.push_back(config);
+            }
+        } else if (stage == 2 && best.engine == TUNED_ENGINE_GRID) {
+            // celle più grandi di visual_range: meno celle da visitare, più candidati da scartare
+            for (const float factor : {1.0f, 1.5f, 2.0f}) {
+                config.cellFactor = factor;
+                candidates.push_back(config);
+            }
+        } else if (stage == 3 && best.engine == TUNED_ENGINE_GRID && best.threads > 1) {
+            const TunedSchedule schedules[] = {TUNED_SCHEDULE_STATIC, TUNED_SCHEDULE_DYNAMIC, TUNED_SCHEDULE_DYNAMIC, TUNED_SCHEDULE_GUIDED};
+            const int chunks[] = {0, 32, 256, 0};
+            for (int k = 0; k < 4; ++k) {
+                config.schedule = schedules[k];
+                config.chunk = chunks[k];
+                candidates.push_back(config);
+            }
+        }
+
+        // ogni stadio contiene anche il migliore corrente, rimisurato: il confronto avviene solo fra misure dello stesso
+        // stadio, vicine nel tempo (lo stato della simulazione evolve durante la calibrazione)
+        if (!candidates.empty())
+            bestSeconds = 0.0;
+
+        // dimensione non applicabile alla configurazione migliore: passa alla successiva
+        if (candidates.empty()) {
+            if (stage < 3) {
+                stage++;
+                build_stage();
+            } else {
+                finish_calibration();
+            }
+        }
+    }
+
+    void record_calibration(double seconds)
+    {
+        tuningSteps++;
+        samples.push_back(seconds);
+        if (static_cast<int>(samples.size()) < autotune_window + 1)
+            return;
+
+        // mediana senza il time step di riscaldamento
+        std::vector<double> measured(samples.begin() + 1, samples.end());
+        std::nth_element(measured.begin(), measured.begin() + measured.size() / 2, measured.end());
+        const double median = measured[measured.size() / 2];
+        if (bestSeconds == 0.0 || median < bestSeconds) {
+            bestSeconds = median;
+            best = candidates[candidate];
+        }
+
+        samples.clear();
+        if (++candidate < candidates.size())
+            return;
+        if (stage < 3) {
+            stage++;
+            build_stage();
+        } else {
+            finish_calibration();
+        }
+    }
+
+    void finish_calibration()
+    {
+        calibrating = false;
+        current = best;
+        referenceSeconds = bestSeconds;
+        recent.clear();
+        stepsSinceTuning = 0;
+        cache[cache_key()] = CacheEntry{best, bestSeconds};
+        save_cache();
+    }
+
+    // ricalibra quando la mediana degli ultimi time step si allontana dal riferimento
+    void monitor_drift(double seconds)
+    {
+        stepsSinceTuning++;
+        recent.push_back(seconds);
+        if (static_cast<int>(recent.size()) > autotune_window)
+            recent.erase(recent.begin());
+        if (static_cast<int>(recent.size()) < autotune_window || stepsSinceTuning < autotune_min_steps_between || referenceSeconds <= 0.0)
+            return;
+
+        std::vector<double> sorted(recent);
+        std::nth_element(sorted.begin(), sorted.begin() + sorted.size() / 2, sorted.end());
+        const double median = sorted[sorted.size() / 2];
+        if (median > referenceSeconds * autotune_drift_ratio || median < referenceSeconds / autotune_drift_ratio)
+            start_calibration();
+    }
+};
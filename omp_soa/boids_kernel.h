@@ -0,0 +1,167 @@
+#pragma once
+
+#include <cmath>
+
+#include "boids_omp_soa.h"
+
+// parametri e regole del modello condivisi dai motori SoA
+
+#define visual_range 40.0f
+#define visual_range_squared (visual_range * visual_range)
+#define protected_range 8.0f
+#define protected_range_squared (protected_range * protected_range)
+#define centering_factor 0.002f
+#define matching_factor 0.05f
+#define avoid_factor 0.025f
+#define turn_factor 0.4f
+#define min_speed 3.0f
+#define max_speed 6.0f
+
+// algoritmo riadattato da https://vanhunteradams.com/Pico/Animal_Movement/Boids-algorithm.html
+
+// somme sui vicini di un boid
+struct NeighborSums {
+    float xpos_avg = 0.0f, ypos_avg = 0.0f;
+    float xvel_avg = 0.0f, yvel_avg = 0.0f;
+    int neighboring_boids = 0;
+    float close_dx = 0.0f, close_dy = 0.0f;
+};
+
+// accumula i contributi al boid i dei boids con indici in [begin, end)
+inline void accumulate_neighbors(const Boids& boids, int i, const int* begin, const int* end, NeighborSums& sums)
+{
+    for (const int* it = begin; it != end; ++it)
+    {
+        int j = *it;
+        if (j == i)
+            continue;
+
+        // calcola la differenza di posizione con l'altro boid
+        float dxw = boids.x[i] - boids.x[j];
+        float dyw = boids.y[i] - boids.y[j];
+
+        // le due differenze sono minori del visual range?
+        if (std::fabs(dxw) < visual_range && std::fabs(dyw) < visual_range) {
+            const float squared_distance = dxw * dxw + dyw * dyw;
+
+            // il quadrato della distanza è minore del quadrato del protected range?
+            if (squared_distance < protected_range_squared) {
+                sums.close_dx += dxw;
+                sums.close_dy += dyw;
+            } else if (squared_distance < visual_range_squared) { // il quadrato della distanza è minore del quadrato del visual range?
+                // aggiungi i contributi per calcolare il centro dello stormo
+                sums.xpos_avg += boids.x[j];
+                sums.ypos_avg += boids.y[j];
+                sums.xvel_avg += boids.vx[j];
+                sums.yvel_avg += boids.vy[j];
+                sums.neighboring_boids++;
+            }
+        }
+    }
+}
+
+// come accumulate_neighbors, con un solo test sul quadrato della distanza e i contributi scelti con select invece che con
+// rami, così il ciclo è vettorizzabile (kernel veloce); il boid i ha distanza nulla e contribuisce solo con differenze nulle
+inline void accumulate_neighbors_fast(const Boids& boids, int i, const int* begin, const int* end, NeighborSums& sums)
+{
+    const float px = boids.x[i];
+    const float py = boids.y[i];
+    float xpos_avg = 0.0f, ypos_avg = 0.0f;
+    float xvel_avg = 0.0f, yvel_avg = 0.0f;
+    int neighboring_boids = 0;
+    float close_dx = 0.0f, close_dy = 0.0f;
+
+    const int candidates = static_cast<int>(end - begin);
+    #pragma omp simd reduction(+:xpos_avg,ypos_avg,xvel_avg,yvel_avg,neighboring_boids,close_dx,close_dy)
+    for (int k = 0; k < candidates; ++k) {
+        const int j = begin[k];
+        const float dxw = px - boids.x[j];
+        const float dyw = py - boids.y[j];
+        const float squared_distance = dxw * dxw + dyw * dyw;
+        const bool close = squared_distance < protected_range_squared;
+        const bool visible = !close && squared_distance < visual_range_squared;
+
+        close_dx += close ? dxw : 0.0f;
+        close_dy += close ? dyw : 0.0f;
+        xpos_avg += visible ? boids.x[j] : 0.0f;
+        ypos_avg += visible ? boids.y[j] : 0.0f;
+        xvel_avg += visible ? boids.vx[j] : 0.0f;
+        yvel_avg += visible ? boids.vy[j] : 0.0f;
+        neighboring_boids += visible;
+    }
+
+    sums.xpos_avg += xpos_avg;
+    sums.ypos_avg += ypos_avg;
+    sums.xvel_avg += xvel_avg;
+    sums.yvel_avg += yvel_avg;
+    sums.neighboring_boids += neighboring_boids;
+    sums.close_dx += close_dx;
+    sums.close_dy += close_dy;
+}
+
+// applica coesione, allineamento, separazione e margini dello schermo alla velocità (vx, vy) del boid i, senza clamp
+inline void steer_velocity(const Boids& boids, int i, NeighborSums sums, int windowWidth, int windowHeight, float& vx, float& vy)
+{
+    const float px = boids.x[i];
+    const float py = boids.y[i];
+
+    // se ci sono boids vicini, calcola il centro dello stormo
+    if (sums.neighboring_boids > 0) {
+        sums.xpos_avg /= static_cast<float>(sums.neighboring_boids);
+        sums.ypos_avg /= static_cast<float>(sums.neighboring_boids);
+        sums.xvel_avg /= static_cast<float>(sums.neighboring_boids);
+        sums.yvel_avg /= static_cast<float>(sums.neighboring_boids);
+
+        // aggiusta la velocità del boid con il centering factor per avvicinarsi al centro dei vicini (cohesion rule)
+        vx += (sums.xpos_avg - px) * centering_factor;
+        vy += (sums.ypos_avg - py) * centering_factor;
+
+        // aggiusta la velocità del boid con il matching factor per avvicinarsi alla velocità media dei vicini (alignment rule)
+        vx += (sums.xvel_avg - vx) * matching_factor;
+        vy += (sums.yvel_avg - vy) * matching_factor;
+    }
+
+    // aggiusta la velocità con il avoid factor per allontanarsi dai boids vicini (separation rule)
+    vx += sums.close_dx * avoid_factor;
+    vy += sums.close_dy * avoid_factor;
+
+    // gestione dei margini dello schermo
+    if (py < windowHeight * 0.05f) vy += turn_factor;
+    if (px > windowWidth  * 0.95f) vx -= turn_factor;
+    if (px < windowWidth  * 0.05f) vx += turn_factor;
+    if (py > windowHeight * 0.95f) vy -= turn_factor;
+}
+
+// applica le regole al boid i (stato letto da boids) e scrive il nuovo stato in new_boids (double buffering);
+// extraVx / extraVy sono contributi esterni alla velocità applicati prima del clamp (ostacoli e predatori)
+inline void steer_and_integrate(const Boids& boids, Boids& new_boids, int i, NeighborSums sums, float deltaTime, int windowWidth, int windowHeight,
+                                float extraVx = 0.0f, float extraVy = 0.0f)
+{
+    const float px = boids.x[i];
+    const float py = boids.y[i];
+    float vx = boids.vx[i];
+    float vy = boids.vy[i];
+    steer_velocity(boids, i, sums, windowWidth, windowHeight, vx, vy);
+
+    vx += extraVx;
+    vy += extraVy;
+
+    //# Calculate the boid's speed
+    //# Slow step! Lookup the "alpha max plus beta min" algorithm
+    // calcolo della norma della velocità e clamp fra minima e massima velocità (a velocità nulla la direzione non è definita)
+    float speed = sqrtf(vx * vx + vy * vy);
+    if (speed < min_speed && speed > 0.0f) {
+        vx = (vx / speed) * min_speed;
+        vy = (vy / speed) * min_speed;
+    }
+    if (speed > max_speed) {
+        vx = (vx / speed) * max_speed;
+        vy = (vy / speed) * max_speed;
+    }
+
+    // aggiornamento finale della posizione (e della velocità)
+    new_boids.x[i] = px + vx * deltaTime;
+    new_boids.y[i] = py + vy * deltaTime;
+    new_boids.vx[i] = vx;
+    new_boids.vy[i] = vy;
+}
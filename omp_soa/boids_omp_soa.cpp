@@ -5,176 +5,187 @@
 #endif
 
 #include "boids_omp_soa.h"
+#include "boids_kernel.h"
 #include "spatial_grid.h"
-
-#define visual_range 40.0f
-#define visual_range_squared (visual_range * visual_range)
-#define protected_range 8.0f
-#define protected_range_squared (protected_range * protected_range)
-#define centering_factor 0.002f
-#define matching_factor 0.05f
-#define avoid_factor 0.025f
-#define turn_factor 0.4f
-#define min_speed 3.0f
-#define max_speed 6.0f
+#include "quadtree.h"
+#include "soa_workspace.h"
+#include "../common/perf_counters.h"
 
 #define spatial_partitioning_on true
 
-// algoritmo riadattato da https://vanhunteradams.com/Pico/Animal_Movement/Boids-algorithm.html
-
-// funzione per aggiornare le posizioni di tutti i boids
-void update_all_boids(const Boids& boids, Boids& new_boids, float deltaTime, int windowWidth, int windowHeight)
+// funzione per costruire la griglia a partire dalle posizioni correnti (da chiamare dentro una regione parallela)
+void build_grid(const Boids& boids, SpatialGrid& grid)
 {
-    #if spatial_partitioning_on
-    // inizializzazione grid
-    SpatialGrid grid(visual_range, windowWidth, windowHeight, boids.count);
-    grid.clear();
+    #ifdef _OPENMP
+    const int numThreads = omp_get_num_threads();
+    const int thread = omp_get_thread_num();
+    #else
+    const int numThreads = 1;
+    const int thread = 0;
+    #endif
+
+    // contatori privati per thread (la barriera implicita del single li rende visibili a tutti prima del conteggio)
+    #pragma omp single
+    grid.clear(numThreads);
 
     // fase 1: conteggio
-    #pragma omp parallel for schedule(static)
+    perf_phase_begin(PHASE_GRID_COUNT);
+    #pragma omp for schedule(static) nowait
     for (int i = 0; i < boids.count; ++i) {
-        grid.insert(boids.x[i], boids.y[i]);
+        grid.insert(boids.x[i], boids.y[i], thread);
     }
+    perf_phase_end(PHASE_GRID_COUNT);
+    #pragma omp barrier
 
     // Prefix sum (seriale, costo trascurabile)
-    grid.build();
+    #pragma omp single
+    {
+        perf_phase_begin(PHASE_GRID_BUILD);
+        grid.build(numThreads);
+        perf_phase_end(PHASE_GRID_BUILD);
+    }
 
-    // fase 2: riempimento
-    #pragma omp parallel for schedule(static)
+    // fase 2: riempimento (stessa partizione statica della fase 1: ogni thread scrive solo nei propri intervalli)
+    perf_phase_begin(PHASE_GRID_FILL);
+    #pragma omp for schedule(static) nowait
     for (int i = 0; i < boids.count; ++i) {
-        grid.insert_index(i, boids.x[i], boids.y[i]);
+        grid.insert_index(i, boids.x[i], boids.y[i], thread);
     }
-    #endif
+    perf_phase_end(PHASE_GRID_FILL);
+    #pragma omp barrier
+}
 
-    #pragma omp parallel for schedule(static)
-    for (int i = 0; i < boids.count; ++i) {
+// costruisce il quadtree a partire dalle posizioni correnti (da chiamare dentro una regione parallela)
+void build_quadtree(const Boids& boids, LinearQuadtree& tree)
+{
+    perf_phase_begin(PHASE_GRID_BUILD);
+    tree.build(boids.x, boids.y);
+    perf_phase_end(PHASE_GRID_BUILD);
+}
 
-        // copia stato (double buffering)
-        new_boids.x[i] = boids.x[i];
-        new_boids.y[i] = boids.y[i];
-        new_boids.vx[i] = boids.vx[i];
-        new_boids.vy[i] = boids.vy[i];
+// interazioni e integrazione con un indice spaziale qualsiasi (index == nullptr: confronto con tutti i boids);
+// l'indice deve offrire query(x, y, visit), che chiama visit(NeighborRange) per ogni gruppo di candidati
+template <typename SpatialIndex>
+static void interact_with_index(const Boids& boids, Boids& new_boids, const SpatialIndex* index, float deltaTime, int windowWidth, int windowHeight)
+{
+    perf_phase_begin(PHASE_UPDATE);
+    #if perf_counters_on
+    long long interactions = 0;
+    #endif
+    #pragma omp for schedule(static) nowait
+    for (int i = 0; i < boids.count; ++i) {
 
         // inizializza le variabili necessarie
-        float xpos_avg = 0.0f, ypos_avg = 0.0f;
-        float xvel_avg = 0.0f, yvel_avg = 0.0f;
-        int neighboring_boids = 0;
-        float close_dx = 0.0f, close_dy = 0.0f;
-
-        #if spatial_partitioning_on
-        // visita cella + 8 adiacenti (in world space)
-        for (int dy = -1; dy <= 1; ++dy) {
-            for (int dx = -1; dx <= 1; ++dx) {
-
-                float sample_x = boids.x[i] + dx * visual_range;
-                float sample_y = boids.y[i] + dy * visual_range;
-
-                auto range = grid.cell_content_at(sample_x, sample_y);
-                for (const int* it = range.begin(); it != range.end(); ++it)
-                {
-                    int j = *it;
-                    if (j == i)
-                        continue;
-
-                    // calcola la differenza di posizione con l'altro boid
-                    float dxw = boids.x[i] - boids.x[j];
-                    float dyw = boids.y[i] - boids.y[j];
-
-                    // le due differenze sono minori del visual range?
-                    if (std::fabs(dxw) < visual_range && std::fabs(dyw) < visual_range) {
-                        const float squared_distance = dxw * dxw + dyw * dyw;
-
-                        // il quadrato della distanza è minore del quadrato del protected range?
-                        if (squared_distance < protected_range_squared) {
-                            close_dx += dxw;
-                            close_dy += dyw;
-                        } else if (squared_distance < visual_range_squared) { // il quadrato della distanza è minore del quadrato del visual range?
-                            // aggiungi i contributi per calcolare il centro dello stormo
-                            xpos_avg += boids.x[j];
-                            ypos_avg += boids.y[j];
-                            xvel_avg += boids.vx[j];
-                            yvel_avg += boids.vy[j];
-                            neighboring_boids++;
-                        }
+        NeighborSums sums;
+
+        if (index != nullptr) {
+            // visita i gruppi di candidati restituiti dall'indice
+            index->query(boids.x[i], boids.y[i], [&](NeighborRange range) {
+                #if perf_counters_on
+                interactions += range.end() - range.begin();
+                #endif
+                accumulate_neighbors(boids, i, range.begin(), range.end(), sums);
+            });
+        } else {
+            #if perf_counters_on
+            interactions += boids.count;
+            #endif
+            float xpos_avg = 0.0f, ypos_avg = 0.0f;
+            float xvel_avg = 0.0f, yvel_avg = 0.0f;
+            int neighboring_boids = 0;
+            float close_dx = 0.0f, close_dy = 0.0f;
+
+            // itera su tutti gli altri boids dello stormo
+            #pragma omp simd reduction(+:xpos_avg,ypos_avg,xvel_avg,yvel_avg,close_dx,close_dy,neighboring_boids)
+            for (int j = 0; j < boids.count; ++j) {
+
+                // calcola la differenza di posizione con l'altro boid
+                float dx = boids.x[i] - boids.x[j];
+                float dy = boids.y[i] - boids.y[j];
+
+                // le due differenze sono minori del visual range?
+                if (std::fabs(dx) < visual_range && std::fabs(dy) < visual_range) {
+                    const float squared_distance = dx * dx + dy * dy;
+
+                    // il quadrato della distanza è minore del quadrato del protected range?
+                    if (squared_distance < protected_range_squared) {
+                        close_dx += dx;
+                        close_dy += dy;
+                    } else if (squared_distance < visual_range_squared) { // il quadrato della distanza è minore del quadrato del visual range?
+                        // aggiungi i contributi per calcolare il centro dello stormo
+                        xpos_avg += boids.x[j];
+                        ypos_avg += boids.y[j];
+                        xvel_avg += boids.vx[j];
+                        yvel_avg += boids.vy[j];
+                        neighboring_boids++;
                     }
                 }
             }
+            sums = NeighborSums{xpos_avg, ypos_avg, xvel_avg, yvel_avg, neighboring_boids, close_dx, close_dy};
         }
-        #else
-        // itera su tutti gli altri boids dello stormo
-        #pragma omp simd reduction(+:xpos_avg,ypos_avg,xvel_avg,yvel_avg,close_dx,close_dy,neighboring_boids)
-        for (int j = 0; j < boids.count; ++j) {
-
-            // calcola la differenza di posizione con l'altro boid
-            float dx = boids.x[i] - boids.x[j];
-            float dy = boids.y[i] - boids.y[j];
-
-            // le due differenze sono minori del visual range?
-            if (std::fabs(dx) < visual_range && std::fabs(dy) < visual_range) {
-                const float squared_distance = dx * dx + dy * dy;
-
-                // il quadrato della distanza è minore del quadrato del protected range?
-                if (squared_distance < protected_range_squared) {
-                    close_dx += dx;
-                    close_dy += dy;
-                } else if (squared_distance < visual_range_squared) { // il quadrato della distanza è minore del quadrato del visual range?
-                    // aggiungi i contributi per calcolare il centro dello stormo
-                    xpos_avg += boids.x[j];
-                    ypos_avg += boids.y[j];
-                    xvel_avg += boids.vx[j];
-                    yvel_avg += boids.vy[j];
-                    neighboring_boids++;
-                }
-            }
-        }
-        #endif
 
-        float vx = new_boids.vx[i];
-        float vy = new_boids.vy[i];
+        // applica le regole e scrivi il nuovo stato (double buffering)
+        steer_and_integrate(boids, new_boids, i, sums, deltaTime, windowWidth, windowHeight);
+    }
+    #if perf_counters_on
+    perf_add_interactions(interactions);
+    #endif
+    perf_phase_end(PHASE_UPDATE);
+}
 
-        // se ci sono boids vicini, calcola il centro dello stormo
-        if (neighboring_boids > 0) {
-            xpos_avg /= static_cast<float>(neighboring_boids);
-            ypos_avg /= static_cast<float>(neighboring_boids);
-            xvel_avg /= static_cast<float>(neighboring_boids);
-            yvel_avg /= static_cast<float>(neighboring_boids);
+// funzione per calcolare le interazioni e integrare tutti i boids (da chiamare dentro una regione parallela)
+void interact_boids(const Boids& boids, Boids& new_boids, const SpatialGrid* grid, float deltaTime, int windowWidth, int windowHeight)
+{
+    interact_with_index(boids, new_boids, grid, deltaTime, windowWidth, windowHeight);
+}
 
-            // aggiusta la velocità del boid con il centering factor per avvicinarsi al centro dei vicini (cohesion rule)
-            vx += (xpos_avg - new_boids.x[i]) * centering_factor;
-            vy += (ypos_avg - new_boids.y[i]) * centering_factor;
+// come sopra, con i candidati presi dalle foglie del quadtree
+void interact_boids(const Boids& boids, Boids& new_boids, const LinearQuadtree& tree, float deltaTime, int windowWidth, int windowHeight)
+{
+    interact_with_index(boids, new_boids, &tree, deltaTime, windowWidth, windowHeight);
+}
 
-            // aggiusta la velocità del boid con il matching factor per avvicinarsi alla velocità media dei vicini (alignment rule)
-            vx += (xvel_avg - vx) * matching_factor;
-            vy += (yvel_avg - vy) * matching_factor;
+// funzione per aggiornare le posizioni di tutti i boids, con griglia e quadtree presi dal workspace del chiamante
+void update_all_boids(const Boids& boids, Boids& new_boids, SoaWorkspace& workspace, float deltaTime, int windowWidth, int windowHeight,
+                      SpatialIndexKind spatialIndex)
+{
+    #if spatial_partitioning_on
+    if (spatialIndex == SPATIAL_INDEX_QUADTREE) {
+        // il quadtree viene riusato fra i time step (nessuna allocazione a regime)
+        LinearQuadtree& tree = workspace.tree;
+        tree.resize(visual_range, windowWidth, windowHeight, boids.count);
+
+        #pragma omp parallel
+        {
+            build_quadtree(boids, tree);
+            interact_boids(boids, new_boids, tree, deltaTime, windowWidth, windowHeight);
         }
+        return;
+    }
 
-        // aggiusta la velocità con il avoid factor per allontanarsi dai boids vicini (separation rule)
-        vx += close_dx * avoid_factor;
-        vy += close_dy * avoid_factor;
-
-        // gestione dei margini dello schermo
-        if (new_boids.y[i] < windowHeight * 0.05f) vy += turn_factor;
-        if (new_boids.x[i] > windowWidth  * 0.95f) vx -= turn_factor;
-        if (new_boids.x[i] < windowWidth  * 0.05f) vx += turn_factor;
-        if (new_boids.y[i] > windowHeight * 0.95f) vy -= turn_factor;
-
-        //# Calculate the boid's speed
-        //# Slow step! Lookup the "alpha max plus beta min" algorithm
-        // calcolo della norma della velocità e clamp fra minima e massima velocità
-        float speed = sqrtf(vx * vx + vy * vy);
-        if (speed < min_speed) {
-            vx = (vx / speed) * min_speed;
-            vy = (vy / speed) * min_speed;
-        }
-        if (speed > max_speed) {
-            vx = (vx / speed) * max_speed;
-            vy = (vy / speed) * max_speed;
-        }
+    // griglia riusata fra i time step (nessuna allocazione a regime)
+    SpatialGrid& grid = workspace.grid;
+    grid.resize(visual_range, windowWidth, windowHeight, boids.count);
+    const SpatialGrid* gridPtr = &grid;
+    #else
+    (void)workspace;
+    (void)spatialIndex;
+    const SpatialGrid* gridPtr = nullptr;
+    #endif
 
-        // aggiornamento finale della posizione (e della velocità)
-        new_boids.vx[i] = vx;
-        new_boids.vy[i] = vy;
-        new_boids.x[i] += vx * deltaTime;
-        new_boids.y[i] += vy * deltaTime;
+    // unica regione parallela: le fasi sono separate da barriere esplicite (misurabili per thread con i contatori)
+    #pragma omp parallel
+    {
+        #if spatial_partitioning_on
+        build_grid(boids, grid);
+        #endif
+        interact_boids(boids, new_boids, gridPtr, deltaTime, windowWidth, windowHeight);
     }
 }
+
+// come sopra con un workspace locale: rientrante, ma alloca griglia e quadtree a ogni chiamata
+void update_all_boids(const Boids& boids, Boids& new_boids, float deltaTime, int windowWidth, int windowHeight, SpatialIndexKind spatialIndex)
+{
+    SoaWorkspace workspace;
+    update_all_boids(boids, new_boids, workspace, deltaTime, windowWidth, windowHeight, spatialIndex);
+}
\ No newline at end of file
@@ -9,5 +9,111 @@ struct Boids {
     int count;
 };
 
+// contatori della modalità approssimata (accumulati a ogni chiamata)
+struct ApproxStats {
+    long long aggregatedBoids = 0; // vicini contati tramite gli aggregati delle sotto-celle
+    long long exactCandidates = 0; // boids confrontati a coppie
+    float farTolerance = 0.0f;     // tolleranza usata nell'ultima chiamata (0 = esatta a meno dell'ordine delle somme)
+};
+
+// contatori della variante con ostacoli e predatori (accumulati a ogni chiamata)
+struct HazardStats {
+    long long obstacleChecks = 0; // capsule controllate dai boids (solo quelle della propria cella)
+    long long predatorChecks = 0; // predatori controllati dai boids (solo quelli delle 3x3 celle)
+};
+
+// indice spaziale usato da update_all_boids, selezionabile a runtime
+enum SpatialIndexKind {
+    SPATIAL_INDEX_GRID,    // griglia uniforme con celle di visual_range
+    SPATIAL_INDEX_QUADTREE // quadtree lineare con foglie di dimensione limitata (si adatta ai gruppi densi)
+};
+
+// configurazione di un time step scelta dall'auto-tuner (autotune.h)
+enum TunedEngine {
+    TUNED_ENGINE_GRID,     // griglia uniforme (update_all_boids), con lato delle celle e schedule configurabili
+    TUNED_ENGINE_QUADTREE, // update_all_boids con SPATIAL_INDEX_QUADTREE
+    TUNED_ENGINE_TASKS     // update_all_boids_tasks
+};
+
+enum TunedSchedule {
+    TUNED_SCHEDULE_STATIC,
+    TUNED_SCHEDULE_DYNAMIC,
+    TUNED_SCHEDULE_GUIDED
+};
+
+struct TuningConfig {
+    int threads;
+    TunedEngine engine;
+    float cellFactor;       // lato delle celle / visual_range (>= 1, solo griglia)
+    TunedSchedule schedule; // schedule del ciclo delle interazioni (solo griglia)
+    int chunk;              // chunk dello schedule (0 = default di OpenMP)
+};
+
+class SpatialGrid;
+class IncrementalGrid;
+class LinearQuadtree;
+struct SpeciesBlocks;
+class ObstacleGrid;
+struct FlockAnalytics;
+struct SoaWorkspace;
+
+// le varianti che riusano strutture fra i time step le prendono da un SoaWorkspace (soa_workspace.h) del chiamante:
+// nessuno stato globale, quindi simulazioni con workspace distinti possono girare in parallelo
+
 // funzione per aggiornare la posizione di tutti i boids
-void update_all_boids(const Boids& boids, Boids& new_boids, float deltaTime, int windowWidth, int windowHeight);
+void update_all_boids(const Boids& boids, Boids& new_boids, SoaWorkspace& workspace, float deltaTime, int windowWidth, int windowHeight,
+                      SpatialIndexKind spatialIndex = SPATIAL_INDEX_GRID);
+// come sopra con un workspace locale (rientrante, alloca griglia o quadtree a ogni chiamata)
+void update_all_boids(const Boids& boids, Boids& new_boids, float deltaTime, int windowWidth, int windowHeight, SpatialIndexKind spatialIndex = SPATIAL_INDEX_GRID);
+
+// variante a task con dipendenze sulle tile della griglia (stesso risultato, senza barriere globali fra griglia e interazioni);
+// le liste per tile restano nel workspace fra i time step, quindi un workspace per stormo
+void update_all_boids_tasks(const Boids& boids, Boids& new_boids, SoaWorkspace& workspace, float deltaTime, int windowWidth, int windowHeight);
+
+// variante con griglia incrementale: grid va mantenuta fra i time step dello stesso stormo (una nuova IncrementalGrid per ogni
+// simulazione), viene costruita alla prima chiamata e in seguito aggiornata spostando solo i boids che hanno cambiato cella
+void update_all_boids_incremental(const Boids& boids, Boids& new_boids, IncrementalGrid& grid, float deltaTime, int windowWidth, int windowHeight);
+
+// variante approssimata: coesione e allineamento usano gli aggregati delle sotto-celle interamente nel visual range;
+// farTolerance > 0 aggrega anche le sotto-celle che sporgono fino a farTolerance oltre il visual range (0 = esatta)
+void update_all_boids_approx(const Boids& boids, Boids& new_boids, SoaWorkspace& workspace, float deltaTime, int windowWidth, int windowHeight,
+                             ApproxStats* stats = nullptr, float farTolerance = 0.0f);
+
+// variante con più specie (species.h): lo stato è diviso in blocchi contigui per specie, bias / new_bias sono il bias
+// adattivo degli scout per boid (double buffering come le posizioni, inizialmente nullo)
+void update_all_boids_species(const Boids& boids, Boids& new_boids, SoaWorkspace& workspace, const SpeciesBlocks& blocks, const float* bias,
+                              float* new_bias, float deltaTime, int windowWidth, int windowHeight);
+
+// variante con mondo toroidale: posizioni periodiche, distanze con l'immagine più vicina e stencil che si richiude sui bordi
+// (nessun turn_factor: senza bordi la densità resta uniforme)
+void update_all_boids_toroidal(const Boids& boids, Boids& new_boids, SoaWorkspace& workspace, float deltaTime, int windowWidth, int windowHeight);
+
+// variante con ostacoli statici (obstacles.h, cotti una volta sola nella ObstacleGrid) e predatori: predators / new_predators
+// sono lo stato dei predatori con double buffering come quello dei boids, che fuggono dai predatori entro predator_range
+void update_all_boids_obstacles(const Boids& boids, Boids& new_boids, SoaWorkspace& workspace, const Boids& predators, Boids& new_predators,
+                                const ObstacleGrid& obstacles, float deltaTime, int windowWidth, int windowHeight, HazardStats* stats = nullptr);
+
+// variante con statistiche dello stormo (flock_analytics.h): stesso risultato di update_all_boids, ogni analytics.interval
+// time step riusa griglia e somme sui vicini per polarizzazione, vicini medi, gruppi e densità (riga CSV se analytics.csv)
+void update_all_boids_analytics(const Boids& boids, Boids& new_boids, SoaWorkspace& workspace, FlockAnalytics& analytics, float deltaTime,
+                                int windowWidth, int windowHeight);
+
+// variante con il kernel veloce (common/fast_math.h): test sulla distanza e contributi dei vicini senza rami, clamp della
+// velocità con la norma inversa approssimata in un ciclo vettorizzato; differisce da update_all_boids per l'ordine delle
+// somme e per l'errore relativo (< 0.4%) sulla norma della velocità limitata
+void update_all_boids_fast(const Boids& boids, Boids& new_boids, SoaWorkspace& workspace, float deltaTime, int windowWidth, int windowHeight);
+
+// time step con una configurazione esplicita (numero di thread, motore, celle, schedule), usata dall'auto-tuner;
+// default_tuning_config(threads) dà lo stesso risultato di update_all_boids
+void update_all_boids_configured(const Boids& boids, Boids& new_boids, SoaWorkspace& workspace, const TuningConfig& config, float deltaTime,
+                                 int windowWidth, int windowHeight);
+
+// singole fasi di update_all_boids, usano worksharing orfano: chiamate fuori da una regione parallela girano su un solo thread
+// costruisce la griglia dalle posizioni correnti (svuota da sé i contatori, uno per cella per ogni thread)
+void build_grid(const Boids& boids, SpatialGrid& grid);
+// calcola interazioni e integrazione di tutti i boids (grid == nullptr: confronto con tutti i boids)
+void interact_boids(const Boids& boids, Boids& new_boids, const SpatialGrid* grid, float deltaTime, int windowWidth, int windowHeight);
+// costruisce il quadtree dalle posizioni correnti (dimensionato prima con resize)
+void build_quadtree(const Boids& boids, LinearQuadtree& tree);
+// calcola interazioni e integrazione con i candidati presi dal quadtree
+void interact_boids(const Boids& boids, Boids& new_boids, const LinearQuadtree& tree, float deltaTime, int windowWidth, int windowHeight);
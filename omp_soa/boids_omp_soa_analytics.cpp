@@ -0,0 +1,187 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+
+#include "boids_omp_soa.h"
+#include "boids_kernel.h"
+#include "spatial_grid.h"
+#include "flock_analytics.h"
+#include "soa_workspace.h"
+#include "../common/perf_counters.h"
+
+// variante con statistiche dello stormo: stesso time step di update_all_boids, ma ogni analytics.interval time step
+// la griglia appena costruita viene riusata per etichettare i gruppi con un union-find parallelo sulle celle
+// e il ciclo delle interazioni riduce il numero di vicini e le direzioni dalle NeighborSums già calcolate
+
+// radice di una cella; i genitori vengono letti in modo atomico perché altri thread possono unire in concorrenza
+// (nessuna compressione dei cammini: con poche centinaia di celle gli alberi restano bassi)
+static inline int find_root(int* parent, int cell)
+{
+    int next = std::atomic_ref<int>(parent[cell]).load(std::memory_order_relaxed);
+    while (next != cell) {
+        cell = next;
+        next = std::atomic_ref<int>(parent[cell]).load(std::memory_order_relaxed);
+    }
+    return cell;
+}
+
+// unione lock-free: la radice con indice maggiore viene appesa a quella minore con una compare-and-swap,
+// quindi i collegamenti vanno sempre verso indici minori e non si possono formare cicli
+static inline void unite(int* parent, int a, int b)
+{
+    while (true) {
+        a = find_root(parent, a);
+        b = find_root(parent, b);
+        if (a == b)
+            return;
+        if (a < b)
+            std::swap(a, b);
+        int expected = a;
+        if (std::atomic_ref<int>(parent[a]).compare_exchange_strong(expected, b, std::memory_order_relaxed))
+            return;
+    }
+}
+
+// due celle appartengono allo stesso gruppo se almeno una coppia di loro boids è nel visual range (uscita alla prima coppia)
+static inline bool cells_linked(const Boids& boids, NeighborRange a, NeighborRange b)
+{
+    for (const int i : a) {
+        for (const int j : b) {
+            const float dx = boids.x[i] - boids.x[j];
+            const float dy = boids.y[i] - boids.y[j];
+            if (dx * dx + dy * dy < visual_range_squared)
+                return true;
+        }
+    }
+    return false;
+}
+
+void update_all_boids_analytics(const Boids& boids, Boids& new_boids, SoaWorkspace& workspace, FlockAnalytics& analytics, float deltaTime, int windowWidth, int windowHeight)
+{
+    // griglia riusata fra i time step (nessuna allocazione a regime)
+    SpatialGrid& grid = workspace.grid;
+    grid.resize(visual_range, windowWidth, windowHeight, boids.count);
+
+    const bool sample = analytics.interval > 0 && analytics.step % analytics.interval == 0;
+    const long long step = analytics.step++;
+    const int numCells = grid.num_cells();
+    const int gridWidth = grid.grid_width();
+    const int gridHeight = grid.grid_height();
+    if (sample) {
+        analytics.cellParent.resize(numCells);
+        analytics.clusterBoids.resize(numCells);
+    }
+    int* parent = analytics.cellParent.data();
+
+    // riduzioni del ciclo delle interazioni (solo nei time step campionati)
+    long long neighborTotal = 0;
+    float headingX = 0.0f, headingY = 0.0f;
+    std::chrono::steady_clock::time_point analyticsStart;
+    double clusterSeconds = 0.0;
+
+    #pragma omp parallel
+    {
+        build_grid(boids, grid);
+
+        // gruppi: union-find sulle celle occupate, ogni cella confrontata con le 4 adiacenti "in avanti"
+        if (sample) {
+            #pragma omp single nowait
+            analyticsStart = std::chrono::steady_clock::now();
+
+            #pragma omp for schedule(static)
+            for (int c = 0; c < numCells; ++c)
+                parent[c] = c;
+
+            #pragma omp for schedule(dynamic, 16)
+            for (int c = 0; c < numCells; ++c) {
+                const NeighborRange cell = grid.cell_content(c);
+                if (cell.begin() == cell.end())
+                    continue;
+
+                const int cx = c % gridWidth;
+                const int cy = c / gridWidth;
+                const int forward[4][2] = {{1, 0}, {-1, 1}, {0, 1}, {1, 1}};
+                for (const auto& offset : forward) {
+                    const int nx = cx + offset[0];
+                    const int ny = cy + offset[1];
+                    if (nx < 0 || nx >= gridWidth || ny >= gridHeight)
+                        continue;
+                    const NeighborRange other = grid.cell_content(ny * gridWidth + nx);
+                    if (other.begin() != other.end() && cells_linked(boids, cell, other))
+                        unite(parent, c, ny * gridWidth + nx);
+                }
+            }
+
+            // conteggi per gruppo e istogramma della densità (seriale: poche centinaia di celle)
+            #pragma omp single
+            {
+                std::fill(analytics.clusterBoids.begin(), analytics.clusterBoids.end(), 0);
+                std::fill(std::begin(analytics.densityHistogram), std::end(analytics.densityHistogram), 0);
+                for (int c = 0; c < numCells; ++c) {
+                    const int size = static_cast<int>(grid.cell_content(c).end() - grid.cell_content(c).begin());
+                    analytics.clusterBoids[find_root(parent, c)] += size;
+                    analytics.densityHistogram[std::min(size, analytics_density_bins - 1)]++;
+                }
+                analytics.numClusters = 0;
+                analytics.largestCluster = 0;
+                for (int c = 0; c < numCells; ++c) {
+                    if (analytics.clusterBoids[c] > 0) {
+                        analytics.numClusters++;
+                        analytics.largestCluster = std::max(analytics.largestCluster, analytics.clusterBoids[c]);
+                    }
+                }
+                clusterSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - analyticsStart).count();
+            }
+        }
+
+        perf_phase_begin(PHASE_UPDATE);
+        #if perf_counters_on
+        long long interactions = 0;
+        #endif
+        #pragma omp for schedule(static) reduction(+ : neighborTotal, headingX, headingY) nowait
+        for (int i = 0; i < boids.count; ++i) {
+            NeighborSums sums;
+            grid.query(boids.x[i], boids.y[i], [&](NeighborRange range) {
+                #if perf_counters_on
+                interactions += range.end() - range.begin();
+                #endif
+                accumulate_neighbors(boids, i, range.begin(), range.end(), sums);
+            });
+
+            if (sample) {
+                neighborTotal += sums.neighboring_boids;
+                const float speed = sqrtf(boids.vx[i] * boids.vx[i] + boids.vy[i] * boids.vy[i]);
+                if (speed > 0.0f) {
+                    headingX += boids.vx[i] / speed;
+                    headingY += boids.vy[i] / speed;
+                }
+            }
+
+            steer_and_integrate(boids, new_boids, i, sums, deltaTime, windowWidth, windowHeight);
+        }
+        #if perf_counters_on
+        perf_add_interactions(interactions);
+        #endif
+        perf_phase_end(PHASE_UPDATE);
+    }
+
+    if (!sample)
+        return;
+
+    // medie del campione e riga CSV (le riduzioni sono complete alla fine della regione parallela)
+    const auto rowStart = std::chrono::steady_clock::now();
+    const float numBoids = static_cast<float>(std::max(boids.count, 1));
+    analytics.polarization = std::sqrt(headingX * headingX + headingY * headingY) / numBoids;
+    analytics.meanNeighbors = static_cast<float>(neighborTotal) / numBoids;
+    analytics.samples++;
+    if (analytics.csv) {
+        std::ostream& csv = *analytics.csv;
+        csv << analytics.rowPrefix << step << ',' << analytics.polarization << ',' << analytics.meanNeighbors << ','
+            << analytics.numClusters << ',' << analytics.largestCluster;
+        for (const int cells : analytics.densityHistogram)
+            csv << ',' << cells;
+        csv << ',' << 1000.0 * clusterSeconds << '\n';
+    }
+    analytics.analyticsSeconds += clusterSeconds + std::chrono::duration<double>(std::chrono::steady_clock::now() - rowStart).count();
+}
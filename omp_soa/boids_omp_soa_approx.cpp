@@ -0,0 +1,161 @@
+#include <algorithm>
+#include <cmath>
+
+#ifdef _OPENMP
+#include <omp.h> // for OpenMP library functions
+#endif
+
+#include "boids_omp_soa.h"
+#include "boids_kernel.h"
+#include "aggregate_grid.h"
+#include "soa_workspace.h"
+#include "../common/perf_counters.h"
+
+// modalità approssimata per coesione e allineamento: servono solo le somme di posizioni e velocità dei vicini,
+// quindi una sotto-cella il cui bounding box cade tutto fra protected range e visual range contribuisce con i suoi
+// aggregati in O(1); il calcolo esatto a coppie resta per le sotto-celle di confine e per il protected range
+
+// una sotto-cella viene aggregata se il suo boid più lontano dista al più visual_range + farTolerance: con tolleranza 0
+// (il default) il risultato coincide con quello esatto a meno dell'ordine delle somme, una tolleranza positiva va chiesta
+// esplicitamente e accetta anche sotto-celle che sporgono di poco oltre il visual range (meno lavoro a coppie, errore
+// sulle medie); la tolleranza usata viene riportata in ApproxStats
+
+// costruisce la griglia fine e i suoi aggregati (da chiamare dentro una regione parallela)
+static void build_aggregate_grid(const Boids& boids, AggregateGrid& grid)
+{
+    #ifdef _OPENMP
+    const int numThreads = omp_get_num_threads();
+    const int thread = omp_get_thread_num();
+    #else
+    const int numThreads = 1;
+    const int thread = 0;
+    #endif
+
+    // contatori privati per thread, come in build_grid
+    #pragma omp single
+    grid.clear(numThreads);
+
+    // sotto-cella di ogni boid e conteggio
+    perf_phase_begin(PHASE_GRID_COUNT);
+    #pragma omp for schedule(static) nowait
+    for (int i = 0; i < boids.count; ++i)
+        grid.insert(i, boids.x[i], boids.y[i], thread);
+    perf_phase_end(PHASE_GRID_COUNT);
+    #pragma omp barrier
+
+    // prefix sum per (sotto-cella, thread) (seriale, costo trascurabile)
+    #pragma omp single
+    {
+        perf_phase_begin(PHASE_GRID_BUILD);
+        grid.build(numThreads);
+        perf_phase_end(PHASE_GRID_BUILD);
+    }
+
+    // riempimento con la stessa partizione statica del conteggio: ordine deterministico, uguale a quello seriale
+    perf_phase_begin(PHASE_GRID_FILL);
+    #pragma omp for schedule(static)
+    for (int i = 0; i < boids.count; ++i)
+        grid.insert_index(i, thread);
+    perf_phase_end(PHASE_GRID_FILL);
+
+    // aggregati di ogni sotto-cella (ogni thread scrive solo le proprie sotto-celle)
+    perf_phase_begin(PHASE_GRID_FILL);
+    #pragma omp for schedule(static)
+    for (int c = 0; c < grid.numCells; ++c) {
+        float sx = 0.0f, sy = 0.0f, svx = 0.0f, svy = 0.0f;
+        float x0 = INFINITY, x1 = -INFINITY, y0 = INFINITY, y1 = -INFINITY;
+        for (int k = grid.cellStart[c]; k < grid.cellStart[c + 1]; ++k) {
+            const int j = grid.boidIndices[k];
+            sx += boids.x[j];
+            sy += boids.y[j];
+            svx += boids.vx[j];
+            svy += boids.vy[j];
+            x0 = std::min(x0, boids.x[j]);
+            x1 = std::max(x1, boids.x[j]);
+            y0 = std::min(y0, boids.y[j]);
+            y1 = std::max(y1, boids.y[j]);
+        }
+        grid.sumX[c] = sx;
+        grid.sumY[c] = sy;
+        grid.sumVx[c] = svx;
+        grid.sumVy[c] = svy;
+        grid.minX[c] = x0;
+        grid.maxX[c] = x1;
+        grid.minY[c] = y0;
+        grid.maxY[c] = y1;
+    }
+    perf_phase_end(PHASE_GRID_FILL);
+}
+
+// funzione per aggiornare le posizioni di tutti i boids con gli aggregati per sotto-cella
+void update_all_boids_approx(const Boids& boids, Boids& new_boids, SoaWorkspace& workspace, float deltaTime, int windowWidth, int windowHeight, ApproxStats* stats, float farTolerance)
+{
+    AggregateGrid& grid = workspace.aggregateGrid;
+    grid.resize(visual_range / aggregate_subdivisions, windowWidth, windowHeight, boids.count);
+
+    const float farLimitSquared = (visual_range + farTolerance) * (visual_range + farTolerance);
+    long long aggregatedBoids = 0;
+    long long exactCandidates = 0;
+
+    #pragma omp parallel reduction(+:aggregatedBoids,exactCandidates)
+    {
+        build_aggregate_grid(boids, grid);
+
+        perf_phase_begin(PHASE_UPDATE);
+        #pragma omp for schedule(static) nowait
+        for (int i = 0; i < boids.count; ++i) {
+            const float px = boids.x[i];
+            const float py = boids.y[i];
+            const int cx = grid.cellOf[i] % grid.gridWidth;
+            const int cy = grid.cellOf[i] / grid.gridWidth;
+
+            // sotto-celle che possono contenere vicini (visual range = aggregate_subdivisions sotto-celle)
+            NeighborSums sums;
+            for (int ny = std::max(cy - aggregate_subdivisions, 0); ny <= std::min(cy + aggregate_subdivisions, grid.gridHeight - 1); ++ny) {
+                for (int nx = std::max(cx - aggregate_subdivisions, 0); nx <= std::min(cx + aggregate_subdivisions, grid.gridWidth - 1); ++nx) {
+                    const int c = ny * grid.gridWidth + nx;
+                    if (grid.count[c] == 0)
+                        continue;
+
+                    // distanza minima e massima fra il boid e il bounding box della sotto-cella
+                    const float nearX = std::max(std::max(grid.minX[c] - px, px - grid.maxX[c]), 0.0f);
+                    const float nearY = std::max(std::max(grid.minY[c] - py, py - grid.maxY[c]), 0.0f);
+                    const float minDistanceSquared = nearX * nearX + nearY * nearY;
+                    if (minDistanceSquared >= visual_range_squared)
+                        continue;
+
+                    const float farX = std::max(std::fabs(px - grid.minX[c]), std::fabs(px - grid.maxX[c]));
+                    const float farY = std::max(std::fabs(py - grid.minY[c]), std::fabs(py - grid.maxY[c]));
+                    const float maxDistanceSquared = farX * farX + farY * farY;
+
+                    if (minDistanceSquared >= protected_range_squared && maxDistanceSquared < farLimitSquared) {
+                        // sotto-cella tutta nella zona di coesione e allineamento: contributo in O(1)
+                        sums.xpos_avg += grid.sumX[c];
+                        sums.ypos_avg += grid.sumY[c];
+                        sums.xvel_avg += grid.sumVx[c];
+                        sums.yvel_avg += grid.sumVy[c];
+                        sums.neighboring_boids += grid.count[c];
+                        aggregatedBoids += grid.count[c];
+                    } else {
+                        // sotto-cella di confine o nel protected range: confronto esatto con ogni boid
+                        auto range = grid.cell_content(c);
+                        exactCandidates += range.end() - range.begin();
+                        accumulate_neighbors(boids, i, range.begin(), range.end(), sums);
+                    }
+                }
+            }
+
+            steer_and_integrate(boids, new_boids, i, sums, deltaTime, windowWidth, windowHeight);
+        }
+        #if perf_counters_on
+        perf_add_interactions(exactCandidates);
+        #endif
+        perf_phase_end(PHASE_UPDATE);
+    }
+
+    if (stats != nullptr) {
+        stats->aggregatedBoids += aggregatedBoids;
+        stats->exactCandidates += exactCandidates;
+        stats->farTolerance = farTolerance;
+    }
+}
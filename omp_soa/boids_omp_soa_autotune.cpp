@@ -0,0 +1,79 @@
+#ifdef _OPENMP
+#include <omp.h> // for OpenMP library functions
+#endif
+
+#include "boids_omp_soa.h"
+#include "boids_kernel.h"
+#include "spatial_grid.h"
+#include "soa_workspace.h"
+#include "../common/perf_counters.h"
+
+// time step con una configurazione esplicita, scelta dall'auto-tuner (autotune.h): numero di thread e schedule vengono
+// impostati solo per questa chiamata (le ICV del chiamante vengono ripristinate), il motore delega alle varianti esistenti
+
+// griglia con celle di config.cellFactor * visual_range: lo stencil 3x3 copre ancora tutto il visual range,
+// celle più grandi significano meno celle visitate ma più candidati scartati dal test sulla distanza
+static void update_configured_grid(const Boids& boids, Boids& new_boids, SoaWorkspace& workspace, const TuningConfig& config, float deltaTime, int windowWidth, int windowHeight)
+{
+    // griglia riusata fra i time step (nessuna allocazione a regime)
+    SpatialGrid& grid = workspace.grid;
+    grid.resize(visual_range * config.cellFactor, windowWidth, windowHeight, boids.count);
+
+    #pragma omp parallel
+    {
+        build_grid(boids, grid);
+
+        perf_phase_begin(PHASE_UPDATE);
+        #if perf_counters_on
+        long long interactions = 0;
+        #endif
+        // schedule impostato con omp_set_schedule (i boids di celle dense costano di più: dynamic / guided bilanciano i gruppi)
+        #pragma omp for schedule(runtime) nowait
+        for (int i = 0; i < boids.count; ++i) {
+            NeighborSums sums;
+            grid.query(boids.x[i], boids.y[i], [&](NeighborRange range) {
+                #if perf_counters_on
+                interactions += range.end() - range.begin();
+                #endif
+                accumulate_neighbors(boids, i, range.begin(), range.end(), sums);
+            });
+            steer_and_integrate(boids, new_boids, i, sums, deltaTime, windowWidth, windowHeight);
+        }
+        #if perf_counters_on
+        perf_add_interactions(interactions);
+        #endif
+        perf_phase_end(PHASE_UPDATE);
+    }
+}
+
+void update_all_boids_configured(const Boids& boids, Boids& new_boids, SoaWorkspace& workspace, const TuningConfig& config, float deltaTime, int windowWidth, int windowHeight)
+{
+    #ifdef _OPENMP
+    const int previousThreads = omp_get_max_threads();
+    omp_sched_t previousKind;
+    int previousChunk;
+    omp_get_schedule(&previousKind, &previousChunk);
+
+    omp_set_num_threads(config.threads);
+    const omp_sched_t kinds[] = {omp_sched_static, omp_sched_dynamic, omp_sched_guided};
+    omp_set_schedule(kinds[config.schedule], config.chunk);
+    #endif
+
+    switch (config.engine) {
+    case TUNED_ENGINE_QUADTREE:
+        update_all_boids(boids, new_boids, workspace, deltaTime, windowWidth, windowHeight, SPATIAL_INDEX_QUADTREE);
+        break;
+    case TUNED_ENGINE_TASKS:
+        update_all_boids_tasks(boids, new_boids, workspace, deltaTime, windowWidth, windowHeight);
+        break;
+    case TUNED_ENGINE_GRID:
+    default:
+        update_configured_grid(boids, new_boids, workspace, config, deltaTime, windowWidth, windowHeight);
+        break;
+    }
+
+    #ifdef _OPENMP
+    omp_set_num_threads(previousThreads);
+    omp_set_schedule(previousKind, previousChunk);
+    #endif
+}
@@ -0,0 +1,67 @@
+#ifdef _OPENMP
+#include <omp.h> // for OpenMP library functions
+#endif
+
+#include "boids_omp_soa.h"
+#include "boids_kernel.h"
+#include "spatial_grid.h"
+#include "../common/fast_math.h"
+#include "soa_workspace.h"
+#include "../common/perf_counters.h"
+
+// kernel veloce: stesse regole di update_all_boids con tre approssimazioni / riscritture
+//  - un solo test sul quadrato della distanza (niente test preliminare con fabs) e contributi dei vicini senza rami
+//  - clamp della velocità con fast_rsqrt (stima sui bit + un passo di Newton) invece di sqrtf e due divisioni
+//  - clamp e integrazione spostati in un secondo ciclo su tutti i boids, vettorizzato con omp simd
+// l'unica differenza non dovuta all'ordine delle somme è l'errore di fast_rsqrt sulla norma della velocità limitata (< 0.4%)
+
+// funzione per aggiornare la posizione di tutti i boids con il kernel veloce
+void update_all_boids_fast(const Boids& boids, Boids& new_boids, SoaWorkspace& workspace, float deltaTime, int windowWidth, int windowHeight)
+{
+    // griglia riusata fra i time step (nessuna allocazione a regime)
+    SpatialGrid& grid = workspace.grid;
+    grid.resize(visual_range, windowWidth, windowHeight, boids.count);
+
+    #pragma omp parallel
+    {
+        build_grid(boids, grid);
+
+        perf_phase_begin(PHASE_UPDATE);
+        #if perf_counters_on
+        long long interactions = 0;
+        #endif
+        // interazioni: la velocità dopo le regole, non ancora limitata, va nel nuovo buffer
+        #pragma omp for schedule(static)
+        for (int i = 0; i < boids.count; ++i) {
+            NeighborSums sums;
+            grid.query(boids.x[i], boids.y[i], [&](NeighborRange range) {
+                #if perf_counters_on
+                interactions += range.end() - range.begin();
+                #endif
+                accumulate_neighbors_fast(boids, i, range.begin(), range.end(), sums);
+            });
+
+            float vx = boids.vx[i];
+            float vy = boids.vy[i];
+            steer_velocity(boids, i, sums, windowWidth, windowHeight, vx, vy);
+            new_boids.vx[i] = vx;
+            new_boids.vy[i] = vy;
+        }
+
+        // clamp della velocità e integrazione della posizione, senza rami né divisioni
+        #pragma omp for simd schedule(static) nowait
+        for (int i = 0; i < boids.count; ++i) {
+            float vx = new_boids.vx[i];
+            float vy = new_boids.vy[i];
+            clamp_speed_fast(vx, vy, min_speed, max_speed);
+            new_boids.x[i] = boids.x[i] + vx * deltaTime;
+            new_boids.y[i] = boids.y[i] + vy * deltaTime;
+            new_boids.vx[i] = vx;
+            new_boids.vy[i] = vy;
+        }
+        #if perf_counters_on
+        perf_add_interactions(interactions);
+        #endif
+        perf_phase_end(PHASE_UPDATE);
+    }
+}
@@ -0,0 +1,88 @@
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h> // for OpenMP library functions
+#endif
+
+#include "boids_omp_soa.h"
+#include "boids_kernel.h"
+#include "incremental_grid.h"
+#include "../common/perf_counters.h"
+
+// motore con griglia incrementale: un boid si sposta al massimo di max_speed * deltaTime per time step, molto meno
+// della dimensione di una cella, quindi solo una piccola parte dei boids cambia cella; il cambio di cella viene
+// rilevato durante l'integrazione e la griglia viene aggiornata spostando solo quei boids
+
+// funzione per aggiornare le posizioni di tutti i boids mantenendo la griglia fra i time step
+void update_all_boids_incremental(const Boids& boids, Boids& new_boids, IncrementalGrid& grid, float deltaTime, int windowWidth, int windowHeight)
+{
+    // prima chiamata per questo stormo: costruzione completa dalle posizioni correnti
+    if (!grid.is_built_for(windowWidth, windowHeight, boids.count)) {
+        grid.reset(visual_range, windowWidth, windowHeight, boids.count);
+        grid.rebuild(boids.x, boids.y);
+    }
+
+    #pragma omp parallel
+    {
+        #ifdef _OPENMP
+        const int numThreads = omp_get_num_threads();
+        const int thread = omp_get_thread_num();
+        #else
+        const int numThreads = 1;
+        const int thread = 0;
+        #endif
+
+        #pragma omp single
+        grid.threadMigrations.resize(numThreads);
+
+        std::vector<CellMigration>& migrations = grid.threadMigrations[thread];
+        migrations.clear();
+
+        // interazioni, integrazione e rilevamento dei cambi di cella
+        perf_phase_begin(PHASE_UPDATE);
+        #if perf_counters_on
+        long long interactions = 0;
+        #endif
+        #pragma omp for schedule(static)
+        for (int i = 0; i < boids.count; ++i) {
+            const int cell = grid.cell_of(i);
+            const int cx = cell % grid.width();
+            const int cy = cell / grid.width();
+
+            // visita cella + 8 adiacenti (solo quelle dentro la griglia)
+            NeighborSums sums;
+            for (int ny = std::max(cy - 1, 0); ny <= std::min(cy + 1, grid.height() - 1); ++ny) {
+                for (int nx = std::max(cx - 1, 0); nx <= std::min(cx + 1, grid.width() - 1); ++nx) {
+                    auto range = grid.cell_content(nx, ny);
+                    #if perf_counters_on
+                    interactions += range.end() - range.begin();
+                    #endif
+                    accumulate_neighbors(boids, i, range.begin(), range.end(), sums);
+                }
+            }
+
+            steer_and_integrate(boids, new_boids, i, sums, deltaTime, windowWidth, windowHeight);
+
+            const int newCell = grid.world_to_cell(new_boids.x[i], new_boids.y[i]);
+            if (newCell != cell)
+                migrations.push_back({i, newCell});
+        }
+        #if perf_counters_on
+        perf_add_interactions(interactions);
+        #endif
+        perf_phase_end(PHASE_UPDATE);
+
+        // aggiornamento della griglia (seriale, costo proporzionale ai soli boids migrati);
+        // le liste vengono applicate in ordine di thread, quindi il risultato non dipende dallo scheduling
+        #pragma omp single
+        {
+            perf_phase_begin(PHASE_GRID_BUILD);
+            const bool applied = !grid.compaction_due() && grid.apply_migrations(grid.threadMigrations.data(), numThreads);
+
+            // cella senza margine o compattazione periodica: ricostruzione completa dalle nuove posizioni
+            if (!applied)
+                grid.rebuild(new_boids.x, new_boids.y);
+            perf_phase_end(PHASE_GRID_BUILD);
+        }
+    }
+}
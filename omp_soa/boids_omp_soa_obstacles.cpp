@@ -0,0 +1,168 @@
+#include <cmath>
+
+#include "boids_omp_soa.h"
+#include "boids_kernel.h"
+#include "spatial_grid.h"
+#include "obstacles.h"
+#include "soa_workspace.h"
+#include "../common/perf_counters.h"
+
+// variante con ostacoli statici e predatori: gli ostacoli sono cotti una volta sola in una ObstacleGrid con le stesse celle
+// della griglia dei boids (ogni boid controlla solo le capsule della propria cella), i predatori sono un piccolo stato SoA
+// separato riordinato a ogni time step in una SpatialGrid propria; il costo aggiunto per boid dipende solo dalla densità
+// locale di ostacoli e predatori
+
+static_assert(predator_range <= visual_range, "i predatori vengono cercati nelle 3x3 celle di lato visual_range");
+
+#define predator_range_squared (predator_range * predator_range)
+
+// spinta di allontanamento dalle capsule della cella di (x, y), sommata in (ax, ay); restituisce le capsule controllate
+static inline int avoid_obstacles(const ObstacleGrid& obstacles, float x, float y, float& ax, float& ay)
+{
+    const int cell = obstacles.cell_of(x, y);
+    const ObstacleCapsule* begin = obstacles.cell_begin(cell);
+    const ObstacleCapsule* end = obstacles.cell_end(cell);
+    for (const ObstacleCapsule* c = begin; c != end; ++c) {
+        float dx, dy;
+        const float distance = capsule_axis_distance(*c, x, y, dx, dy);
+        const float gap = distance - c->radius;
+
+        // spinta lungo la normale alla capsula, massima sulla superficie e nulla al margine (sull'asse la normale non è definita)
+        if (gap < obstacle_margin && distance > 0.0f) {
+            const float push = obstacle_turn_factor * (obstacle_margin - gap) / (obstacle_margin * distance);
+            ax += dx * push;
+            ay += dy * push;
+        }
+    }
+    return static_cast<int>(end - begin);
+}
+
+// inseguimento del centro dei boids visibili, ostacoli, margini e integrazione di un predatore
+static inline void steer_predator(const Boids& boids, const SpatialGrid& grid, const ObstacleGrid& obstacles,
+                                  const Boids& predators, Boids& new_predators, int p, float deltaTime, int windowWidth, int windowHeight)
+{
+    const float px = predators.x[p];
+    const float py = predators.y[p];
+    float vx = predators.vx[p];
+    float vy = predators.vy[p];
+
+    float xpos_avg = 0.0f, ypos_avg = 0.0f;
+    int visible = 0;
+    grid.query(px, py, [&](NeighborRange range) {
+        for (const int j : range) {
+            const float dx = boids.x[j] - px;
+            const float dy = boids.y[j] - py;
+            if (dx * dx + dy * dy < visual_range_squared) {
+                xpos_avg += boids.x[j];
+                ypos_avg += boids.y[j];
+                visible++;
+            }
+        }
+    });
+    if (visible > 0) {
+        vx += (xpos_avg / visible - px) * predator_chase_factor;
+        vy += (ypos_avg / visible - py) * predator_chase_factor;
+    }
+
+    avoid_obstacles(obstacles, px, py, vx, vy);
+
+    if (py < windowHeight * 0.05f) vy += turn_factor;
+    if (px > windowWidth  * 0.95f) vx -= turn_factor;
+    if (px < windowWidth  * 0.05f) vx += turn_factor;
+    if (py > windowHeight * 0.95f) vy -= turn_factor;
+
+    float speed = sqrtf(vx * vx + vy * vy);
+    if (speed < predator_min_speed && speed > 0.0f) {
+        vx = (vx / speed) * predator_min_speed;
+        vy = (vy / speed) * predator_min_speed;
+    }
+    if (speed > predator_max_speed) {
+        vx = (vx / speed) * predator_max_speed;
+        vy = (vy / speed) * predator_max_speed;
+    }
+
+    new_predators.x[p] = px + vx * deltaTime;
+    new_predators.y[p] = py + vy * deltaTime;
+    new_predators.vx[p] = vx;
+    new_predators.vy[p] = vy;
+}
+
+void update_all_boids_obstacles(const Boids& boids, Boids& new_boids, SoaWorkspace& workspace, const Boids& predators, Boids& new_predators,
+                                const ObstacleGrid& obstacles, float deltaTime, int windowWidth, int windowHeight, HazardStats* stats)
+{
+    // griglia riusata fra i time step (nessuna allocazione a regime)
+    SpatialGrid& grid = workspace.grid;
+    grid.resize(visual_range, windowWidth, windowHeight, boids.count);
+
+    // i predatori sono pochi: riordinati in seriale nella loro griglia (stesse celle di quella dei boids)
+    SpatialGrid& predatorGrid = workspace.predatorGrid;
+    predatorGrid.resize(visual_range, windowWidth, windowHeight, predators.count);
+    predatorGrid.clear();
+    for (int p = 0; p < predators.count; ++p)
+        predatorGrid.insert(predators.x[p], predators.y[p]);
+    predatorGrid.build();
+    for (int p = 0; p < predators.count; ++p)
+        predatorGrid.insert_index(p, predators.x[p], predators.y[p]);
+
+    long long obstacleChecks = 0;
+    long long predatorChecks = 0;
+
+    #pragma omp parallel reduction(+ : obstacleChecks, predatorChecks)
+    {
+        build_grid(boids, grid);
+
+        perf_phase_begin(PHASE_UPDATE);
+        #if perf_counters_on
+        long long interactions = 0;
+        #endif
+        #pragma omp for schedule(static) nowait
+        for (int i = 0; i < boids.count; ++i) {
+            const float x = boids.x[i];
+            const float y = boids.y[i];
+
+            NeighborSums sums;
+            grid.query(x, y, [&](NeighborRange range) {
+                #if perf_counters_on
+                interactions += range.end() - range.begin();
+                #endif
+                accumulate_neighbors(boids, i, range.begin(), range.end(), sums);
+            });
+
+            // ostacoli della cella
+            float ax = 0.0f, ay = 0.0f;
+            obstacleChecks += avoid_obstacles(obstacles, x, y, ax, ay);
+
+            // fuga dai predatori entro predator_range
+            float flee_dx = 0.0f, flee_dy = 0.0f;
+            predatorGrid.query(x, y, [&](NeighborRange range) {
+                predatorChecks += range.end() - range.begin();
+                for (const int p : range) {
+                    const float dx = x - predators.x[p];
+                    const float dy = y - predators.y[p];
+                    if (dx * dx + dy * dy < predator_range_squared) {
+                        flee_dx += dx;
+                        flee_dy += dy;
+                    }
+                }
+            });
+            ax += flee_dx * predator_avoid_factor;
+            ay += flee_dy * predator_avoid_factor;
+
+            steer_and_integrate(boids, new_boids, i, sums, deltaTime, windowWidth, windowHeight, ax, ay);
+        }
+
+        // i predatori leggono solo lo stato corrente, quindi possono procedere insieme ai boids
+        #pragma omp for schedule(static) nowait
+        for (int p = 0; p < predators.count; ++p)
+            steer_predator(boids, grid, obstacles, predators, new_predators, p, deltaTime, windowWidth, windowHeight);
+        #if perf_counters_on
+        perf_add_interactions(interactions);
+        #endif
+        perf_phase_end(PHASE_UPDATE);
+    }
+
+    if (stats) {
+        stats->obstacleChecks += obstacleChecks;
+        stats->predatorChecks += predatorChecks;
+    }
+}
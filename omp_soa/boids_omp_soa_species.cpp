@@ -0,0 +1,124 @@
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "boids_omp_soa.h"
+#include "boids_kernel.h"
+#include "spatial_grid.h"
+#include "species.h"
+#include "soa_workspace.h"
+#include "../common/perf_counters.h"
+
+// variante con più specie: i vicini di tutte le specie contribuiscono allo stesso modo (come nel modello originale),
+// ma le regole vengono applicate con i parametri della specie del boid e gli scout aggiungono il proprio bias;
+// le somme sui vicini vengono salvate per boid, poi il passo di integrazione scorre un blocco di specie alla volta
+
+void update_all_boids_species(const Boids& boids, Boids& new_boids, SoaWorkspace& workspace, const SpeciesBlocks& blocks, const float* bias, float* new_bias,
+                              float deltaTime, int windowWidth, int windowHeight)
+{
+    // somme sui vicini fra le due fasi, in SoA come lo stato (riusate fra i time step)
+    SoaWorkspace& w = workspace;
+    for (std::vector<float>* v : {&w.sumXpos, &w.sumYpos, &w.sumXvel, &w.sumYvel, &w.sumCloseDx, &w.sumCloseDy})
+        v->resize(boids.count);
+    w.sumNeighbors.resize(boids.count);
+    float* xposSum = w.sumXpos.data();
+    float* yposSum = w.sumYpos.data();
+    float* xvelSum = w.sumXvel.data();
+    float* yvelSum = w.sumYvel.data();
+    float* closeDx = w.sumCloseDx.data();
+    float* closeDy = w.sumCloseDy.data();
+    int* neighborCount = w.sumNeighbors.data();
+
+    // griglia riusata fra i time step (nessuna allocazione a regime)
+    SpatialGrid& grid = workspace.grid;
+    grid.resize(visual_range, windowWidth, windowHeight, boids.count);
+
+    #pragma omp parallel
+    {
+        build_grid(boids, grid);
+
+        // fase 1: somme sui vicini (indipendenti dalla specie)
+        perf_phase_begin(PHASE_UPDATE);
+        #if perf_counters_on
+        long long interactions = 0;
+        #endif
+        #pragma omp for schedule(static)
+        for (int i = 0; i < boids.count; ++i) {
+            NeighborSums s;
+            grid.query(boids.x[i], boids.y[i], [&](NeighborRange range) {
+                #if perf_counters_on
+                interactions += range.end() - range.begin();
+                #endif
+                accumulate_neighbors(boids, i, range.begin(), range.end(), s);
+            });
+            xposSum[i] = s.xpos_avg;
+            yposSum[i] = s.ypos_avg;
+            xvelSum[i] = s.xvel_avg;
+            yvelSum[i] = s.yvel_avg;
+            closeDx[i] = s.close_dx;
+            closeDy[i] = s.close_dy;
+            neighborCount[i] = s.neighboring_boids;
+        }
+        #if perf_counters_on
+        perf_add_interactions(interactions);
+        #endif
+
+        // fase 2: regole e integrazione, una specie alla volta con i parametri costanti nel ciclo
+        for (int b = 0; b < blocks.numBlocks; ++b) {
+            const SpeciesParams p = species_table[blocks.species[b]];
+
+            #pragma omp for simd schedule(static) nowait
+            for (int i = blocks.start[b]; i < blocks.start[b + 1]; ++i) {
+                const float px = boids.x[i];
+                const float py = boids.y[i];
+                float vx = boids.vx[i];
+                float vy = boids.vy[i];
+
+                // valori calcolati sempre e poi selezionati (niente operazioni condizionali, il ciclo resta vettorizzabile;
+                // GCC lo vettorizza solo con -fno-math-errno -fno-trapping-math, impostati in CMake per questo file)
+
+                // cohesion e alignment verso le medie dei vicini (senza vicini la media è il boid stesso e i termini si annullano)
+                const int neighbors = neighborCount[i];
+                const float invNeighbors = 1.0f / static_cast<float>(std::max(neighbors, 1));
+                const float xpos_avg = xposSum[i] * invNeighbors;
+                const float ypos_avg = yposSum[i] * invNeighbors;
+                const float xvel_avg = xvelSum[i] * invNeighbors;
+                const float yvel_avg = yvelSum[i] * invNeighbors;
+                vx += ((neighbors > 0 ? xpos_avg : px) - px) * p.centeringFactor;
+                vy += ((neighbors > 0 ? ypos_avg : py) - py) * p.centeringFactor;
+                vx += ((neighbors > 0 ? xvel_avg : vx) - vx) * p.matchingFactor;
+                vy += ((neighbors > 0 ? yvel_avg : vy) - vy) * p.matchingFactor;
+
+                // separation
+                vx += closeDx[i] * p.avoidFactor;
+                vy += closeDy[i] * p.avoidFactor;
+
+                // gestione dei margini dello schermo
+                vy += py < windowHeight * 0.05f ? p.turnFactor : 0.0f;
+                vx -= px > windowWidth  * 0.95f ? p.turnFactor : 0.0f;
+                vx += px < windowWidth  * 0.05f ? p.turnFactor : 0.0f;
+                vy -= py > windowHeight * 0.95f ? p.turnFactor : 0.0f;
+
+                // bias adattivo degli scout: cresce finché il boid va nella direzione del gruppo, altrimenti cala
+                // (per la specie senza bias biasDirection = 0, quindi il bias resta nullo e la velocità invariata)
+                const float biasUp = std::min(max_bias, bias[i] + bias_increment);
+                const float biasDown = std::max(bias_increment, bias[i] - bias_increment);
+                const float b_i = (vx * p.biasDirection > 0.0f ? biasUp : biasDown) * p.biasDirection * p.biasDirection;
+                vx = (1.0f - b_i) * vx + b_i * p.biasDirection;
+                new_bias[i] = b_i;
+
+                // clamp fra minima e massima velocità con min / max (a velocità nulla la velocità resta nulla)
+                const float speed = sqrtf(vx * vx + vy * vy);
+                const float scale = std::min(std::max(speed, p.minSpeed), p.maxSpeed) / std::max(speed, 1e-12f);
+                vx *= scale;
+                vy *= scale;
+
+                new_boids.x[i] = px + vx * deltaTime;
+                new_boids.y[i] = py + vy * deltaTime;
+                new_boids.vx[i] = vx;
+                new_boids.vy[i] = vy;
+            }
+        }
+        perf_phase_end(PHASE_UPDATE);
+    }
+}
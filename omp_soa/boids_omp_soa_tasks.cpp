@@ -0,0 +1,131 @@
+#include <algorithm>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h> // for OpenMP library functions
+#endif
+
+#include "boids_omp_soa.h"
+#include "boids_kernel.h"
+#include "task_grid.h"
+#include "soa_workspace.h"
+#include "../common/perf_counters.h"
+
+// motore alternativo a task con dipendenze: il mondo è diviso in tile di task_tile_cells x task_tile_cells celle e anche
+// lo smistamento dei boids nelle tile procede per tile, senza passate globali né barriere:
+// - un task per tile sorgente classifica i boids che la tile conteneva al time step precedente; in un time step un boid si
+//   sposta molto meno del lato di una tile, quindi finisce nella stessa tile o in una delle 8 adiacenti
+// - un task per tile destinazione raccoglie dalle 9 sorgenti intorno i boids diretti a lei e li ordina per cella
+// - le interazioni di una tile partono appena la tile e le sue 8 adiacenti sono ordinate
+// le liste per tile vengono seminate con una passata seriale al primo time step (o se cambia il numero di boids o il mondo);
+// se un boid salta oltre le tile adiacenti (stato non consecutivo, ad esempio dopo un cambio di motore dell'auto-tuner)
+// le liste vengono riseminate e il time step ripetuto
+
+// interazioni e integrazione dei boids di una tile (richiede la tile e le adiacenti già ordinate)
+static void interact_tile(const TaskGrid& grid, int tile, const Boids& boids, Boids& new_boids, float deltaTime, int windowWidth, int windowHeight)
+{
+    #if perf_counters_on
+    long long interactions = 0;
+    #endif
+    for (const int i : grid.tileBoids[tile]) {
+        const int cx = grid.cellOf[i] % grid.gridWidth;
+        const int cy = grid.cellOf[i] / grid.gridWidth;
+
+        // visita cella + 8 adiacenti (solo quelle dentro la griglia), ognuna nella lista della propria tile
+        NeighborSums sums;
+        for (int ny = std::max(cy - 1, 0); ny <= std::min(cy + 1, grid.gridHeight - 1); ++ny) {
+            for (int nx = std::max(cx - 1, 0); nx <= std::min(cx + 1, grid.gridWidth - 1); ++nx) {
+                const int cell = ny * grid.gridWidth + nx;
+                const int* list = grid.tileBoids[grid.tile_of_cell(cell)].data();
+                const int* begin = list + grid.cellBegin[cell];
+                const int* end = list + grid.cellEnd[cell];
+                #if perf_counters_on
+                interactions += end - begin;
+                #endif
+                accumulate_neighbors(boids, i, begin, end, sums);
+            }
+        }
+
+        steer_and_integrate(boids, new_boids, i, sums, deltaTime, windowWidth, windowHeight);
+    }
+    #if perf_counters_on
+    perf_add_interactions(interactions);
+    #endif
+}
+
+// grafo di task di un time step; false se un boid è uscito dalle tile adiacenti alla sua sorgente (risultato da scartare)
+static bool run_task_graph(TaskGrid& grid, const Boids& boids, Boids& new_boids, float deltaTime, int windowWidth, int windowHeight)
+{
+    const int numTiles = grid.tilesX * grid.tilesY;
+    [[maybe_unused]] char* sourceToken = grid.sourceToken.data();
+    [[maybe_unused]] char* tileToken = grid.tileToken.data();
+    bool contained = true;
+
+    #pragma omp parallel
+    #pragma omp single
+    {
+        // smistamento: ogni tile sorgente classifica i propri boids
+        for (int t = 0; t < numTiles; ++t) {
+            #pragma omp task firstprivate(t) depend(out: sourceToken[t]) shared(contained)
+            {
+                perf_phase_begin(PHASE_GRID_COUNT);
+                if (!grid.stage_source(t, boids)) {
+                    #pragma omp atomic write
+                    contained = false;
+                }
+                perf_phase_end(PHASE_GRID_COUNT);
+            }
+        }
+
+        for (int t = 0; t < numTiles; ++t) {
+            // tile adiacenti (sul bordo si ripete la tile stessa)
+            const int tx = t % grid.tilesX, ty = t / grid.tilesX;
+            const int xl = std::max(tx - 1, 0), xr = std::min(tx + 1, grid.tilesX - 1);
+            const int yu = std::max(ty - 1, 0), yd = std::min(ty + 1, grid.tilesY - 1);
+            const int n0 = yu * grid.tilesX + xl, n1 = yu * grid.tilesX + tx, n2 = yu * grid.tilesX + xr;
+            const int n3 = ty * grid.tilesX + xl, n5 = ty * grid.tilesX + xr;
+            const int n6 = yd * grid.tilesX + xl, n7 = yd * grid.tilesX + tx, n8 = yd * grid.tilesX + xr;
+
+            // raccolta e ordinamento della tile appena le sorgenti intorno sono classificate
+            #pragma omp task firstprivate(t) depend(in: sourceToken[n0], sourceToken[n1], sourceToken[n2], sourceToken[n3], sourceToken[t], sourceToken[n5], sourceToken[n6], sourceToken[n7], sourceToken[n8]) depend(out: tileToken[t])
+            {
+                perf_phase_begin(PHASE_GRID_FILL);
+                grid.bin_tile(t);
+                perf_phase_end(PHASE_GRID_FILL);
+            }
+        }
+
+        for (int t = 0; t < numTiles; ++t) {
+            const int tx = t % grid.tilesX, ty = t / grid.tilesX;
+            const int xl = std::max(tx - 1, 0), xr = std::min(tx + 1, grid.tilesX - 1);
+            const int yu = std::max(ty - 1, 0), yd = std::min(ty + 1, grid.tilesY - 1);
+            const int n0 = yu * grid.tilesX + xl, n1 = yu * grid.tilesX + tx, n2 = yu * grid.tilesX + xr;
+            const int n3 = ty * grid.tilesX + xl, n5 = ty * grid.tilesX + xr;
+            const int n6 = yd * grid.tilesX + xl, n7 = yd * grid.tilesX + tx, n8 = yd * grid.tilesX + xr;
+
+            #pragma omp task firstprivate(t) depend(in: tileToken[n0], tileToken[n1], tileToken[n2], tileToken[n3], tileToken[t], tileToken[n5], tileToken[n6], tileToken[n7], tileToken[n8])
+            {
+                perf_phase_begin(PHASE_UPDATE);
+                interact_tile(grid, t, boids, new_boids, deltaTime, windowWidth, windowHeight);
+                perf_phase_end(PHASE_UPDATE);
+            }
+        }
+    }
+    return contained;
+}
+
+// funzione per aggiornare le posizioni di tutti i boids con un grafo di task sulle tile
+void update_all_boids_tasks(const Boids& boids, Boids& new_boids, SoaWorkspace& workspace, float deltaTime, int windowWidth, int windowHeight)
+{
+    TaskGrid& grid = workspace.taskGrid;
+    grid.resize(visual_range, windowWidth, windowHeight, boids.count);
+    if (grid.numBoids < 0)
+        grid.seed(boids);
+
+    // un boid fuori dalle tile adiacenti manca nella tile di arrivo: risemina e ripete il time step (new_boids viene
+    // riscritto per intero)
+    if (!run_task_graph(grid, boids, new_boids, deltaTime, windowWidth, windowHeight)) {
+        grid.seed(boids);
+        run_task_graph(grid, boids, new_boids, deltaTime, windowWidth, windowHeight);
+    }
+}
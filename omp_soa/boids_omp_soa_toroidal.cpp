@@ -0,0 +1,131 @@
+#include <cmath>
+
+#include "boids_omp_soa.h"
+#include "boids_kernel.h"
+#include "periodic_grid.h"
+#include "soa_workspace.h"
+#include "../common/perf_counters.h"
+
+// variante con mondo toroidale: nessun margine (niente turn_factor), le posizioni si richiudono sui bordi opposti
+// e le distanze usano l'immagine più vicina di ogni vicino, quindi la densità resta uniforme anche nelle simulazioni lunghe
+
+// differenza con l'immagine più vicina (i boids sono nel mondo, quindi basta una sola correzione)
+static inline float minimum_image(float d, float size)
+{
+    d = d >  0.5f * size ? d - size : d;
+    d = d < -0.5f * size ? d + size : d;
+    return d;
+}
+
+// come accumulate_neighbors, con le differenze prese sull'immagine più vicina; le posizioni dei vicini sono quelle
+// dell'immagine (bx - dx), così il centro dei vicini resta corretto anche a cavallo di un bordo
+static inline void accumulate_neighbors_periodic(const Boids& boids, int i, const int* begin, const int* end, NeighborSums& sums,
+                                                 float worldWidth, float worldHeight)
+{
+    const float bx = boids.x[i];
+    const float by = boids.y[i];
+    for (const int* it = begin; it != end; ++it) {
+        const int j = *it;
+        if (j == i)
+            continue;
+
+        const float dx = minimum_image(bx - boids.x[j], worldWidth);
+        const float dy = minimum_image(by - boids.y[j], worldHeight);
+        const float squared_distance = dx * dx + dy * dy;
+
+        if (squared_distance < protected_range_squared) {
+            sums.close_dx += dx;
+            sums.close_dy += dy;
+        } else if (squared_distance < visual_range_squared) {
+            sums.xpos_avg += bx - dx;
+            sums.ypos_avg += by - dy;
+            sums.xvel_avg += boids.vx[j];
+            sums.yvel_avg += boids.vy[j];
+            sums.neighboring_boids++;
+        }
+    }
+}
+
+// regole senza margini e integrazione con la posizione riportata nel mondo
+static inline void steer_and_wrap(const Boids& boids, Boids& new_boids, int i, NeighborSums sums, float deltaTime, float worldWidth, float worldHeight)
+{
+    const float px = boids.x[i];
+    const float py = boids.y[i];
+    float vx = boids.vx[i];
+    float vy = boids.vy[i];
+
+    if (sums.neighboring_boids > 0) {
+        sums.xpos_avg /= static_cast<float>(sums.neighboring_boids);
+        sums.ypos_avg /= static_cast<float>(sums.neighboring_boids);
+        sums.xvel_avg /= static_cast<float>(sums.neighboring_boids);
+        sums.yvel_avg /= static_cast<float>(sums.neighboring_boids);
+
+        // cohesion e alignment
+        vx += (sums.xpos_avg - px) * centering_factor;
+        vy += (sums.ypos_avg - py) * centering_factor;
+        vx += (sums.xvel_avg - vx) * matching_factor;
+        vy += (sums.yvel_avg - vy) * matching_factor;
+    }
+
+    // separation
+    vx += sums.close_dx * avoid_factor;
+    vy += sums.close_dy * avoid_factor;
+
+    // clamp fra minima e massima velocità (a velocità nulla la direzione non è definita)
+    float speed = sqrtf(vx * vx + vy * vy);
+    if (speed < min_speed && speed > 0.0f) {
+        vx = (vx / speed) * min_speed;
+        vy = (vy / speed) * min_speed;
+    }
+    if (speed > max_speed) {
+        vx = (vx / speed) * max_speed;
+        vy = (vy / speed) * max_speed;
+    }
+
+    // nuova posizione riportata in [0, world) (lo spostamento per step è molto minore del mondo)
+    float x = px + vx * deltaTime;
+    float y = py + vy * deltaTime;
+    x = x < 0.0f ? x + worldWidth : (x >= worldWidth ? x - worldWidth : x);
+    y = y < 0.0f ? y + worldHeight : (y >= worldHeight ? y - worldHeight : y);
+
+    new_boids.x[i] = x;
+    new_boids.y[i] = y;
+    new_boids.vx[i] = vx;
+    new_boids.vy[i] = vy;
+}
+
+void update_all_boids_toroidal(const Boids& boids, Boids& new_boids, SoaWorkspace& workspace, float deltaTime, int windowWidth, int windowHeight)
+{
+    // griglia e tabella dello stencil riusate fra i time step
+    PeriodicGrid& grid = workspace.periodicGrid;
+    grid.resize(visual_range, windowWidth, windowHeight, boids.count);
+    const float worldWidth = static_cast<float>(windowWidth);
+    const float worldHeight = static_cast<float>(windowHeight);
+
+    #pragma omp parallel
+    {
+        perf_phase_begin(PHASE_GRID_BUILD);
+        grid.build(boids.x, boids.y, boids.count);
+        perf_phase_end(PHASE_GRID_BUILD);
+
+        perf_phase_begin(PHASE_UPDATE);
+        #if perf_counters_on
+        long long interactions = 0;
+        #endif
+        #pragma omp for schedule(static) nowait
+        for (int i = 0; i < boids.count; ++i) {
+            NeighborSums sums;
+            grid.query(boids.x[i], boids.y[i], [&](NeighborRange range) {
+                #if perf_counters_on
+                interactions += range.end() - range.begin();
+                #endif
+                accumulate_neighbors_periodic(boids, i, range.begin(), range.end(), sums, worldWidth, worldHeight);
+            });
+            steer_and_wrap(boids, new_boids, i, sums, deltaTime, worldWidth, worldHeight);
+        }
+        #if perf_counters_on
+        perf_add_interactions(interactions);
+        #endif
+        perf_phase_end(PHASE_UPDATE);
+    }
+}
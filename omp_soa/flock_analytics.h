@@ -0,0 +1,42 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+// statistiche dello stormo calcolate durante la simulazione (update_all_boids_analytics), senza dump su file:
+// parametro d'ordine di polarizzazione, numero medio di vicini, gruppi (cluster) e istogramma della densità per cella
+
+#define analytics_interval 10     // un campione ogni analytics_interval time step
+#define analytics_density_bins 16 // l'ultima classe raccoglie le celle con almeno analytics_density_bins - 1 boids
+
+struct FlockAnalytics {
+    int interval = analytics_interval;
+    std::ostream* csv = nullptr; // se non nullo, una riga per campione (intestazione con write_analytics_header)
+    std::string rowPrefix;       // colonne scritte all'inizio di ogni riga (es. "5000,4,1,"), in accordo con l'intestazione
+
+    long long step = 0; // time step della prossima chiamata
+
+    // ultimo campione (stato corrente all'inizio del time step campionato)
+    float polarization = 0.0f;  // |somma delle direzioni| / N: 1 stormo allineato, ~0 direzioni casuali
+    float meanNeighbors = 0.0f; // vicini usati da coesione e allineamento (come in NeighborSums)
+    int numClusters = 0;        // componenti connesse delle celle occupate collegate da almeno una coppia nel visual range
+    int largestCluster = 0;     // boids del gruppo più grande
+    int densityHistogram[analytics_density_bins] = {};
+
+    // costo dei campioni, misurato a parte: riduzioni nel ciclo delle interazioni escluse, union-find e istogramma inclusi
+    int samples = 0;
+    double analyticsSeconds = 0.0;
+
+    // union-find sulle celle, riusato fra i campioni
+    std::vector<int> cellParent;
+    std::vector<int> clusterBoids;
+};
+
+inline void write_analytics_header(std::ostream& csv, const std::string& prefixColumns = "")
+{
+    csv << prefixColumns << "step,polarization,mean_neighbors,clusters,largest_cluster";
+    for (int b = 0; b < analytics_density_bins; ++b)
+        csv << ",cells_" << b << (b == analytics_density_bins - 1 ? "_plus" : "");
+    csv << ",analytics_ms\n";
+}
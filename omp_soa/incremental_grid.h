@@ -0,0 +1,190 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "spatial_grid.h"
+
+// griglia mantenuta in modo incrementale fra i time step: ogni cella ha una capacità con margine (slack),
+// i boids che cambiano cella vengono spostati singolarmente e la griglia viene ricompattata solo quando
+// una cella esaurisce il margine o ogni incremental_compaction_interval time step
+
+#define incremental_min_slack 8
+#define incremental_compaction_interval 64
+
+// spostamento di un boid fra due celle
+struct CellMigration {
+    int boid;
+    int toCell;
+};
+
+class IncrementalGrid
+{
+public:
+    // dimensiona la griglia per un nuovo stormo (la prossima chiamata a rebuild la riempie da zero)
+    void reset(float cellSize, int worldWidth, int worldHeight, int maxBoids)
+    {
+        this->cellSize = cellSize;
+        this->worldWidth = worldWidth;
+        this->worldHeight = worldHeight;
+        this->maxBoids = maxBoids;
+
+        gridWidth  = static_cast<int>(std::ceil(worldWidth  / cellSize));
+        gridHeight = static_cast<int>(std::ceil(worldHeight / cellSize));
+        numCells   = gridWidth * gridHeight;
+
+        cellStart.resize(numCells);
+        cellCount.resize(numCells);
+        cellCapacity.resize(numCells);
+        boidCell.resize(maxBoids);
+        boidSlot.resize(maxBoids);
+
+        built = false;
+        slackDivisor = 4;
+        migrationsApplied = 0;
+        rebuilds = 0;
+    }
+
+    // true se la griglia descrive già uno stormo di queste dimensioni
+    bool is_built_for(int worldWidth, int worldHeight, int maxBoids) const
+    {
+        return built && this->worldWidth == worldWidth && this->worldHeight == worldHeight && this->maxBoids == maxBoids;
+    }
+
+    // ricostruzione completa (prima chiamata, overflow di una cella o compattazione periodica)
+    void rebuild(const float* x, const float* y)
+    {
+        std::fill(cellCount.begin(), cellCount.end(), 0);
+        for (int i = 0; i < maxBoids; ++i) {
+            boidCell[i] = world_to_cell(x[i], y[i]);
+            cellCount[boidCell[i]]++;
+        }
+
+        // capacità = occupazione corrente + margine proporzionale
+        int offset = 0;
+        for (int c = 0; c < numCells; ++c) {
+            cellStart[c] = offset;
+            cellCapacity[c] = cellCount[c] + std::max(incremental_min_slack, cellCount[c] / slackDivisor);
+            offset += cellCapacity[c];
+            cellCount[c] = 0;
+        }
+        slots.resize(offset);
+
+        for (int i = 0; i < maxBoids; ++i)
+            place(i, boidCell[i]);
+
+        stepsSinceRebuild = 0;
+        built = true;
+        rebuilds++;
+    }
+
+    // applica gli spostamenti raccolti durante l'integrazione, in due passate per liberare i posti prima di occuparli;
+    // restituisce false se una cella ha esaurito il margine (la griglia va allora ricostruita con rebuild)
+    bool apply_migrations(const std::vector<CellMigration>* lists, int numLists)
+    {
+        // rimuove i boids dalla vecchia cella spostando l'ultimo elemento al loro posto
+        for (int l = 0; l < numLists; ++l) {
+            for (const CellMigration& m : lists[l]) {
+                const int from = boidCell[m.boid];
+                const int last = cellStart[from] + cellCount[from] - 1;
+                const int moved = slots[last];
+                slots[boidSlot[m.boid]] = moved;
+                boidSlot[moved] = boidSlot[m.boid];
+                cellCount[from]--;
+            }
+        }
+
+        for (int l = 0; l < numLists; ++l) {
+            for (const CellMigration& m : lists[l]) {
+                // cella piena: alla prossima ricostruzione il margine raddoppia
+                if (cellCount[m.toCell] == cellCapacity[m.toCell]) {
+                    slackDivisor = std::max(1, slackDivisor / 2);
+                    return false;
+                }
+                place(m.boid, m.toCell);
+            }
+            migrationsApplied += static_cast<long long>(lists[l].size());
+        }
+        return true;
+    }
+
+    // da chiamare una volta per time step: true quando è il momento della compattazione periodica
+    bool compaction_due()
+    {
+        return ++stepsSinceRebuild >= incremental_compaction_interval;
+    }
+
+    // leggi il contenuto della cella (cx, cy)
+    NeighborRange cell_content(int cx, int cy) const
+    {
+        const int cell = cy * gridWidth + cx;
+        return {
+            &slots[cellStart[cell]],
+            &slots[cellStart[cell] + cellCount[cell]]
+        };
+    }
+
+    // cella corrente del boid
+    int cell_of(int boid) const
+    {
+        return boidCell[boid];
+    }
+
+    // trasforma coordinate da world a grid 1d (clamp sulle celle di bordo)
+    inline int world_to_cell(float x, float y) const
+    {
+        int cx = static_cast<int>(std::floor(x / cellSize));
+        int cy = static_cast<int>(std::floor(y / cellSize));
+
+        cx = std::clamp(cx, 0, gridWidth  - 1);
+        cy = std::clamp(cy, 0, gridHeight - 1);
+
+        return cy * gridWidth + cx;
+    }
+
+    int width() const
+    {
+        return gridWidth;
+    }
+
+    int height() const
+    {
+        return gridHeight;
+    }
+
+    // statistiche per confrontare il costo con la ricostruzione completa
+    long long migrationsApplied = 0;
+    int rebuilds = 0;
+
+    // spostamenti raccolti da ogni thread in update_all_boids_incremental (riusati fra i time step)
+    std::vector<std::vector<CellMigration>> threadMigrations;
+
+private:
+    float cellSize = 0.0f;
+    int worldWidth = 0;
+    int worldHeight = 0;
+    int gridWidth = 0;
+    int gridHeight = 0;
+    int numCells = 0;
+    int maxBoids = 0;
+    bool built = false;
+    int stepsSinceRebuild = 0;
+    int slackDivisor = 4; // margine per cella = occupazione / slackDivisor (dimezzato a ogni overflow)
+
+    std::vector<int> cellStart;
+    std::vector<int> cellCount;
+    std::vector<int> cellCapacity;
+    std::vector<int> slots;
+    std::vector<int> boidCell;
+    std::vector<int> boidSlot;
+
+    // inserisce il boid in coda alla cella (la capacità è già stata verificata)
+    inline void place(int boid, int cell)
+    {
+        const int slot = cellStart[cell] + cellCount[cell]++;
+        slots[slot] = boid;
+        boidSlot[boid] = slot;
+        boidCell[boid] = cell;
+    }
+};
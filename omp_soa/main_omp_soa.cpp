@@ -1,26 +1,95 @@
 #ifdef _OPENMP
 #include <omp.h> // for OpenMP library functions
 #endif
+#include <algorithm>
 #include <chrono>
 #include <cstdio>
 #include <cstdlib>
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <vector>
 
 #include <SFML/Graphics.hpp>
 #include <SFML/System.hpp>
 #include <SFML/Window.hpp>
 
+#include "../common/perf_counters.h"
+#include "../common/scaling_study.h"
+#include "../common/perf_gate.h"
+#include "../common/validation.h"
+#include "../common/fast_math.h"
+#include "../common/alloc_tracking.h"
+
 #include "boids_omp_soa.h"
+#include "boids_kernel.h"
+#include "soa_workspace.h"
+#include "incremental_grid.h"
+#include "species.h"
+#include "obstacles.h"
+#include "flock_analytics.h"
+#include "shm_frames.h"
+#include "autotune.h"
+#if trajectory_archive_on
+#include "trajectory_archive.h"
+#endif
 
 #define visuals_on true
 #define spatial_partitioning_on true
+#define task_graph_on false // usa il motore a task con dipendenze sulle tile (update_all_boids_tasks)
+#define incremental_grid_on false // mantiene la griglia fra i time step spostando solo i boids che cambiano cella (update_all_boids_incremental)
+#define approx_far_field_on false // coesione e allineamento approssimati con gli aggregati per sotto-cella (update_all_boids_approx)
+#define approx_far_tolerance 0.0f // con approx_far_field_on: margine oltre il visual range entro cui una sotto-cella viene aggregata (0 = esatto)
+#define species_on false // più specie con parametri propri e gruppi di scout con bias adattivo (update_all_boids_species)
+#define toroidal_on false // mondo toroidale senza bordi, con posizioni periodiche (update_all_boids_toroidal)
+#define obstacles_on false // ostacoli statici e predatori da evitare (update_all_boids_obstacles)
+#define shm_publish_on false // il motore scrive ogni time step direttamente in un ring di frame in memoria condivisa (shm_frames.h, lettore in shm_reader/)
+#define analytics_on false // statistiche dello stormo ogni analytics_interval time step, scritte in analytics_omp_soa.csv (update_all_boids_analytics)
+#define autotune_on false // thread, motore, celle e schedule scelti a runtime dall'auto-tuner, con la scelta salvata in autotune_cache.txt (autotune.h)
+// fast_math_on (common/fast_math.h, -DBOIDS_FAST_MATH=ON): kernel veloce con norma inversa approssimata e cicli senza rami (update_all_boids_fast)
+// trajectory_archive_on (-DBOIDS_TRAJECTORY_ARCHIVE=ON, richiede zlib): la prima run di ogni caso viene archiviata compressa in
+// trajectory_omp_soa_<agents>_<threads>.btra (trajectory_archive.h, lettore in archive_reader/)
+#ifndef trajectory_archive_on
+#define trajectory_archive_on false
+#endif
+
+#define num_obstacles 2000 // ostacoli del campo generato con make_obstacle_field
+#define num_predators 8
+#define trajectory_archive_interval 1 // time step fra due frame archiviati
 
-#if spatial_partitioning_on
+#if task_graph_on
+#define log_file_name "logfile_omp_soa_tasks.txt"
+#define scaling_engine_name "omp_soa_tasks"
+#elif incremental_grid_on
+#define log_file_name "logfile_omp_soa_inc.txt"
+#define scaling_engine_name "omp_soa_inc"
+#elif approx_far_field_on
+#define log_file_name "logfile_omp_soa_approx.txt"
+#define scaling_engine_name "omp_soa_approx"
+#elif species_on
+#define log_file_name "logfile_omp_soa_species.txt"
+#define scaling_engine_name "omp_soa_species"
+#elif toroidal_on
+#define log_file_name "logfile_omp_soa_torus.txt"
+#define scaling_engine_name "omp_soa_torus"
+#elif obstacles_on
+#define log_file_name "logfile_omp_soa_obstacles.txt"
+#define scaling_engine_name "omp_soa_obstacles"
+#elif analytics_on
+#define log_file_name "logfile_omp_soa_analytics.txt"
+#define scaling_engine_name "omp_soa_analytics"
+#elif autotune_on
+#define log_file_name "logfile_omp_soa_autotune.txt"
+#define scaling_engine_name "omp_soa_autotune"
+#elif fast_math_on
+#define log_file_name "logfile_omp_soa_fast.txt"
+#define scaling_engine_name "omp_soa_fast"
+#elif spatial_partitioning_on
 #define log_file_name "logfile_omp_soa_sp.txt"
+#define scaling_engine_name "omp_soa_sp"
 #else
 #define log_file_name "logfile_omp_soa.txt"
+#define scaling_engine_name "omp_soa"
 #endif
 
 int main(int argc, char* argv[])
@@ -56,13 +125,211 @@ int main(int argc, char* argv[])
 
     const int windowWidth = 1280;
     const int windowHeight = 720;
+
+    // indice spaziale scelto a runtime: "quadtree" come primo argomento, altrimenti griglia uniforme
+    const SpatialIndexKind spatialIndex = (argc > 1 && std::string(argv[1]) == "quadtree") ? SPATIAL_INDEX_QUADTREE : SPATIAL_INDEX_GRID;
+    std::cout << "Indice spaziale: " << (spatialIndex == SPATIAL_INDEX_QUADTREE ? "quadtree" : "griglia") << std::endl;
+
+    if (validation_requested(argc, argv)) {
+        // validazione incrociata: stessi stati iniziali e time step fisso del motore di riferimento (seq),
+        // solo per le varianti con le stesse regole di update_all_boids e un ramo qui sotto (con autotune_on si validerebbe
+        // update_all_boids al posto dell'auto-tuner); le altre vengono rifiutate in compilazione con validation_on, all'avvio con --validate
+        #if approx_far_field_on || species_on || toroidal_on || obstacles_on || autotune_on
+        #if validation_on
+        #error "validation_on confronta solo le varianti con le regole di update_all_boids"
+        #endif
+        std::cerr << "--validate confronta solo le varianti con le regole di update_all_boids." << std::endl;
+        return 1;
+        #else
+        SoaWorkspace validationWorkspace;
+        #if incremental_grid_on
+        IncrementalGrid validationGrid;
+        #elif analytics_on
+        FlockAnalytics validationAnalytics;
+        #endif
+        const std::string validationName = std::string(scaling_engine_name) + (spatialIndex == SPATIAL_INDEX_QUADTREE ? "_qt" : "")
+                                         + (validation_border_mutation ? "_border_mutant" : "");
+        return run_validation(validationName, windowWidth, windowHeight, [&](ValidationState& state, ValidationState& next, int timeStep, float deltaTime, int worldWidth, int worldHeight) {
+            Boids boids = Boids{.x = state.x.data(), .y = state.y.data(), .vx = state.vx.data(), .vy = state.vy.data(), .count = state.count()};
+            Boids new_boids = Boids{.x = next.x.data(), .y = next.y.data(), .vx = next.vx.data(), .vy = next.vy.data(), .count = next.count()};
+            // workspace nuovo per ogni simulazione (le liste per tile del motore a task seguono un solo stormo)
+            if (timeStep == 0)
+                validationWorkspace = SoaWorkspace();
+            SoaWorkspace& workspace = validationWorkspace;
+            #if task_graph_on
+            update_all_boids_tasks(boids, new_boids, workspace, deltaTime, worldWidth, worldHeight);
+            #elif incremental_grid_on
+            // griglia incrementale nuova per ogni simulazione
+            (void)workspace;
+            if (timeStep == 0)
+                validationGrid = IncrementalGrid();
+            update_all_boids_incremental(boids, new_boids, validationGrid, deltaTime, worldWidth, worldHeight);
+            #elif analytics_on
+            update_all_boids_analytics(boids, new_boids, workspace, validationAnalytics, deltaTime, worldWidth, worldHeight);
+            #elif fast_math_on
+            update_all_boids_fast(boids, new_boids, workspace, deltaTime, worldWidth, worldHeight);
+            #else
+            update_all_boids(boids, new_boids, workspace, deltaTime, worldWidth, worldHeight, spatialIndex);
+            #endif
+        });
+        #endif
+    }
+    // studio di scalabilità o perf gate senza grafica e con time step fisso, al posto dei casi di test standard
+    const std::string engineName = std::string(scaling_engine_name) + (spatialIndex == SPATIAL_INDEX_QUADTREE ? "_qt" : "");
+    auto runSimulation = [spatialIndex](int agents, int worldWidth, int worldHeight, int timeSteps, float deltaTime) {
+        Boids boids = Boids{
+            .x = new float[agents],
+            .y = new float[agents],
+            .vx = new float[agents],
+            .vy = new float[agents],
+            .count = agents,
+        };
+        Boids new_boids = Boids{
+            .x = new float[agents],
+            .y = new float[agents],
+            .vx = new float[agents],
+            .vy = new float[agents],
+            .count = agents,
+        };
+        for (int i = 0; i < agents; ++i)
+        {
+            boids.x[i] = rand() % worldWidth;
+            boids.y[i] = rand() % worldHeight;
+            boids.vx[i] = 0;
+            boids.vy[i] = 0;
+        }
+
+        // strutture dei motori riusate fra i time step di questa simulazione
+        SoaWorkspace workspace;
+        #if incremental_grid_on
+        IncrementalGrid grid;
+        #elif species_on
+        const SpeciesBlocks blocks = make_default_species_blocks(agents);
+        float* bias = new float[agents]();
+        float* new_bias = new float[agents]();
+        #elif obstacles_on
+        // ostacoli cotti una volta sola per questo mondo, predatori in un piccolo stato SoA separato
+        ObstacleGrid obstacles;
+        obstacles.bake(make_obstacle_field(worldWidth, worldHeight, num_obstacles), visual_range, worldWidth, worldHeight, obstacle_margin);
+        Boids predators = Boids{.x = new float[num_predators], .y = new float[num_predators], .vx = new float[num_predators], .vy = new float[num_predators], .count = num_predators};
+        Boids new_predators = Boids{.x = new float[num_predators], .y = new float[num_predators], .vx = new float[num_predators], .vy = new float[num_predators], .count = num_predators};
+        for (int p = 0; p < num_predators; ++p)
+        {
+            predators.x[p] = rand() % worldWidth;
+            predators.y[p] = rand() % worldHeight;
+            predators.vx[p] = predator_min_speed;
+            predators.vy[p] = 0;
+        }
+        #elif analytics_on
+        // nello studio di scalabilità le statistiche vengono calcolate senza scriverle (si misura solo il loro costo)
+        FlockAnalytics analytics;
+        #elif autotune_on
+        // thread dello studio come limite superiore; le simulazioni successive alla prima ritrovano la configurazione nel file
+        #ifdef _OPENMP
+        AutoTuner tuner(omp_get_max_threads());
+        #else
+        AutoTuner tuner(1);
+        #endif
+        #endif
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int step = 0; step < timeSteps; ++step)
+        {
+            #if task_graph_on
+            update_all_boids_tasks(boids, new_boids, workspace, deltaTime, worldWidth, worldHeight);
+            #elif incremental_grid_on
+            update_all_boids_incremental(boids, new_boids, grid, deltaTime, worldWidth, worldHeight);
+            #elif approx_far_field_on
+            update_all_boids_approx(boids, new_boids, workspace, deltaTime, worldWidth, worldHeight, nullptr, approx_far_tolerance);
+            #elif species_on
+            update_all_boids_species(boids, new_boids, workspace, blocks, bias, new_bias, deltaTime, worldWidth, worldHeight);
+            std::swap(bias, new_bias);
+            #elif toroidal_on
+            update_all_boids_toroidal(boids, new_boids, workspace, deltaTime, worldWidth, worldHeight);
+            #elif obstacles_on
+            update_all_boids_obstacles(boids, new_boids, workspace, predators, new_predators, obstacles, deltaTime, worldWidth, worldHeight);
+            std::swap(predators, new_predators);
+            #elif analytics_on
+            update_all_boids_analytics(boids, new_boids, workspace, analytics, deltaTime, worldWidth, worldHeight);
+            #elif autotune_on
+            tuner.step(boids, new_boids, deltaTime, worldWidth, worldHeight);
+            #elif fast_math_on
+            update_all_boids_fast(boids, new_boids, workspace, deltaTime, worldWidth, worldHeight);
+            #else
+            update_all_boids(boids, new_boids, workspace, deltaTime, worldWidth, worldHeight, spatialIndex);
+            #endif
+            std::swap(boids, new_boids);
+        }
+        auto stop = std::chrono::high_resolution_clock::now();
+
+        delete[] boids.x;
+        delete[] boids.y;
+        delete[] boids.vx;
+        delete[] boids.vy;
+        delete[] new_boids.x;
+        delete[] new_boids.y;
+        delete[] new_boids.vx;
+        delete[] new_boids.vy;
+        #if species_on
+        delete[] bias;
+        delete[] new_bias;
+        #elif obstacles_on
+        for (float* buffer : {predators.x, predators.y, predators.vx, predators.vy, new_predators.x, new_predators.y, new_predators.vx, new_predators.vy})
+            delete[] buffer;
+        #endif
+        return std::chrono::duration<double>(stop - start).count();
+    };
+    if (perf_gate_requested(argc, argv))
+        return run_perf_gate(engineName, windowWidth, windowHeight, runSimulation);
+    #if scaling_study_on
+    return run_scaling_study(engineName, windowWidth, windowHeight, runSimulation);
+    #endif
     #if visuals_on
     sf::RenderWindow window(sf::VideoMode(windowWidth, windowHeight), "Boids Simulation");
     #endif
 
+    #if shm_publish_on
+    // segmento condiviso dimensionato per il caso con più boids, riusato da tutte le simulazioni
+    ShmFrameWriter shmWriter;
+    if (!shmWriter.open(shm_frames_name, *std::max_element(numberOfAgents, numberOfAgents + numberOfAgentsCases), windowWidth, windowHeight))
+        return 1;
+    std::cout << "Stato pubblicato nel segmento condiviso " << shm_frames_name << "." << std::endl;
+    #endif
+
+    #if analytics_on
+    // un unico file per tutte le simulazioni, le prime colonne identificano la simulazione
+    std::ofstream analyticsFile("analytics_omp_soa.csv");
+    write_analytics_header(analyticsFile, "agents,threads,run,");
+    #endif
+
+    #if obstacles_on
+    // ostacoli statici: generati e cotti nella griglia una volta sola per tutte le simulazioni
+    const std::vector<ObstacleCapsule> obstacleField = make_obstacle_field(windowWidth, windowHeight, num_obstacles);
+    ObstacleGrid obstacles;
+    obstacles.bake(obstacleField, visual_range, windowWidth, windowHeight, obstacle_margin);
+    #if visuals_on
+    // ogni capsula è disegnata come il rettangolo che la contiene, orientato lungo il suo asse
+    sf::VertexArray obstacleQuads(sf::Quads, obstacleField.size() * 4);
+    for (size_t k = 0; k < obstacleField.size(); ++k)
+    {
+        const ObstacleCapsule& c = obstacleField[k];
+        const float length = std::hypot(c.bx - c.ax, c.by - c.ay);
+        const float ux = length > 0.0f ? (c.bx - c.ax) / length * c.radius : c.radius;
+        const float uy = length > 0.0f ? (c.by - c.ay) / length * c.radius : 0.0f;
+        obstacleQuads[k * 4].position = sf::Vector2f(c.ax - ux + uy, c.ay - uy - ux);
+        obstacleQuads[k * 4 + 1].position = sf::Vector2f(c.bx + ux + uy, c.by + uy - ux);
+        obstacleQuads[k * 4 + 2].position = sf::Vector2f(c.bx + ux - uy, c.by + uy + ux);
+        obstacleQuads[k * 4 + 3].position = sf::Vector2f(c.ax - ux - uy, c.ay - uy + ux);
+        for (int j = 0; j < 4; ++j)
+            obstacleQuads[k * 4 + j].color = sf::Color(110, 110, 110);
+    }
+    #endif
+    #endif
+
     for (int ti = 0; ti < numberOfThreadsCases; ti++)
     {
+        #ifdef _OPENMP
         omp_set_num_threads(numberOfThreads[ti]);
+        #endif
         for (int ai = 0; ai < numberOfAgentsCases; ai++)
         {
             for (int ri = 0; ri < numberOfRuns; ri++)
@@ -72,7 +339,14 @@ int main(int argc, char* argv[])
                 window.setTitle("Boids Simulation (n. " + std::to_string(ri + 1) + ", " + std::to_string(numberOfAgents[ai]) + " agents, " + std::to_string(numberOfThreads[ti]) + " threads)");
                 #endif
 
+                // azzera i contatori delle allocazioni prima di allocare lo stato di questa run
+                alloc_run_begin();
+
                 // inizializzazione stato boids (posizione iniziale random e velocità nulla), i buffer rappresentano rispettivamente lo stato corrente e successivo
+                #if shm_publish_on
+                // lo stato vive nei frame del ring condiviso: boids è il frame iniziale, new_boids viene aperto dopo la sua pubblicazione
+                Boids boids = shmWriter.begin_frame(numberOfAgents[ai]);
+                #else
                 Boids boids = Boids{
                     .x = new float[numberOfAgents[ai]],
                     .y = new float[numberOfAgents[ai]],
@@ -87,6 +361,7 @@ int main(int argc, char* argv[])
                     .vy = new float[numberOfAgents[ai]],
                     .count = numberOfAgents[ai],
                 };
+                #endif
                 for (int i = 0; i < numberOfAgents[ai]; ++i)
                 {
                     boids.x[i] = rand() % windowWidth;
@@ -94,6 +369,37 @@ int main(int argc, char* argv[])
                     boids.vx[i] = 0;
                     boids.vy[i] = 0;
                 }
+                #if shm_publish_on
+                shmWriter.publish_frame(0);
+                Boids new_boids = shmWriter.begin_frame(numberOfAgents[ai]);
+                #endif
+
+                #if trajectory_archive_on
+                // codifica in background, fuori dal tempo misurato; lo stato iniziale è il primo keyframe
+                TrajectoryArchiveWriter archive;
+                const bool archiveRun = ri == 0 && archive.open("trajectory_omp_soa_" + std::to_string(numberOfAgents[ai]) + "_" + std::to_string(numberOfThreads[ti]) + ".btra",
+                                                                numberOfAgents[ai], windowWidth, windowHeight);
+                if (archiveRun)
+                    archive.push(boids, 0);
+                #endif
+
+                #if species_on
+                // boids divisi in blocchi contigui per specie, bias degli scout inizialmente nullo
+                const SpeciesBlocks blocks = make_default_species_blocks(numberOfAgents[ai]);
+                float* bias = new float[numberOfAgents[ai]]();
+                float* new_bias = new float[numberOfAgents[ai]]();
+                #elif obstacles_on
+                // predatori: piccolo stato SoA separato con double buffering come i boids
+                Boids predators = Boids{.x = new float[num_predators], .y = new float[num_predators], .vx = new float[num_predators], .vy = new float[num_predators], .count = num_predators};
+                Boids new_predators = Boids{.x = new float[num_predators], .y = new float[num_predators], .vx = new float[num_predators], .vy = new float[num_predators], .count = num_predators};
+                for (int p = 0; p < num_predators; ++p)
+                {
+                    predators.x[p] = rand() % windowWidth;
+                    predators.y[p] = rand() % windowHeight;
+                    predators.vx[p] = predator_min_speed;
+                    predators.vy[p] = 0;
+                }
+                #endif
 
                 #if visuals_on
                 // inizializzazione grafica dei boids: ogni boid è un quadrato bianco (4 vertici)
@@ -102,12 +408,39 @@ int main(int argc, char* argv[])
                 for (int i = 0; i < numberOfAgents[ai]; ++i)
                 {
                     sf::Color boidColor(255, 255, 255);
+                    #if species_on
+                    // scout colorati in base alla direzione del bias
+                    const int species = blocks.species[std::upper_bound(blocks.start + 1, blocks.start + blocks.numBlocks, i) - (blocks.start + 1)];
+                    if (species_table[species].biasDirection > 0.0f) boidColor = sf::Color(255, 120, 120);
+                    if (species_table[species].biasDirection < 0.0f) boidColor = sf::Color(120, 200, 255);
+                    #endif
                     for (int j = 0; j < 4; ++j) {
                         (*boidsQuads)[i * 4 + j].color = boidColor;
                     }
                 }
                 #endif
 
+                // azzera i contatori hardware per questa run
+                perf_reset();
+
+                // strutture dei motori proprie di questa run, riusate fra i suoi time step
+                SoaWorkspace workspace;
+                #if incremental_grid_on
+                // griglia incrementale propria di questa run (costruita al primo time step)
+                IncrementalGrid grid;
+                #elif approx_far_field_on
+                ApproxStats approxStats;
+                #elif obstacles_on
+                HazardStats hazardStats;
+                #elif analytics_on
+                FlockAnalytics analytics;
+                analytics.csv = &analyticsFile;
+                analytics.rowPrefix = std::to_string(numberOfAgents[ai]) + "," + std::to_string(numberOfThreads[ti]) + "," + std::to_string(ri + 1) + ",";
+                #elif autotune_on
+                // numberOfThreads[ti] è il limite superiore dei thread provati
+                AutoTuner tuner(numberOfThreads[ti]);
+                #endif
+
                 // ciclo principale di esecuzione
                 float totalSimulationTime = 0.0f;
                 int elapsedTimeSteps = 0;
@@ -131,14 +464,39 @@ int main(int argc, char* argv[])
                     // clock SFML per smoothing della simulazione
                     sf::Time deltaTime = clock.restart();
 
+                    // allocazioni contate solo dentro l'aggiornamento dei boids
+                    alloc_step_begin();
+
                     // campiona il punto di inizio di questo time step con un clock ad alta risoluzione
                     auto start = std::chrono::high_resolution_clock::now();
 
                     // aggiorna lo stato dei boids
-                    update_all_boids(boids, new_boids, deltaTime.asSeconds() * speedUpSimulation, windowWidth, windowHeight);
+                    #if task_graph_on
+                    update_all_boids_tasks(boids, new_boids, workspace, deltaTime.asSeconds() * speedUpSimulation, windowWidth, windowHeight);
+                    #elif incremental_grid_on
+                    update_all_boids_incremental(boids, new_boids, grid, deltaTime.asSeconds() * speedUpSimulation, windowWidth, windowHeight);
+                    #elif approx_far_field_on
+                    update_all_boids_approx(boids, new_boids, workspace, deltaTime.asSeconds() * speedUpSimulation, windowWidth, windowHeight, &approxStats, approx_far_tolerance);
+                    #elif species_on
+                    update_all_boids_species(boids, new_boids, workspace, blocks, bias, new_bias, deltaTime.asSeconds() * speedUpSimulation, windowWidth, windowHeight);
+                    std::swap(bias, new_bias);
+                    #elif toroidal_on
+                    update_all_boids_toroidal(boids, new_boids, workspace, deltaTime.asSeconds() * speedUpSimulation, windowWidth, windowHeight);
+                    #elif obstacles_on
+                    update_all_boids_obstacles(boids, new_boids, workspace, predators, new_predators, obstacles, deltaTime.asSeconds() * speedUpSimulation, windowWidth, windowHeight, &hazardStats);
+                    #elif analytics_on
+                    update_all_boids_analytics(boids, new_boids, workspace, analytics, deltaTime.asSeconds() * speedUpSimulation, windowWidth, windowHeight);
+                    #elif autotune_on
+                    tuner.step(boids, new_boids, deltaTime.asSeconds() * speedUpSimulation, windowWidth, windowHeight);
+                    #elif fast_math_on
+                    update_all_boids_fast(boids, new_boids, workspace, deltaTime.asSeconds() * speedUpSimulation, windowWidth, windowHeight);
+                    #else
+                    update_all_boids(boids, new_boids, workspace, deltaTime.asSeconds() * speedUpSimulation, windowWidth, windowHeight, spatialIndex);
+                    #endif
 
                     // campiona il punto di fine di questo time step con un clock ad alta risoluzione
                     auto stop = std::chrono::high_resolution_clock::now();
+                    alloc_step_end();
 
                     // somma al tempo di esecuzione dell'algoritmo sugli altri boids
                     totalSimulationTime += std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count();
@@ -159,20 +517,52 @@ int main(int argc, char* argv[])
 
                     // disegno dei quads (boids) nella finestra SFML
                     window.clear();
+                    #if obstacles_on
+                    window.draw(obstacleQuads);
+                    // predatori come quadrati rossi più grandi
+                    sf::VertexArray predatorQuads(sf::Quads, num_predators * 4);
+                    for (int p = 0; p < num_predators; ++p)
+                    {
+                        const float x = new_predators.x[p];
+                        const float y = new_predators.y[p];
+                        predatorQuads[p * 4].position = sf::Vector2f(x - quadSize * 1.5f, y - quadSize * 1.5f);
+                        predatorQuads[p * 4 + 1].position = sf::Vector2f(x + quadSize * 1.5f, y - quadSize * 1.5f);
+                        predatorQuads[p * 4 + 2].position = sf::Vector2f(x + quadSize * 1.5f, y + quadSize * 1.5f);
+                        predatorQuads[p * 4 + 3].position = sf::Vector2f(x - quadSize * 1.5f, y + quadSize * 1.5f);
+                        for (int j = 0; j < 4; ++j)
+                            predatorQuads[p * 4 + j].color = sf::Color(255, 60, 60);
+                    }
+                    window.draw(predatorQuads);
+                    #endif
                     window.draw(*boidsQuads);
                     window.display();
                     #endif
 
                     // ricopio il nuovo buffer nel vecchio per il prossimo time step
+                    #if shm_publish_on
+                    // pubblica il frame appena scritto dal motore, che diventa l'input del prossimo time step, e apre il successivo
+                    shmWriter.publish_frame(elapsedTimeSteps + 1);
+                    boids = new_boids;
+                    new_boids = shmWriter.begin_frame(numberOfAgents[ai]);
+                    #else
                     std::swap(boids, new_boids);
+                    #endif
+                    #if obstacles_on
+                    std::swap(predators, new_predators);
+                    #endif
 
                     // incremento time steps e stampa intervalli intermedi
                     elapsedTimeSteps++;
+                    #if trajectory_archive_on
+                    if (archiveRun && elapsedTimeSteps % trajectory_archive_interval == 0)
+                        archive.push(boids, elapsedTimeSteps);
+                    #endif
                     if (elapsedTimeSteps % 50 == 0)
                         std::cout << "Time steps: " << elapsedTimeSteps << std::endl;
                 }
 
-                // dealloca gli array per evitare memory leaks
+                // dealloca gli array per evitare memory leaks (i frame condivisi restano al writer)
+                #if !shm_publish_on
                 delete[] boids.x;
                 delete[] boids.y;
                 delete[] boids.vx;
@@ -181,6 +571,14 @@ int main(int argc, char* argv[])
                 delete[] new_boids.y;
                 delete[] new_boids.vx;
                 delete[] new_boids.vy;
+                #endif
+                #if species_on
+                delete[] bias;
+                delete[] new_bias;
+                #elif obstacles_on
+                for (float* buffer : {predators.x, predators.y, predators.vx, predators.vy, new_predators.x, new_predators.y, new_predators.vx, new_predators.vy})
+                    delete[] buffer;
+                #endif
                 #if visuals_on
                 delete boidsQuads;
                 #endif
@@ -188,7 +586,52 @@ int main(int argc, char* argv[])
                 // stampa della misurazione ottenuta a schermo
                 std::cout << "Simulazione terminata dopo " << elapsedTimeSteps << " time steps." << std::endl;
                 std::cout << "Tempo di esecuzione per simulazione boids: " << totalSimulationTime / 1000000 << " secondi." << std::endl;
+                #if incremental_grid_on
+                std::cout << "Griglia incrementale: " << grid.migrationsApplied << " spostamenti applicati, " << grid.rebuilds << " ricostruzioni." << std::endl;
+                #elif approx_far_field_on
+                std::cout << "Vicini contati tramite aggregati: " << 100.0 * approxStats.aggregatedBoids / std::max(1LL, approxStats.aggregatedBoids + approxStats.exactCandidates)
+                          << "% (tolleranza " << approxStats.farTolerance << ")." << std::endl;
+                #elif obstacles_on
+                const double boidSteps = std::max(1.0, static_cast<double>(numberOfAgents[ai]) * elapsedTimeSteps);
+                std::cout << "Ostacoli controllati per boid: " << hazardStats.obstacleChecks / boidSteps << " (su " << num_obstacles << "), predatori: " << hazardStats.predatorChecks / boidSteps << "." << std::endl;
+                #elif analytics_on
+                // costo delle statistiche separato dal tempo di simulazione (che lo include)
+                std::cout << "Statistiche: " << analytics.samples << " campioni in " << analytics.analyticsSeconds << " secondi ("
+                          << 100.0 * analytics.analyticsSeconds / std::max(1e-9, totalSimulationTime / 1000000.0) << "% del tempo di simulazione), ultimo campione: polarizzazione "
+                          << analytics.polarization << ", " << analytics.numClusters << " gruppi (il più grande di " << analytics.largestCluster << " boids)." << std::endl;
+                #elif autotune_on
+                // il tempo di simulazione include i time step di calibrazione
+                std::cout << "Auto-tuning: " << describe_tuning_config(tuner.config()) << " (" << tuner.calibrations << " calibrazioni, "
+                          << tuner.tuningSteps << " time step di calibrazione, " << tuner.cacheHits << " configurazioni dal file)." << std::endl;
+                logFile << "Configurazione per " << numberOfAgents[ai] << " boids con al massimo " << numberOfThreads[ti] << " threads (run " << (ri + 1) << "): "
+                        << describe_tuning_config(tuner.config()) << std::endl;
+                #endif
                 simulationTimes[ti][ai][ri] = totalSimulationTime / 1000000;
+
+                #if perf_counters_on
+                // metriche hardware per fase accanto ai tempi
+                const long long boidSteps = static_cast<long long>(numberOfAgents[ai]) * elapsedTimeSteps;
+                perf_report(std::cout, boidSteps);
+                logFile << "Contatori per " << numberOfAgents[ai] << " boids con " << numberOfThreads[ti] << " threads (run " << (ri + 1) << "):" << std::endl;
+                perf_report(logFile, boidSteps);
+                #endif
+
+                #if alloc_tracking_on
+                // allocazioni per time step e memoria di picco di questa run
+                alloc_report(std::cout, numberOfAgents[ai]);
+                logFile << "Allocazioni per " << numberOfAgents[ai] << " boids con " << numberOfThreads[ti] << " threads (run " << (ri + 1) << "):" << std::endl;
+                alloc_report(logFile, numberOfAgents[ai]);
+                #endif
+
+                #if trajectory_archive_on
+                // attende gli ultimi frame in codifica e scrive l'indice dei keyframe
+                if (archiveRun && archive.close())
+                {
+                    archive.report(std::cout);
+                    logFile << "Archivio per " << numberOfAgents[ai] << " boids con " << numberOfThreads[ti] << " threads:" << std::endl;
+                    archive.report(logFile);
+                }
+                #endif
             }
         }
     }
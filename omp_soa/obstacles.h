@@ -0,0 +1,154 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+// ostacoli statici e predatori
+
+#define obstacle_margin 20.0f      // distanza dalla superficie di un ostacolo entro cui un boid inizia a evitarlo
+#define obstacle_turn_factor 3.0f  // spinta massima di un ostacolo (alla superficie), decresce linearmente fino al margine
+#define predator_range 40.0f       // distanza entro cui un boid fugge da un predatore (<= lato cella: bastano le 3x3 celle)
+#define predator_avoid_factor 0.05f
+#define predator_chase_factor 0.01f // attrazione di un predatore verso il centro dei boids che vede
+#define predator_min_speed 2.0f
+#define predator_max_speed 5.0f     // più lenti dei boids, che quindi riescono a sfuggire
+
+// i predatori usano la stessa struttura SoA dei boids (Boids), in un buffer separato e piccolo:
+// a ogni time step vengono riordinati in una SpatialGrid propria, allineata a quella dei boids
+
+// ogni ostacolo è una capsula (segmento con raggio): un cerchio è un segmento degenere, un muro un segmento con raggio piccolo,
+// così il kernel ha un solo calcolo di distanza e nessun branch sul tipo di ostacolo
+struct ObstacleCapsule {
+    float ax, ay; // primo estremo
+    float bx, by; // secondo estremo (uguale al primo per i cerchi)
+    float radius;
+};
+
+inline ObstacleCapsule make_circle_obstacle(float x, float y, float radius)
+{
+    return ObstacleCapsule{x, y, x, y, radius};
+}
+
+inline ObstacleCapsule make_segment_obstacle(float x0, float y0, float x1, float y1, float thickness)
+{
+    return ObstacleCapsule{x0, y0, x1, y1, 0.5f * thickness};
+}
+
+// punto della capsula più vicino a (x, y) sull'asse del segmento; restituisce la distanza dall'asse
+inline float capsule_axis_distance(const ObstacleCapsule& c, float x, float y, float& dx, float& dy)
+{
+    const float ux = c.bx - c.ax;
+    const float uy = c.by - c.ay;
+    const float lengthSquared = ux * ux + uy * uy;
+    const float t = lengthSquared > 0.0f ? std::clamp(((x - c.ax) * ux + (y - c.ay) * uy) / lengthSquared, 0.0f, 1.0f) : 0.0f;
+    dx = x - (c.ax + t * ux);
+    dy = y - (c.ay + t * uy);
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+// ostacoli "cotti" una volta sola in una struttura CSR con le stesse celle di SpatialGrid (stesso lato e stessa origine):
+// ogni cella contiene una copia contigua delle capsule che, allargate di influence, la toccano, quindi un boid controlla
+// solo gli ostacoli della propria cella e il costo dipende dalla densità locale di ostacoli, non dal loro numero totale
+class ObstacleGrid
+{
+public:
+    std::vector<int> cellStart;            // numCells + 1 elementi
+    std::vector<ObstacleCapsule> cellItems; // capsule ordinate per cella (un ostacolo compare in ogni cella che tocca)
+
+    // costruisce la struttura (seriale, da chiamare una volta sola quando cambiano gli ostacoli)
+    void bake(const std::vector<ObstacleCapsule>& obstacles, float cellSize, int worldWidth, int worldHeight, float influence)
+    {
+        this->cellSize = cellSize;
+        gridWidth  = static_cast<int>(std::ceil(worldWidth  / cellSize));
+        gridHeight = static_cast<int>(std::ceil(worldHeight / cellSize));
+        const int numCells = gridWidth * gridHeight;
+
+        // due passate: conteggio per cella, poi copia delle capsule nelle posizioni della prefix sum
+        cellStart.assign(numCells + 1, 0);
+        for (int pass = 0; pass < 2; ++pass) {
+            std::vector<int> cursor(cellStart.begin(), cellStart.end() - 1);
+            for (const ObstacleCapsule& c : obstacles) {
+                const float reach = c.radius + influence;
+                const int cx0 = std::clamp(static_cast<int>(std::floor((std::min(c.ax, c.bx) - reach) / cellSize)), 0, gridWidth - 1);
+                const int cx1 = std::clamp(static_cast<int>(std::floor((std::max(c.ax, c.bx) + reach) / cellSize)), 0, gridWidth - 1);
+                const int cy0 = std::clamp(static_cast<int>(std::floor((std::min(c.ay, c.by) - reach) / cellSize)), 0, gridHeight - 1);
+                const int cy1 = std::clamp(static_cast<int>(std::floor((std::max(c.ay, c.by) + reach) / cellSize)), 0, gridHeight - 1);
+
+                for (int cy = cy0; cy <= cy1; ++cy) {
+                    for (int cx = cx0; cx <= cx1; ++cx) {
+                        // scarta le celle del bounding box troppo lontane dall'asse (segmenti lunghi in diagonale),
+                        // confrontando la distanza dal centro della cella con reach più mezza diagonale; le celle di bordo
+                        // non vengono scartate perché contengono anche i boids usciti dal mondo
+                        const bool border = cx == 0 || cy == 0 || cx == gridWidth - 1 || cy == gridHeight - 1;
+                        float dx, dy;
+                        if (!border && capsule_axis_distance(c, (cx + 0.5f) * cellSize, (cy + 0.5f) * cellSize, dx, dy) > reach + 0.70711f * cellSize)
+                            continue;
+
+                        const int cell = cy * gridWidth + cx;
+                        if (pass == 0)
+                            cellStart[cell + 1]++;
+                        else
+                            cellItems[cursor[cell]++] = c;
+                    }
+                }
+            }
+
+            if (pass == 0) {
+                for (int cell = 0; cell < numCells; ++cell)
+                    cellStart[cell + 1] += cellStart[cell];
+                cellItems.resize(cellStart[numCells]);
+            }
+        }
+    }
+
+    // cella di una posizione (stessa trasformazione di SpatialGrid: i boids fuori dal mondo finiscono nelle celle di bordo)
+    inline int cell_of(float x, float y) const
+    {
+        const int cx = std::clamp(static_cast<int>(std::floor(x / cellSize)), 0, gridWidth  - 1);
+        const int cy = std::clamp(static_cast<int>(std::floor(y / cellSize)), 0, gridHeight - 1);
+        return cy * gridWidth + cx;
+    }
+
+    // capsule che possono influenzare un boid nella cella
+    const ObstacleCapsule* cell_begin(int cell) const
+    {
+        return cellItems.data() + cellStart[cell];
+    }
+
+    const ObstacleCapsule* cell_end(int cell) const
+    {
+        return cellItems.data() + cellStart[cell + 1];
+    }
+
+private:
+    float cellSize = 1.0f;
+    int gridWidth = 0;
+    int gridHeight = 0;
+};
+
+// campo di ostacoli sparsi per driver e benchmark: 90% cerchi piccoli, 10% muri sottili orientati a caso (seed fisso)
+inline std::vector<ObstacleCapsule> make_obstacle_field(int worldWidth, int worldHeight, int numObstacles, unsigned seed = 7)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> ux(0.0f, static_cast<float>(worldWidth));
+    std::uniform_real_distribution<float> uy(0.0f, static_cast<float>(worldHeight));
+    std::uniform_real_distribution<float> radius(3.0f, 10.0f);
+    std::uniform_real_distribution<float> length(40.0f, 160.0f);
+    std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+
+    std::vector<ObstacleCapsule> obstacles(numObstacles);
+    for (int k = 0; k < numObstacles; ++k) {
+        const float x = ux(rng);
+        const float y = uy(rng);
+        if (k % 10 == 9) {
+            const float l = length(rng);
+            const float a = angle(rng);
+            obstacles[k] = make_segment_obstacle(x, y, x + l * std::cos(a), y + l * std::sin(a), 4.0f);
+        } else {
+            obstacles[k] = make_circle_obstacle(x, y, radius(rng));
+        }
+    }
+    return obstacles;
+}
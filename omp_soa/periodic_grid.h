@@ -0,0 +1,135 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h> // for OpenMP library functions
+#endif
+
+#include "spatial_grid.h"
+
+// griglia per il mondo toroidale: le celle coprono esattamente il mondo (lato >= cellSize, così lo stencil 3x3 basta),
+// lo stencil di ogni cella si richiude sui bordi opposti ed è precalcolato in una tabella (nessun modulo per query);
+// con meno di 3 celle per lato le celle ripetute vengono tolte dalla tabella, quindi nessun boid è visitato due volte
+
+#define periodic_stencil_size 9
+
+class PeriodicGrid
+{
+public:
+    std::vector<int> boidIndices;    // indici dei boids ordinati per cella
+    std::vector<int> cellStart;      // inizio di ogni cella in boidIndices (numCells + 1 elementi)
+    std::vector<int> neighborCells;  // stencil di ogni cella, periodic_stencil_size elementi per cella
+    std::vector<int> neighborCount;  // celle distinte dello stencil
+
+    int gridWidth = 0;
+    int gridHeight = 0;
+
+    // dimensiona griglia e tabella (nessuna allocazione né ricalcolo se le dimensioni non cambiano)
+    void resize(float minCellSize, int worldWidth, int worldHeight, int numBoids)
+    {
+        const int newWidth = std::max(1, static_cast<int>(worldWidth / minCellSize));
+        const int newHeight = std::max(1, static_cast<int>(worldHeight / minCellSize));
+        cellOf.resize(numBoids);
+        boidIndices.resize(numBoids);
+        if (newWidth == gridWidth && newHeight == gridHeight && cellWidth == static_cast<float>(worldWidth) / newWidth
+            && cellHeight == static_cast<float>(worldHeight) / newHeight)
+            return;
+
+        gridWidth = newWidth;
+        gridHeight = newHeight;
+        cellWidth = static_cast<float>(worldWidth) / gridWidth;
+        cellHeight = static_cast<float>(worldHeight) / gridHeight;
+
+        const int numCells = gridWidth * gridHeight;
+        cellStart.resize(numCells + 1);
+        neighborCells.resize(numCells * periodic_stencil_size);
+        neighborCount.resize(numCells);
+
+        // tabella dello stencil con i modulo calcolati una volta sola
+        for (int cy = 0; cy < gridHeight; ++cy) {
+            for (int cx = 0; cx < gridWidth; ++cx) {
+                const int cell = cy * gridWidth + cx;
+                int* stencil = &neighborCells[cell * periodic_stencil_size];
+                int count = 0;
+                for (int dy = -1; dy <= 1; ++dy) {
+                    for (int dx = -1; dx <= 1; ++dx) {
+                        const int neighbor = ((cy + dy + gridHeight) % gridHeight) * gridWidth + (cx + dx + gridWidth) % gridWidth;
+                        if (std::find(stencil, stencil + count, neighbor) == stencil + count)
+                            stencil[count++] = neighbor;
+                    }
+                }
+                neighborCount[cell] = count;
+            }
+        }
+    }
+
+    // ordina i boids per cella (da chiamare dentro una regione parallela, usa worksharing orfano):
+    // conteggi privati per thread e scrittura nello stesso ordine statico, quindi nessuna race e risultato deterministico
+    void build(const float* x, const float* y, int numBoids)
+    {
+        const int numCells = gridWidth * gridHeight;
+        #ifdef _OPENMP
+        const int numThreads = omp_get_num_threads();
+        const int thread = omp_get_thread_num();
+        #else
+        const int numThreads = 1;
+        const int thread = 0;
+        #endif
+
+        #pragma omp single
+        threadCellCount.assign(numThreads * numCells, 0);
+
+        int* count = &threadCellCount[thread * numCells];
+        #pragma omp for schedule(static)
+        for (int i = 0; i < numBoids; ++i) {
+            cellOf[i] = world_to_cell(x[i], y[i]);
+            count[cellOf[i]]++;
+        }
+
+        // prefix sum per (cella, thread): ogni thread riceve il proprio cursore in ogni cella
+        #pragma omp single
+        {
+            int offset = 0;
+            for (int c = 0; c < numCells; ++c) {
+                cellStart[c] = offset;
+                for (int t = 0; t < numThreads; ++t) {
+                    const int cellCount = threadCellCount[t * numCells + c];
+                    threadCellCount[t * numCells + c] = offset;
+                    offset += cellCount;
+                }
+            }
+            cellStart[numCells] = offset;
+        }
+
+        #pragma omp for schedule(static)
+        for (int i = 0; i < numBoids; ++i)
+            boidIndices[count[cellOf[i]]++] = i;
+    }
+
+    // visita le celle distinte dello stencil periodico della posizione (x, y)
+    template <typename Visit>
+    void query(float x, float y, Visit visit) const
+    {
+        const int cell = world_to_cell(x, y);
+        const int* stencil = &neighborCells[cell * periodic_stencil_size];
+        for (int k = 0; k < neighborCount[cell]; ++k)
+            visit(NeighborRange{&boidIndices[cellStart[stencil[k]]], &boidIndices[cellStart[stencil[k] + 1]]});
+    }
+
+private:
+    float cellWidth = 0.0f;
+    float cellHeight = 0.0f;
+    std::vector<int> cellOf;
+    std::vector<int> threadCellCount; // (thread, cella) -> conteggio, poi cursore di scrittura
+
+    // cella 1d di una posizione già riportata nel mondo (il clamp copre solo gli arrotondamenti su x == worldWidth)
+    inline int world_to_cell(float x, float y) const
+    {
+        const int cx = std::clamp(static_cast<int>(x / cellWidth), 0, gridWidth - 1);
+        const int cy = std::clamp(static_cast<int>(y / cellHeight), 0, gridHeight - 1);
+        return cy * gridWidth + cx;
+    }
+};
@@ -0,0 +1,237 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h> // for OpenMP library functions
+#endif
+
+#include "spatial_grid.h"
+
+// quadtree lineare costruito dai boids ordinati per codice di Morton: ogni nodo è un intervallo contiguo dell'ordinamento,
+// le foglie contengono al più quadtree_leaf_size boids, quindi la profondità si adatta alla densità locale
+// (un gruppo molto denso viene suddiviso finché le foglie sono piccole, le zone vuote non occupano nodi)
+
+#define quadtree_leaf_size 32
+#define quadtree_morton_bits 16 // bit per asse del codice di Morton (profondità massima)
+#define quadtree_radix_bits 8   // bit per passata del radix sort
+
+struct QuadtreeNode {
+    float minX, minY, maxX, maxY; // bounding box dei boids contenuti
+    int begin, end;               // intervallo in boidIndices
+    int firstChild;               // primo figlio (i figli sono consecutivi), -1 per le foglie
+    int childCount;
+};
+
+class LinearQuadtree
+{
+public:
+    // dimensiona le strutture (nessuna allocazione se le dimensioni non cambiano)
+    void resize(float queryRadius, int worldWidth, int worldHeight, int numBoids)
+    {
+        this->queryRadius = queryRadius;
+        this->numBoids = numBoids;
+        scaleX = static_cast<float>(1 << quadtree_morton_bits) / worldWidth;
+        scaleY = static_cast<float>(1 << quadtree_morton_bits) / worldHeight;
+
+        codes.resize(numBoids);
+        codesTmp.resize(numBoids);
+        boidIndices.resize(numBoids);
+        indicesTmp.resize(numBoids);
+    }
+
+    // costruzione parallela a partire dalle posizioni (da chiamare dentro una regione parallela, usa worksharing orfano)
+    void build(const float* x, const float* y)
+    {
+        // codici di Morton
+        #pragma omp for schedule(static)
+        for (int i = 0; i < numBoids; ++i) {
+            codes[i] = morton_code(x[i], y[i]);
+            boidIndices[i] = i;
+        }
+
+        // radix sort LSD stabile con istogrammi privati per thread (numero pari di passate: il risultato torna in codes)
+        for (int shift = 0; shift < 2 * quadtree_morton_bits; shift += quadtree_radix_bits) {
+            const bool even = (shift / quadtree_radix_bits) % 2 == 0;
+            radix_pass(even ? codes : codesTmp, even ? boidIndices : indicesTmp, even ? codesTmp : codes, even ? indicesTmp : boidIndices, shift);
+        }
+
+        // nodi in pre-ordine (seriale, O(numero di nodi) ricerche binarie sui codici ordinati)
+        #pragma omp single
+        {
+            nodes.clear();
+            leaves.clear();
+            nodes.push_back(QuadtreeNode{INFINITY, INFINITY, -INFINITY, -INFINITY, 0, numBoids, -1, 0});
+            split(0, 0);
+        }
+
+        // bounding box delle foglie
+        #pragma omp for schedule(static)
+        for (int l = 0; l < static_cast<int>(leaves.size()); ++l) {
+            QuadtreeNode& leaf = nodes[leaves[l]];
+            for (int k = leaf.begin; k < leaf.end; ++k) {
+                const int j = boidIndices[k];
+                leaf.minX = std::min(leaf.minX, x[j]);
+                leaf.minY = std::min(leaf.minY, y[j]);
+                leaf.maxX = std::max(leaf.maxX, x[j]);
+                leaf.maxY = std::max(leaf.maxY, y[j]);
+            }
+        }
+
+        // bounding box dei nodi interni, dal basso verso l'alto (i figli seguono sempre il padre)
+        #pragma omp single
+        for (int n = static_cast<int>(nodes.size()) - 1; n >= 0; --n) {
+            QuadtreeNode& node = nodes[n];
+            for (int c = node.firstChild; c >= 0 && c < node.firstChild + node.childCount; ++c) {
+                node.minX = std::min(node.minX, nodes[c].minX);
+                node.minY = std::min(node.minY, nodes[c].minY);
+                node.maxX = std::max(node.maxX, nodes[c].maxX);
+                node.maxY = std::max(node.maxY, nodes[c].maxY);
+            }
+        }
+    }
+
+    // visita le foglie il cui bounding box dista meno di queryRadius da (x, y)
+    template <typename Visit>
+    void query(float x, float y, Visit visit) const
+    {
+        const float radiusSquared = queryRadius * queryRadius;
+
+        // pila esplicita: al più 3 fratelli in attesa per livello
+        int stack[4 * (quadtree_morton_bits + 1)];
+        int top = 0;
+        stack[top++] = 0;
+        while (top > 0) {
+            const QuadtreeNode& node = nodes[stack[--top]];
+
+            const float nearX = std::max(std::max(node.minX - x, x - node.maxX), 0.0f);
+            const float nearY = std::max(std::max(node.minY - y, y - node.maxY), 0.0f);
+            if (nearX * nearX + nearY * nearY >= radiusSquared)
+                continue;
+
+            if (node.firstChild < 0) {
+                visit(NeighborRange{&boidIndices[node.begin], &boidIndices[node.end]});
+            } else {
+                for (int c = node.firstChild + node.childCount - 1; c >= node.firstChild; --c)
+                    stack[top++] = c;
+            }
+        }
+    }
+
+    int node_count() const
+    {
+        return static_cast<int>(nodes.size());
+    }
+
+    int leaf_count() const
+    {
+        return static_cast<int>(leaves.size());
+    }
+
+private:
+    float queryRadius = 0.0f;
+    float scaleX = 0.0f;
+    float scaleY = 0.0f;
+    int numBoids = 0;
+
+    std::vector<uint32_t> codes;
+    std::vector<uint32_t> codesTmp;
+    std::vector<int> boidIndices;
+    std::vector<int> indicesTmp;
+    std::vector<int> threadHistogram; // (thread, cifra) -> conteggio, poi cursore di scrittura
+    std::vector<QuadtreeNode> nodes;
+    std::vector<int> leaves;
+
+    // distribuisce i bit di v sulle posizioni pari
+    static inline uint32_t spread_bits(uint32_t v)
+    {
+        v &= 0x0000FFFF;
+        v = (v | (v << 8)) & 0x00FF00FF;
+        v = (v | (v << 4)) & 0x0F0F0F0F;
+        v = (v | (v << 2)) & 0x33333333;
+        v = (v | (v << 1)) & 0x55555555;
+        return v;
+    }
+
+    // codice di Morton della posizione (i boids fuori dal mondo finiscono sul bordo, i bounding box restano esatti)
+    inline uint32_t morton_code(float x, float y) const
+    {
+        const int maxCoord = (1 << quadtree_morton_bits) - 1;
+        const uint32_t qx = static_cast<uint32_t>(std::clamp(static_cast<int>(x * scaleX), 0, maxCoord));
+        const uint32_t qy = static_cast<uint32_t>(std::clamp(static_cast<int>(y * scaleY), 0, maxCoord));
+        return spread_bits(qx) | (spread_bits(qy) << 1);
+    }
+
+    // una passata del radix sort: ogni thread conta e poi scrive il proprio blocco statico, quindi l'ordinamento è stabile
+    void radix_pass(const std::vector<uint32_t>& srcCodes, const std::vector<int>& srcIndices,
+                    std::vector<uint32_t>& dstCodes, std::vector<int>& dstIndices, int shift)
+    {
+        const int buckets = 1 << quadtree_radix_bits;
+        #ifdef _OPENMP
+        const int numThreads = omp_get_num_threads();
+        const int thread = omp_get_thread_num();
+        #else
+        const int numThreads = 1;
+        const int thread = 0;
+        #endif
+
+        #pragma omp single
+        threadHistogram.assign(numThreads * buckets, 0);
+
+        int* histogram = &threadHistogram[thread * buckets];
+        #pragma omp for schedule(static)
+        for (int i = 0; i < numBoids; ++i)
+            histogram[(srcCodes[i] >> shift) & (buckets - 1)]++;
+
+        #pragma omp single
+        {
+            int offset = 0;
+            for (int b = 0; b < buckets; ++b) {
+                for (int t = 0; t < numThreads; ++t) {
+                    const int count = threadHistogram[t * buckets + b];
+                    threadHistogram[t * buckets + b] = offset;
+                    offset += count;
+                }
+            }
+        }
+
+        #pragma omp for schedule(static)
+        for (int i = 0; i < numBoids; ++i) {
+            const int slot = histogram[(srcCodes[i] >> shift) & (buckets - 1)]++;
+            dstCodes[slot] = srcCodes[i];
+            dstIndices[slot] = srcIndices[i];
+        }
+    }
+
+    // suddivide il nodo in base ai 2 bit del livello successivo (i figli vuoti non vengono creati)
+    void split(int nodeIndex, int level)
+    {
+        const int begin = nodes[nodeIndex].begin;
+        const int end = nodes[nodeIndex].end;
+        if (end - begin <= quadtree_leaf_size || level == quadtree_morton_bits) {
+            leaves.push_back(nodeIndex);
+            return;
+        }
+
+        const int shift = 2 * (quadtree_morton_bits - 1 - level);
+        const int firstChild = static_cast<int>(nodes.size());
+        int childBegin = begin;
+        for (uint32_t quadrant = 0; quadrant < 4; ++quadrant) {
+            // primo boid con quadrante successivo (i codici dell'intervallo condividono il prefisso fino a questo livello)
+            const int childEnd = static_cast<int>(std::partition_point(codes.begin() + childBegin, codes.begin() + end,
+                [&](uint32_t code) { return ((code >> shift) & 3u) <= quadrant; }) - codes.begin());
+            if (childEnd > childBegin)
+                nodes.push_back(QuadtreeNode{INFINITY, INFINITY, -INFINITY, -INFINITY, childBegin, childEnd, -1, 0});
+            childBegin = childEnd;
+        }
+        nodes[nodeIndex].firstChild = firstChild;
+        nodes[nodeIndex].childCount = static_cast<int>(nodes.size()) - firstChild;
+
+        // i figli vengono suddivisi dopo essere stati creati tutti, così restano consecutivi
+        for (int c = firstChild; c < nodes[nodeIndex].firstChild + nodes[nodeIndex].childCount; ++c)
+            split(c, level + 1);
+    }
+};
@@ -0,0 +1,274 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "boids_omp_soa.h"
+
+// pubblicazione dello stato SoA in un ring di frame in memoria condivisa POSIX, letto da altri processi (visualizzatori, analisi)
+// - il motore scrive direttamente nel frame successivo del ring (new_boids punta dentro il segmento, nessuna copia)
+// - ogni frame ha un contatore di sequenza (seqlock): dispari durante la scrittura, pari quando il frame è stabile;
+//   i lettori copiano il frame e lo scartano se la sequenza è cambiata nel frattempo, quindi non bloccano mai il writer
+// - il frame precedente (input del time step corrente) resta stabile per numFrames - 1 time step
+
+#define shm_frames_name "/boids_frames"
+#define shm_frames_count 4          // frame nel ring (almeno 2: input e output del time step)
+#define shm_frames_magic 0x424f4944u // "BOID"
+#define shm_frames_version 1u
+#define shm_frames_max_retries 64   // tentativi di copia di un lettore prima di rinunciare
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "i contatori condivisi fra processi devono essere lock-free");
+
+// intestazione del segmento
+struct alignas(64) ShmRingHeader {
+    std::atomic<uint32_t> magic;  // scritto per ultimo (release): chi lo legge (acquire) vede il resto dell'intestazione
+    uint32_t version;
+    int32_t numFrames;
+    int32_t capacity; // boids massimi per frame
+    int32_t worldWidth;
+    int32_t worldHeight;
+    uint64_t frameBytes;
+    std::atomic<uint64_t> latest; // generazione dell'ultimo frame pubblicato (0 = nessuno)
+    std::atomic<uint32_t> closed; // 1 quando il writer ha terminato
+};
+
+// intestazione di un frame, seguita dagli array x, y, vx, vy di capacity elementi (ognuno allineato a 64 byte)
+struct alignas(64) ShmFrameHeader {
+    std::atomic<uint64_t> sequence; // pari: frame stabile, dispari: in scrittura
+    uint64_t generation;            // numero progressivo del frame (la generazione g occupa lo slot g % numFrames)
+    int64_t step;                   // time step della simulazione
+    int32_t count;                  // boids nel frame
+};
+
+inline size_t shm_array_bytes(int capacity)
+{
+    return (static_cast<size_t>(capacity) * sizeof(float) + 63) / 64 * 64;
+}
+
+inline size_t shm_frame_bytes(int capacity)
+{
+    return sizeof(ShmFrameHeader) + 4 * shm_array_bytes(capacity);
+}
+
+// vista Boids sugli array di un frame
+inline Boids shm_frame_boids(ShmFrameHeader* frame, int capacity, int count)
+{
+    char* arrays = reinterpret_cast<char*>(frame) + sizeof(ShmFrameHeader);
+    const size_t stride = shm_array_bytes(capacity);
+    return Boids{
+        .x = reinterpret_cast<float*>(arrays),
+        .y = reinterpret_cast<float*>(arrays + stride),
+        .vx = reinterpret_cast<float*>(arrays + 2 * stride),
+        .vy = reinterpret_cast<float*>(arrays + 3 * stride),
+        .count = count,
+    };
+}
+
+// lato simulazione: crea il segmento e pubblica un frame per time step
+class ShmFrameWriter
+{
+public:
+    ~ShmFrameWriter()
+    {
+        close();
+    }
+
+    // crea (o ricrea) il segmento per frame di al massimo capacity boids
+    bool open(const char* name, int capacity, int worldWidth, int worldHeight, int numFrames = shm_frames_count)
+    {
+        close();
+        segmentName = name;
+        bytes = sizeof(ShmRingHeader) + static_cast<size_t>(numFrames) * shm_frame_bytes(capacity);
+
+        const int fd = shm_open(name, O_CREAT | O_RDWR | O_TRUNC, 0644);
+        if (fd < 0 || ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+            std::cerr << "Error creating shared memory segment " << name << "." << std::endl;
+            if (fd >= 0)
+                ::close(fd);
+            return false;
+        }
+        void* mapped = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED) {
+            std::cerr << "Error mapping shared memory segment " << name << "." << std::endl;
+            shm_unlink(name);
+            return false;
+        }
+
+        // il segmento appena troncato è azzerato: tutti i frame partono con sequenza 0 (stabili, mai pubblicati)
+        base = static_cast<char*>(mapped);
+        ring = reinterpret_cast<ShmRingHeader*>(base);
+        ring->version = shm_frames_version;
+        ring->numFrames = numFrames;
+        ring->capacity = capacity;
+        ring->worldWidth = worldWidth;
+        ring->worldHeight = worldHeight;
+        ring->frameBytes = shm_frame_bytes(capacity);
+        ring->latest.store(0, std::memory_order_relaxed);
+        ring->closed.store(0, std::memory_order_relaxed);
+        // magic per ultimo: un lettore che lo vede trova un'intestazione completa
+        ring->magic.store(shm_frames_magic, std::memory_order_release);
+        generation = 0;
+        return true;
+    }
+
+    // apre il frame successivo del ring e lo restituisce come Boids, su cui il motore scrive direttamente
+    // (lo slot è diverso da quello dell'ultimo frame pubblicato, che resta l'input del time step)
+    Boids begin_frame(int count)
+    {
+        current = frame_at((generation + 1) % ring->numFrames);
+        const uint64_t sequence = current->sequence.load(std::memory_order_relaxed);
+        // sequenza dispari: i lettori che stanno copiando questo slot scarteranno la copia
+        current->sequence.store(sequence | 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        current->count = count;
+        return shm_frame_boids(current, ring->capacity, count);
+    }
+
+    // rende visibile ai lettori il frame aperto con begin_frame (da chiamare dopo la regione parallela del time step)
+    void publish_frame(long long step)
+    {
+        generation++;
+        current->generation = generation;
+        current->step = step;
+        current->sequence.store((current->sequence.load(std::memory_order_relaxed) | 1) + 1, std::memory_order_release);
+        ring->latest.store(generation, std::memory_order_release);
+    }
+
+    // segnala la fine ai lettori e rimuove il segmento (i lettori già collegati lo vedono finché non lo chiudono)
+    void close()
+    {
+        if (!base)
+            return;
+        ring->closed.store(1, std::memory_order_release);
+        munmap(base, bytes);
+        shm_unlink(segmentName.c_str());
+        base = nullptr;
+        ring = nullptr;
+    }
+
+private:
+    std::string segmentName;
+    char* base = nullptr;
+    size_t bytes = 0;
+    ShmRingHeader* ring = nullptr;
+    ShmFrameHeader* current = nullptr;
+    uint64_t generation = 0;
+
+    ShmFrameHeader* frame_at(int slot) const
+    {
+        return reinterpret_cast<ShmFrameHeader*>(base + sizeof(ShmRingHeader) + static_cast<size_t>(slot) * ring->frameBytes);
+    }
+};
+
+// copia di un frame nel processo lettore
+struct ShmFrameCopy {
+    uint64_t generation = 0;
+    long long step = 0;
+    int count = 0;
+    std::vector<float> x, y, vx, vy;
+};
+
+// lato lettore: mappa il segmento in sola lettura e copia l'ultimo frame stabile
+class ShmFrameReader
+{
+public:
+    ~ShmFrameReader()
+    {
+        if (base)
+            munmap(const_cast<char*>(base), bytes);
+    }
+
+    // false se il segmento non esiste (ancora) o non è un ring di frame valido
+    bool open(const char* name)
+    {
+        if (base)
+            munmap(const_cast<char*>(base), bytes);
+        base = nullptr;
+        const int fd = shm_open(name, O_RDONLY, 0);
+        if (fd < 0)
+            return false;
+        const off_t size = lseek(fd, 0, SEEK_END);
+        void* mapped = size >= static_cast<off_t>(sizeof(ShmRingHeader)) ? mmap(nullptr, static_cast<size_t>(size), PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+        ::close(fd);
+        if (mapped == MAP_FAILED)
+            return false;
+
+        base = static_cast<const char*>(mapped);
+        bytes = static_cast<size_t>(size);
+        ring = reinterpret_cast<const ShmRingHeader*>(base);
+        // magic prima di ogni altro campo: se è valido l'intestazione scritta dal writer è visibile per intero
+        return ring->magic.load(std::memory_order_acquire) == shm_frames_magic && ring->version == shm_frames_version;
+    }
+
+    const ShmRingHeader& header() const
+    {
+        return *ring;
+    }
+
+    bool writer_closed() const
+    {
+        return ring->closed.load(std::memory_order_acquire) != 0;
+    }
+
+    // copia l'ultimo frame pubblicato se è più recente di out.generation (false altrimenti); se il writer lo sovrascrive
+    // durante la copia la copia viene ripetuta sul nuovo ultimo frame, retries conta i tentativi scartati
+    // (dopo shm_frames_max_retries tentativi rinuncia, ad esempio se il writer è terminato a metà di un frame)
+    bool read_latest(ShmFrameCopy& out, long long* retries = nullptr)
+    {
+        for (int attempt = 0; attempt < shm_frames_max_retries; ++attempt) {
+            const uint64_t latest = ring->latest.load(std::memory_order_acquire);
+            if (latest == 0 || latest <= out.generation)
+                return false;
+
+            const ShmFrameHeader* frame = frame_at(static_cast<int>(latest % ring->numFrames));
+            const uint64_t before = frame->sequence.load(std::memory_order_acquire);
+            if ((before & 1) == 0) {
+                const uint64_t generation = frame->generation;
+                const int64_t step = frame->step;
+                const int count = std::min(frame->count, ring->capacity);
+                const Boids arrays = shm_frame_boids(const_cast<ShmFrameHeader*>(frame), ring->capacity, count);
+                out.x.resize(count);
+                out.y.resize(count);
+                out.vx.resize(count);
+                out.vy.resize(count);
+                std::memcpy(out.x.data(), arrays.x, count * sizeof(float));
+                std::memcpy(out.y.data(), arrays.y, count * sizeof(float));
+                std::memcpy(out.vx.data(), arrays.vx, count * sizeof(float));
+                std::memcpy(out.vy.data(), arrays.vy, count * sizeof(float));
+
+                // la copia è valida solo se nessuna scrittura è iniziata nel frattempo
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (frame->sequence.load(std::memory_order_relaxed) == before && generation == latest) {
+                    out.generation = generation;
+                    out.step = step;
+                    out.count = count;
+                    return true;
+                }
+            }
+            if (retries)
+                (*retries)++;
+        }
+        return false;
+    }
+
+private:
+    const char* base = nullptr;
+    size_t bytes = 0;
+    const ShmRingHeader* ring = nullptr;
+
+    const ShmFrameHeader* frame_at(int slot) const
+    {
+        return reinterpret_cast<const ShmFrameHeader*>(base + sizeof(ShmRingHeader) + static_cast<size_t>(slot) * ring->frameBytes);
+    }
+};
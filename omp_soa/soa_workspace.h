@@ -0,0 +1,25 @@
+#pragma once
+
+#include <vector>
+
+#include "spatial_grid.h"
+#include "quadtree.h"
+#include "aggregate_grid.h"
+#include "periodic_grid.h"
+#include "task_grid.h"
+
+// strutture di appoggio dei motori SoA riusate fra i time step (nessuna allocazione a regime): appartengono al chiamante,
+// come IncrementalGrid, quindi due simulazioni (o due thread) con workspace distinti non condividono nulla; un workspace
+// va usato da una sola chiamata alla volta e per un solo stormo (la griglia a tile tiene le liste del time step precedente)
+struct SoaWorkspace {
+    SpatialGrid grid;            // update_all_boids, _species, _obstacles, _analytics, _fast, _configured
+    SpatialGrid predatorGrid;    // predatori di update_all_boids_obstacles
+    LinearQuadtree tree;         // update_all_boids con SPATIAL_INDEX_QUADTREE
+    TaskGrid taskGrid;           // update_all_boids_tasks
+    AggregateGrid aggregateGrid; // update_all_boids_approx
+    PeriodicGrid periodicGrid;   // update_all_boids_toroidal
+
+    // somme sui vicini per boid di update_all_boids_species (le specie le combinano prima di sterzare)
+    std::vector<float> sumXpos, sumYpos, sumXvel, sumYvel, sumCloseDx, sumCloseDy;
+    std::vector<int> sumNeighbors;
+};
@@ -1,8 +1,15 @@
 #pragma once
 
+#include <algorithm>
 #include <vector>
 #include <cmath>
 
+// mutazione per il controllo del validatore (solo PP_mid_assignment_omp_soa_border_mutant): le celle fuori griglia vengono
+// avvolte sul lato opposto invece di essere ridotte alle celle di bordo, così cambia soltanto la sorte dei boids fuori dal mondo
+#ifndef validation_border_mutation
+#define validation_border_mutation false
+#endif
+
 // Range leggero per iterare sugli indici dei boids
 struct NeighborRange {
     const int* beginPtr;
@@ -22,7 +29,16 @@ struct NeighborRange {
 class SpatialGrid
 {
 public:
+    SpatialGrid() = default;
+
     SpatialGrid(float cellSize, int worldWidth, int worldHeight, int maxBoids)
+    {
+        resize(cellSize, worldWidth, worldHeight, maxBoids);
+    }
+
+    // ridimensiona la griglia: i vettori allocano solo quando crescono, così una griglia riusata fra i time step
+    // non alloca più a regime
+    void resize(float cellSize, int worldWidth, int worldHeight, int maxBoids)
     {
         this->cellSize = cellSize;
         this->worldWidth = worldWidth;
@@ -38,34 +54,41 @@ public:
         boidIndices.resize(maxBoids);
     }
 
-    // svuota la griglia
-    void clear()
+    // svuota la griglia; nella costruzione parallela ogni thread ha una riga propria di contatori
+    // (un contatore condiviso per cella sarebbe una race fra i thread che inseriscono nella stessa cella)
+    void clear(int numThreads = 1)
     {
-        std::fill(cellCount.begin(), cellCount.end(), 0);
+        cellCount.assign(static_cast<size_t>(numThreads) * numCells, 0);
     }
 
-    // inserisci un boid (prima fase)
-    void insert(float x, float y)
+    // inserisci un boid (prima fase), contato nella riga del thread
+    void insert(float x, float y, int thread = 0)
     {
         int cell = world_to_cell(x, y);
-        cellCount[cell]++;
+        cellCount[thread * numCells + cell]++;
     }
 
-    // calcola il contenuto della griglia
-    void build()
+    // calcola il contenuto della griglia: prefix sum per (cella, thread), i contatori diventano i cursori di scrittura
+    // di ogni thread in ogni cella (con la stessa partizione statica nelle due fasi l'ordine è quello seriale)
+    void build(int numThreads = 1)
     {
-        cellStart[0] = 0;
-        for (int c = 0; c < numCells; ++c)
-            cellStart[c + 1] = cellStart[c] + cellCount[c];
-
-        std::fill(cellCount.begin(), cellCount.end(), 0);
+        int offset = 0;
+        for (int c = 0; c < numCells; ++c) {
+            cellStart[c] = offset;
+            for (int t = 0; t < numThreads; ++t) {
+                const int count = cellCount[t * numCells + c];
+                cellCount[t * numCells + c] = offset;
+                offset += count;
+            }
+        }
+        cellStart[numCells] = offset;
     }
 
-    // inserisci un boid (seconda fase)
-    void insert_index(int boidIndex, float x, float y)
+    // inserisci un boid (seconda fase), nell'intervallo riservato al thread
+    void insert_index(int boidIndex, float x, float y, int thread = 0)
     {
         int cell   = world_to_cell(x, y);
-        int offset = cellStart[cell] + cellCount[cell]++;
+        int offset = cellCount[thread * numCells + cell]++;
         boidIndices[offset] = boidIndex;
     }
 
@@ -79,6 +102,47 @@ public:
         };
     }
 
+    // dimensioni della griglia e contenuto di una cella per indice (per le analisi che scorrono le celle)
+    int num_cells() const
+    {
+        return numCells;
+    }
+
+    int grid_width() const
+    {
+        return gridWidth;
+    }
+
+    int grid_height() const
+    {
+        return gridHeight;
+    }
+
+    NeighborRange cell_content(int cell) const
+    {
+        return {
+            &boidIndices[cellStart[cell]],
+            &boidIndices[cellStart[cell + 1]]
+        };
+    }
+
+    // visita le celle che possono contenere vicini entro cellSize da (x, y): cella + 8 adiacenti, solo quelle dentro la griglia
+    // (le celle di bordo non vengono visitate due volte come con 9 campioni cell_content_at in world space)
+    template <typename Visit>
+    void query(float x, float y, Visit visit) const
+    {
+        const int cell = world_to_cell(x, y);
+        const int cx = cell % gridWidth;
+        const int cy = cell / gridWidth;
+
+        for (int ny = std::max(cy - 1, 0); ny <= std::min(cy + 1, gridHeight - 1); ++ny) {
+            for (int nx = std::max(cx - 1, 0); nx <= std::min(cx + 1, gridWidth - 1); ++nx) {
+                const int c = ny * gridWidth + nx;
+                visit(NeighborRange{&boidIndices[cellStart[c]], &boidIndices[cellStart[c + 1]]});
+            }
+        }
+    }
+
 private:
     float cellSize;
     int worldWidth;
@@ -89,7 +153,7 @@ private:
     int numCells;
     int maxBoids;
 
-    std::vector<int> cellCount;
+    std::vector<int> cellCount; // (thread, cella) -> conteggio, poi cursore di scrittura
     std::vector<int> cellStart;
     std::vector<int> boidIndices;
 
@@ -101,8 +165,13 @@ private:
         int cy = static_cast<int>(std::floor(y / cellSize));
 
         // clamp indici griglia
+        #if validation_border_mutation
+        cx = (cx % gridWidth  + gridWidth)  % gridWidth;
+        cy = (cy % gridHeight + gridHeight) % gridHeight;
+        #else
         cx = std::clamp(cx, 0, gridWidth  - 1);
         cy = std::clamp(cy, 0, gridHeight - 1);
+        #endif
 
         // flatten da 2d a 1d
         return cy * gridWidth + cx;
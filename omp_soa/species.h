@@ -0,0 +1,64 @@
+#pragma once
+
+// specie di boids con parametri propri e gruppi di esploratori (scout) con bias adattivo verso una direzione,
+// come nell'algoritmo di riferimento (https://vanhunteradams.com/Pico/Animal_Movement/Boids-algorithm.html)
+
+// i boids di una specie occupano un intervallo contiguo dello stato SoA (l'ordine non cambia fra i time step),
+// quindi il passo di integrazione gira su una specie alla volta con i parametri costanti nel ciclo:
+// le lane SIMD non mescolano mai parametri di specie diverse
+
+#define max_species 4
+#define max_bias 0.01f          // bias massimo di uno scout
+#define bias_increment 0.00004f // variazione del bias a ogni time step
+
+// parametri per specie (i raggi restano comuni perché determinano la dimensione delle celle della griglia)
+struct SpeciesParams {
+    float centeringFactor;
+    float matchingFactor;
+    float avoidFactor;
+    float turnFactor;
+    float minSpeed;
+    float maxSpeed;
+    float biasDirection; // +1 scout verso destra, -1 verso sinistra, 0 nessun bias
+};
+
+// tabella costante delle specie: stormo normale (gli stessi parametri di update_all_boids) e due gruppi di scout,
+// più veloci e meno legati allo stormo (coesione e allineamento più deboli), così si staccano davvero dal gruppo
+static constexpr SpeciesParams species_table[] = {
+    {0.002f, 0.05f, 0.025f, 0.4f, 3.0f, 6.0f, 0.0f},
+    {0.001f, 0.03f, 0.025f, 0.4f, 4.0f, 7.0f, 1.0f},
+    {0.001f, 0.03f, 0.025f, 0.4f, 4.0f, 7.0f, -1.0f},
+};
+
+// suddivisione dello stato in blocchi contigui, uno per specie
+struct SpeciesBlocks {
+    int numBlocks = 0;
+    int species[max_species];   // indice nella species_table del blocco
+    int start[max_species + 1]; // il blocco b occupa [start[b], start[b + 1])
+};
+
+// suddivisione di default: 80% stormo normale, 10% per ciascun gruppo di scout
+inline SpeciesBlocks make_default_species_blocks(int count)
+{
+    SpeciesBlocks blocks;
+    blocks.numBlocks = 3;
+    blocks.species[0] = 0;
+    blocks.species[1] = 1;
+    blocks.species[2] = 2;
+    blocks.start[0] = 0;
+    blocks.start[1] = count - 2 * (count / 10);
+    blocks.start[2] = count - count / 10;
+    blocks.start[3] = count;
+    return blocks;
+}
+
+// un solo blocco con la specie 0 (stesso modello di update_all_boids, utile per misurare il costo delle specie)
+inline SpeciesBlocks make_single_species_blocks(int count)
+{
+    SpeciesBlocks blocks;
+    blocks.numBlocks = 1;
+    blocks.species[0] = 0;
+    blocks.start[0] = 0;
+    blocks.start[1] = count;
+    return blocks;
+}
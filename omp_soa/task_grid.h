@@ -0,0 +1,163 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "boids_omp_soa.h"
+
+// griglia a tile del motore a task (boids_omp_soa_tasks.cpp): le liste per tile restano valide fra i time step consecutivi
+// dello stesso stormo, quindi ogni simulazione ne usa una propria (dentro SoaWorkspace)
+
+#define task_tile_cells 4
+
+// stato della griglia a tile riusato fra i time step
+struct TaskGrid {
+    float cellSize = 0.0f;
+    int gridWidth = 0, gridHeight = 0;
+    int tilesX = 0, tilesY = 0;
+    int numBoids = -1; // boids delle liste per tile (-1 = liste da seminare)
+
+    std::vector<int> cellOf;                 // cella di ogni boid
+    std::vector<std::vector<int>> tileBoids; // boids di ogni tile ordinati per cella (sorgenti del time step successivo)
+    std::vector<std::vector<int>> staged;    // boids di ogni tile sorgente raggruppati per direzione della tile di arrivo
+    std::vector<int> directionStart;         // 10 offset in staged per tile sorgente (9 direzioni)
+    std::vector<int> cellBegin;              // intervallo [cellBegin, cellEnd) di ogni cella nella lista della sua tile
+    std::vector<int> cellEnd;
+    std::vector<char> sourceToken;           // oggetti usati solo come dipendenze dei task
+    std::vector<char> tileToken;
+
+    void resize(float cellSize, int worldWidth, int worldHeight, int count)
+    {
+        const int width  = static_cast<int>(std::ceil(worldWidth  / cellSize));
+        const int height = static_cast<int>(std::ceil(worldHeight / cellSize));
+        if (cellSize != this->cellSize || width != gridWidth || height != gridHeight || count != numBoids)
+            numBoids = -1;
+        this->cellSize = cellSize;
+        gridWidth = width;
+        gridHeight = height;
+        tilesX = (gridWidth  + task_tile_cells - 1) / task_tile_cells;
+        tilesY = (gridHeight + task_tile_cells - 1) / task_tile_cells;
+
+        const int numTiles = tilesX * tilesY;
+        cellOf.resize(count);
+        tileBoids.resize(numTiles);
+        staged.resize(numTiles);
+        directionStart.resize(numTiles * 10);
+        cellBegin.resize(gridWidth * gridHeight);
+        cellEnd.resize(gridWidth * gridHeight);
+        sourceToken.resize(numTiles);
+        tileToken.resize(numTiles);
+    }
+
+    // cella 1d di una posizione (i boids fuori dal mondo finiscono nelle celle di bordo)
+    inline int world_to_cell(float x, float y) const
+    {
+        const int cx = std::clamp(static_cast<int>(std::floor(x / cellSize)), 0, gridWidth  - 1);
+        const int cy = std::clamp(static_cast<int>(std::floor(y / cellSize)), 0, gridHeight - 1);
+        return cy * gridWidth + cx;
+    }
+
+    inline int tile_of_cell(int cell) const
+    {
+        return (cell / gridWidth / task_tile_cells) * tilesX + (cell % gridWidth) / task_tile_cells;
+    }
+
+    // semina seriale: ogni boid nella lista della propria tile (le sorgenti del primo time step non hanno spostamenti)
+    void seed(const Boids& boids)
+    {
+        for (std::vector<int>& list : tileBoids)
+            list.clear();
+        for (int i = 0; i < boids.count; ++i)
+            tileBoids[tile_of_cell(world_to_cell(boids.x[i], boids.y[i]))].push_back(i);
+        numBoids = boids.count;
+    }
+
+    // classifica i boids della tile sorgente per direzione della tile di arrivo; false se un boid esce dalle 8 adiacenti
+    bool stage_source(int source, const Boids& boids)
+    {
+        const std::vector<int>& list = tileBoids[source];
+        const int sx = source % tilesX, sy = source / tilesX;
+        int* start = &directionStart[source * 10];
+        int count[9] = {0, 0, 0, 0, 0, 0, 0, 0, 0};
+        bool contained = true;
+
+        for (const int i : list) {
+            const int cell = world_to_cell(boids.x[i], boids.y[i]);
+            const int tile = tile_of_cell(cell);
+            const int dx = tile % tilesX - sx, dy = tile / tilesX - sy;
+            cellOf[i] = cell;
+            if (dx < -1 || dx > 1 || dy < -1 || dy > 1)
+                contained = false;
+            else
+                count[(dy + 1) * 3 + dx + 1]++;
+        }
+        if (!contained) {
+            std::fill(start, start + 10, 0); // nessun gruppo: le tile di arrivo non leggono dati incoerenti
+            return false;
+        }
+
+        start[0] = 0;
+        for (int d = 0; d < 9; ++d)
+            start[d + 1] = start[d] + count[d];
+        int cursor[9];
+        std::copy(start, start + 9, cursor);
+        staged[source].resize(list.size());
+        for (const int i : list) {
+            const int tile = tile_of_cell(cellOf[i]);
+            staged[source][cursor[(tile / tilesX - sy + 1) * 3 + tile % tilesX - sx + 1]++] = i;
+        }
+        return true;
+    }
+
+    // raccoglie dalle sorgenti intorno i boids arrivati nella tile e li ordina per cella (counting sort locale,
+    // scrive cellBegin / cellEnd delle sue celle)
+    void bin_tile(int tile)
+    {
+        const int tx = tile % tilesX, ty = tile / tilesX;
+        const int cx0 = tx * task_tile_cells, cx1 = std::min(cx0 + task_tile_cells, gridWidth);
+        const int cy0 = ty * task_tile_cells, cy1 = std::min(cy0 + task_tile_cells, gridHeight);
+
+        for (int cy = cy0; cy < cy1; ++cy)
+            for (int cx = cx0; cx < cx1; ++cx)
+                cellBegin[cy * gridWidth + cx] = 0;
+
+        // visita le sorgenti una volta sola (sul bordo del mondo alcune mancano), ognuna col gruppo diretto verso questa tile
+        auto for_each_arrival = [&](auto visit) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    if (tx + dx < 0 || tx + dx >= tilesX || ty + dy < 0 || ty + dy >= tilesY)
+                        continue;
+                    const int source = (ty + dy) * tilesX + tx + dx;
+                    const int direction = (1 - dy) * 3 + 1 - dx;
+                    const int* start = &directionStart[source * 10];
+                    for (int k = start[direction]; k < start[direction + 1]; ++k)
+                        visit(staged[source][k]);
+                }
+            }
+        };
+
+        int total = 0;
+        for_each_arrival([&](int i) {
+            cellBegin[cellOf[i]]++;
+            total++;
+        });
+
+        int offset = 0;
+        for (int cy = cy0; cy < cy1; ++cy) {
+            for (int cx = cx0; cx < cx1; ++cx) {
+                const int cell = cy * gridWidth + cx;
+                const int count = cellBegin[cell];
+                cellBegin[cell] = offset;
+                cellEnd[cell] = offset;
+                offset += count;
+            }
+        }
+
+        std::vector<int>& list = tileBoids[tile];
+        list.resize(total);
+        for_each_arrival([&](int i) {
+            list[cellEnd[cellOf[i]]++] = i;
+        });
+    }
+};
@@ -0,0 +1,779 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <zlib.h>
+
+#include "boids_omp_soa.h"
+
+// archivio compresso delle traiettorie: lo stato SoA di ogni frame archiviato, per simulazioni lunghe e analisi a posteriori
+// - posizioni e velocità quantizzate con un passo configurabile (errore massimo mezzo passo e nessuna deriva:
+//   le differenze sono calcolate fra valori già quantizzati)
+// - ogni frame è la differenza dal frame precedente, con i boids visitati per cella della griglia del frame precedente
+//   (che il decoder conosce già): boids vicini si spostano in modo simile, quindi per ogni campo si sceglie se scrivere
+//   le differenze temporali o la loro differenza con quella del boid precedente nell'ordine; lo spostamento delle
+//   posizioni è prima previsto dalla nuova velocità, resta solo l'errore di previsione
+// - interi zigzag in varint, poi deflate (zlib)
+// - un keyframe (valori assoluti in ordine di indice) ogni keyframeInterval frame, elencati nell'indice in coda al file
+//   per l'accesso casuale
+// - codifica in background: push quantizza il frame in uno slot di un ring (regione parallela OpenMP) e ritorna, i thread
+//   encoder codificano più frame in parallelo e li scrivono nel file in ordine
+//
+// file: ArchiveFileHeader, poi per ogni frame ArchiveFrameHeader e payload deflate, poi ArchiveIndexEntry[numKeyframes]
+// e ArchiveFooter; un archivio non chiuso (simulazione interrotta o ancora in corso) non ha indice ma resta leggibile
+// fino all'ultimo frame completo
+
+#define trajectory_archive_magic 0x41525442u // "BTRA"
+#define trajectory_frame_magic 0x4d415246u   // "FRAM"
+#define trajectory_index_magic 0x58444e49u   // "INDX"
+#define trajectory_archive_version 1u
+
+#define trajectory_position_step (1.0f / 64.0f) // passo di quantizzazione delle posizioni (pixel)
+#define trajectory_velocity_step (1.0f / 256.0f)
+#define trajectory_keyframe_interval 64
+#define trajectory_cell_size 32.0f // lato delle celle dell'ordinamento (pixel)
+#define trajectory_zlib_level 1    // Z_BEST_SPEED: il livello più alto guadagna poco sui varint e costa molto
+#define trajectory_encoder_threads 2
+#define trajectory_slots 8 // frame quantizzati nel ring (al massimo slots - 1 in codifica)
+
+struct TrajectoryArchiveOptions {
+    float positionStep = trajectory_position_step;
+    float velocityStep = trajectory_velocity_step;
+    int keyframeInterval = trajectory_keyframe_interval;
+    float cellSize = trajectory_cell_size;
+    int compressionLevel = trajectory_zlib_level;
+    int encoderThreads = trajectory_encoder_threads;
+    int slots = trajectory_slots;
+};
+
+struct ArchiveFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    int32_t count; // boids per frame (costante nell'archivio)
+    int32_t keyframeInterval;
+    float positionStep;
+    float velocityStep;
+    float cellSize;
+    int32_t worldWidth;
+    int32_t worldHeight;
+    uint32_t reserved;
+};
+
+struct ArchiveFrameHeader {
+    uint32_t magic;
+    uint32_t keyframe;
+    int64_t step;             // time step della simulazione
+    uint32_t rawBytes;        // payload prima di deflate
+    uint32_t compressedBytes; // payload nel file
+};
+
+struct ArchiveIndexEntry {
+    int64_t step;
+    uint64_t offset; // posizione dell'ArchiveFrameHeader del keyframe
+    uint64_t frame;  // numero progressivo del frame nell'archivio
+};
+
+struct ArchiveFooter {
+    uint64_t indexOffset;
+    uint64_t numFrames;
+    uint32_t numKeyframes;
+    uint32_t magic;
+};
+
+// frame quantizzato: campi x, y, vx, vy in unità del passo
+struct QuantizedFrame {
+    int64_t step = 0;
+    std::vector<int32_t> field[4];
+
+    void resize(int count)
+    {
+        for (std::vector<int32_t>& f : field)
+            f.resize(count);
+    }
+};
+
+// spazio di lavoro di un encoder o decoder, riusato fra i frame
+struct ArchiveScratch {
+    std::vector<int> cellStart;
+    std::vector<int> order;
+    std::vector<int32_t> values;
+};
+
+inline int32_t archive_quantize(float value, float inverseStep)
+{
+    return static_cast<int32_t>(std::lrint(std::clamp(value * inverseStep, -2.0e9f, 2.0e9f)));
+}
+
+// differenza e somma modulo 2^32 (mai overflow con segno)
+inline int32_t archive_sub(int32_t a, int32_t b)
+{
+    return static_cast<int32_t>(static_cast<uint32_t>(a) - static_cast<uint32_t>(b));
+}
+
+inline int32_t archive_add(int32_t a, int32_t b)
+{
+    return static_cast<int32_t>(static_cast<uint32_t>(a) + static_cast<uint32_t>(b));
+}
+
+inline uint32_t archive_zigzag(int32_t v)
+{
+    return (static_cast<uint32_t>(v) << 1) ^ static_cast<uint32_t>(v >> 31);
+}
+
+inline int32_t archive_unzigzag(uint32_t u)
+{
+    return static_cast<int32_t>((u >> 1) ^ (0u - (u & 1u)));
+}
+
+inline int archive_varint_bytes(uint32_t u)
+{
+    return 1 + (u >= (1u << 7)) + (u >= (1u << 14)) + (u >= (1u << 21)) + (u >= (1u << 28));
+}
+
+inline uint8_t* archive_put_varint(uint8_t* out, uint32_t u)
+{
+    while (u >= 0x80u) {
+        *out++ = static_cast<uint8_t>(u | 0x80u);
+        u >>= 7;
+    }
+    *out++ = static_cast<uint8_t>(u);
+    return out;
+}
+
+// nullptr se il varint esce dal buffer o supera 32 bit
+inline const uint8_t* archive_get_varint(const uint8_t* in, const uint8_t* end, uint32_t& u)
+{
+    u = 0;
+    for (int shift = 0; shift < 35 && in < end; shift += 7) {
+        const uint8_t byte = *in++;
+        u |= static_cast<uint32_t>(byte & 0x7fu) << shift;
+        if ((byte & 0x80u) == 0)
+            return in;
+    }
+    return nullptr;
+}
+
+// ordine di visita dei boids per cella del frame di riferimento (counting sort stabile, calcolato sugli interi quantizzati
+// così encoder e decoder ottengono lo stesso ordine)
+inline void archive_cell_order(const ArchiveFileHeader& header, const QuantizedFrame& reference, ArchiveScratch& scratch)
+{
+    const int count = header.count;
+    const int cellQuanta = std::max(1, static_cast<int>(std::lround(header.cellSize / header.positionStep)));
+    const int gridWidth = std::max(1, static_cast<int>(std::ceil(header.worldWidth / header.cellSize)));
+    const int gridHeight = std::max(1, static_cast<int>(std::ceil(header.worldHeight / header.cellSize)));
+    const int numCells = gridWidth * gridHeight;
+    const int32_t* qx = reference.field[0].data();
+    const int32_t* qy = reference.field[1].data();
+
+    // posizioni negative danno quozienti <= 0, riportati sulla prima cella come quelle oltre il bordo sull'ultima
+    auto cell_of = [&](int i) {
+        const int cx = std::clamp(qx[i] / cellQuanta, 0, gridWidth - 1);
+        const int cy = std::clamp(qy[i] / cellQuanta, 0, gridHeight - 1);
+        return cy * gridWidth + cx;
+    };
+
+    scratch.cellStart.assign(numCells + 1, 0);
+    scratch.order.resize(count);
+    for (int i = 0; i < count; ++i)
+        scratch.cellStart[cell_of(i) + 1]++;
+    for (int c = 0; c < numCells; ++c)
+        scratch.cellStart[c + 1] += scratch.cellStart[c];
+    for (int i = 0; i < count; ++i)
+        scratch.order[scratch.cellStart[cell_of(i)]++] = i;
+}
+
+// spostamento previsto in quanti di posizione dalla velocità del frame (il motore integra x += vx * deltaTime con la nuova
+// velocità): ratio = deltaTime * velocityStep / positionStep, una sola moltiplicazione float quindi identica nel decoder
+inline int32_t archive_predict_displacement(int32_t velocity, float ratio)
+{
+    return static_cast<int32_t>(std::lrint(static_cast<float>(velocity) * ratio));
+}
+
+// campi nell'ordine del payload: prima le velocità, da cui il decoder prevede lo spostamento delle posizioni
+static const int archive_field_order[4] = {2, 3, 0, 1};
+
+// codifica (non compressa) del frame current, come differenza da previous oppure keyframe se previous è nullptr;
+// raw cresce solo se serve, restituisce i byte scritti
+// payload: 4 byte di modo (uno per campo, 1 = differenza col valore precedente nella sequenza), il rapporto float
+// velocità -> spostamento, poi count varint per campo (vx, vy, x, y)
+inline size_t archive_encode_frame(const ArchiveFileHeader& header, const QuantizedFrame& current, const QuantizedFrame* previous,
+                                   ArchiveScratch& scratch, std::vector<uint8_t>& raw)
+{
+    const int count = header.count;
+    const size_t maxBytes = 8 + static_cast<size_t>(count) * 4 * 5;
+    if (raw.size() < maxBytes)
+        raw.resize(maxBytes);
+    scratch.values.resize(count);
+
+    // rapporto ai minimi quadrati fra spostamento e velocità (deltaTime del time step, che il frame non riporta)
+    float ratio = 0.0f;
+    if (previous) {
+        archive_cell_order(header, *previous, scratch);
+        double dot = 0.0, norm = 0.0;
+        for (int i = 0; i < count; ++i) {
+            for (int axis = 0; axis < 2; ++axis) {
+                const double v = current.field[2 + axis][i];
+                dot += v * archive_sub(current.field[axis][i], previous->field[axis][i]);
+                norm += v * v;
+            }
+        }
+        ratio = norm > 0.0 ? static_cast<float>(dot / norm) : 0.0f;
+    }
+    std::memcpy(raw.data() + 4, &ratio, sizeof(ratio));
+
+    uint8_t* out = raw.data() + 8;
+    int32_t* values = scratch.values.data();
+    for (int k = 0; k < 4; ++k) {
+        const int f = archive_field_order[k];
+        const int32_t* cur = current.field[f].data();
+        if (previous) {
+            const int32_t* prev = previous->field[f].data();
+            const int* order = scratch.order.data();
+            if (f < 2) {
+                const int32_t* velocity = current.field[f + 2].data();
+                for (int j = 0; j < count; ++j)
+                    values[j] = archive_sub(archive_sub(cur[order[j]], prev[order[j]]), archive_predict_displacement(velocity[order[j]], ratio));
+            } else {
+                for (int j = 0; j < count; ++j)
+                    values[j] = archive_sub(cur[order[j]], prev[order[j]]);
+            }
+        } else {
+            std::copy(cur, cur + count, values);
+        }
+
+        // sceglie la sequenza più corta in varint (i byte varint approssimano bene anche il costo dopo deflate)
+        size_t plainBytes = 0, diffBytes = 0;
+        int32_t last = 0;
+        for (int j = 0; j < count; ++j) {
+            plainBytes += archive_varint_bytes(archive_zigzag(values[j]));
+            diffBytes += archive_varint_bytes(archive_zigzag(archive_sub(values[j], last)));
+            last = values[j];
+        }
+        const bool diff = diffBytes < plainBytes;
+        raw[k] = diff ? 1 : 0;
+
+        last = 0;
+        for (int j = 0; j < count; ++j) {
+            out = archive_put_varint(out, archive_zigzag(diff ? archive_sub(values[j], last) : values[j]));
+            last = values[j];
+        }
+    }
+    return static_cast<size_t>(out - raw.data());
+}
+
+// inverso di archive_encode_frame: false se il payload non è valido
+inline bool archive_decode_frame(const ArchiveFileHeader& header, const uint8_t* raw, size_t rawBytes, const QuantizedFrame* previous,
+                                 QuantizedFrame& current, ArchiveScratch& scratch)
+{
+    const int count = header.count;
+    if (rawBytes < 8)
+        return false;
+    current.resize(count);
+    scratch.values.resize(count);
+    if (previous)
+        archive_cell_order(header, *previous, scratch);
+    float ratio;
+    std::memcpy(&ratio, raw + 4, sizeof(ratio));
+
+    const uint8_t* in = raw + 8;
+    const uint8_t* end = raw + rawBytes;
+    int32_t* values = scratch.values.data();
+    for (int k = 0; k < 4; ++k) {
+        const int f = archive_field_order[k];
+        const bool diff = raw[k] != 0;
+        int32_t last = 0;
+        for (int j = 0; j < count; ++j) {
+            uint32_t u;
+            in = archive_get_varint(in, end, u);
+            if (!in)
+                return false;
+            values[j] = diff ? archive_add(last, archive_unzigzag(u)) : archive_unzigzag(u);
+            last = values[j];
+        }
+
+        int32_t* cur = current.field[f].data();
+        if (previous) {
+            const int32_t* prev = previous->field[f].data();
+            const int* order = scratch.order.data();
+            if (f < 2) {
+                // velocità del frame già decodificate
+                const int32_t* velocity = current.field[f + 2].data();
+                for (int j = 0; j < count; ++j)
+                    cur[order[j]] = archive_add(archive_add(prev[order[j]], archive_predict_displacement(velocity[order[j]], ratio)), values[j]);
+            } else {
+                for (int j = 0; j < count; ++j)
+                    cur[order[j]] = archive_add(prev[order[j]], values[j]);
+            }
+        } else {
+            std::copy(values, values + count, cur);
+        }
+    }
+    return in == end;
+}
+
+// statistiche del writer
+struct TrajectoryArchiveStats {
+    long long frames = 0;
+    long long keyframes = 0;
+    long long rawBytes = 0;    // float grezzi (16 byte per boid per frame)
+    long long storedBytes = 0; // byte nel file (intestazioni dei frame comprese)
+    long long stalls = 0;      // push che hanno atteso gli encoder
+    double stallSeconds = 0.0;
+    double encodeSeconds = 0.0; // tempo di codifica sommato su tutti gli encoder
+};
+
+// lato simulazione: accoda i frame e li codifica in background
+class TrajectoryArchiveWriter
+{
+public:
+    ~TrajectoryArchiveWriter()
+    {
+        close();
+    }
+
+    bool open(const std::string& path, int count, int worldWidth, int worldHeight, const TrajectoryArchiveOptions& options = {})
+    {
+        close();
+        file = std::fopen(path.c_str(), "wb");
+        if (!file) {
+            std::cerr << "Error opening trajectory archive " << path << "." << std::endl;
+            return false;
+        }
+        header = ArchiveFileHeader{
+            .magic = trajectory_archive_magic,
+            .version = trajectory_archive_version,
+            .count = count,
+            .keyframeInterval = std::max(1, options.keyframeInterval),
+            .positionStep = options.positionStep,
+            .velocityStep = options.velocityStep,
+            .cellSize = options.cellSize,
+            .worldWidth = worldWidth,
+            .worldHeight = worldHeight,
+            .reserved = 0,
+        };
+        compressionLevel = options.compressionLevel;
+        failed = std::fwrite(&header, sizeof(header), 1, file) != 1;
+        offset = sizeof(header);
+
+        slots.resize(std::max(2, options.slots));
+        for (QuantizedFrame& slot : slots)
+            slot.resize(count);
+        pushed = 0;
+        nextFrame = 0;
+        written = 0;
+        closing = false;
+        index.clear();
+        archiveStats = {};
+
+        // thread propri e non OpenMP: la codifica procede mentre il team OpenMP esegue i time step
+        for (int t = 0; t < std::max(1, options.encoderThreads); ++t)
+            encoders.emplace_back(&TrajectoryArchiveWriter::encoder_loop, this);
+        return !failed;
+    }
+
+    // accoda lo stato del time step step: lo quantizza nello slot successivo del ring e ritorna senza codificarlo;
+    // attende solo se gli encoder sono indietro di slots - 1 frame (attese contate nelle statistiche)
+    void push(const Boids& boids, long long step)
+    {
+        if (!file)
+            return;
+        const long long frame = pushed;
+        const long long numSlots = static_cast<long long>(slots.size());
+        {
+            // lo slot del frame frame - numSlots è il riferimento del frame successivo: libero quando anche quello è scritto
+            std::unique_lock<std::mutex> lock(mutex);
+            if (written < frame - numSlots + 2) {
+                const auto start = std::chrono::steady_clock::now();
+                progress.wait(lock, [&] { return written >= frame - numSlots + 2; });
+                archiveStats.stalls++;
+                archiveStats.stallSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            }
+        }
+
+        QuantizedFrame& slot = slots[frame % numSlots];
+        slot.step = step;
+        const float inversePosition = 1.0f / header.positionStep;
+        const float inverseVelocity = 1.0f / header.velocityStep;
+        int32_t* qx = slot.field[0].data();
+        int32_t* qy = slot.field[1].data();
+        int32_t* qvx = slot.field[2].data();
+        int32_t* qvy = slot.field[3].data();
+        #pragma omp parallel for schedule(static)
+        for (int i = 0; i < header.count; ++i) {
+            qx[i] = archive_quantize(boids.x[i], inversePosition);
+            qy[i] = archive_quantize(boids.y[i], inversePosition);
+            qvx[i] = archive_quantize(boids.vx[i], inverseVelocity);
+            qvy[i] = archive_quantize(boids.vy[i], inverseVelocity);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pushed++;
+        }
+        workAvailable.notify_one();
+    }
+
+    // attende la codifica dei frame accodati, scrive indice e footer e chiude il file (false se una scrittura è fallita)
+    bool close()
+    {
+        if (!file)
+            return true;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closing = true;
+        }
+        workAvailable.notify_all();
+        for (std::thread& encoder : encoders)
+            encoder.join();
+        encoders.clear();
+
+        if (!failed) {
+            const ArchiveFooter footer{
+                .indexOffset = offset,
+                .numFrames = static_cast<uint64_t>(written),
+                .numKeyframes = static_cast<uint32_t>(index.size()),
+                .magic = trajectory_index_magic,
+            };
+            failed = (!index.empty() && std::fwrite(index.data(), sizeof(ArchiveIndexEntry), index.size(), file) != index.size())
+                     || std::fwrite(&footer, sizeof(footer), 1, file) != 1;
+        }
+        failed = std::fclose(file) != 0 || failed;
+        file = nullptr;
+        if (failed)
+            std::cerr << "Error writing trajectory archive." << std::endl;
+        return !failed;
+    }
+
+    const TrajectoryArchiveStats& stats() const
+    {
+        return archiveStats;
+    }
+
+    // riepilogo: dimensione per boid per frame, rapporto sui float grezzi, costo di codifica e attese del simulatore
+    void report(std::ostream& out) const
+    {
+        const TrajectoryArchiveStats& s = archiveStats;
+        const double frames = static_cast<double>(std::max(1LL, s.frames));
+        const std::ios_base::fmtflags flags = out.flags();
+        out << std::fixed << std::setprecision(2);
+        out << "  archivio: " << s.frames << " frame (" << s.keyframes << " keyframe), "
+            << static_cast<double>(s.storedBytes) / frames / std::max(1, header.count) << " byte per boid per frame (rapporto "
+            << static_cast<double>(s.rawBytes) / std::max(1LL, s.storedBytes) << ":1), codifica " << 1000.0 * s.encodeSeconds / frames
+            << " ms per frame, attese del simulatore " << s.stalls << " (" << s.stallSeconds << " s)" << std::endl;
+        out.flags(flags);
+    }
+
+private:
+    FILE* file = nullptr;
+    ArchiveFileHeader header = {};
+    int compressionLevel = trajectory_zlib_level;
+    uint64_t offset = 0;
+    bool failed = false;
+
+    std::vector<QuantizedFrame> slots;
+    std::vector<std::thread> encoders;
+    std::vector<ArchiveIndexEntry> index;
+    TrajectoryArchiveStats archiveStats;
+
+    // stato del ring, protetto da mutex: frame accodati, prossimo da codificare, frame scritti (in ordine)
+    std::mutex mutex;
+    std::condition_variable workAvailable;
+    std::condition_variable progress;
+    long long pushed = 0;
+    long long nextFrame = 0;
+    long long written = 0;
+    bool closing = false;
+
+    void encoder_loop()
+    {
+        ArchiveScratch scratch;
+        std::vector<uint8_t> raw, packed;
+        while (true) {
+            long long frame;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                workAvailable.wait(lock, [&] { return nextFrame < pushed || closing; });
+                if (nextFrame >= pushed)
+                    return;
+                frame = nextFrame++;
+            }
+
+            // gli slot di frame e frame - 1 non vengono riscritti finché questo frame non è scritto
+            const auto start = std::chrono::steady_clock::now();
+            const long long numSlots = static_cast<long long>(slots.size());
+            const QuantizedFrame& current = slots[frame % numSlots];
+            const bool keyframe = frame % header.keyframeInterval == 0;
+            const size_t rawBytes = archive_encode_frame(header, current, keyframe ? nullptr : &slots[(frame - 1) % numSlots], scratch, raw);
+            uLongf packedBytes = compressBound(static_cast<uLong>(rawBytes));
+            if (packed.size() < packedBytes)
+                packed.resize(packedBytes);
+            const bool packedOk = compress2(packed.data(), &packedBytes, raw.data(), static_cast<uLong>(rawBytes), compressionLevel) == Z_OK;
+            const ArchiveFrameHeader frameHeader{
+                .magic = trajectory_frame_magic,
+                .keyframe = keyframe ? 1u : 0u,
+                .step = current.step,
+                .rawBytes = static_cast<uint32_t>(rawBytes),
+                .compressedBytes = static_cast<uint32_t>(packedBytes),
+            };
+            const double encodeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            // scrittura nell'ordine dei frame: il file è scritto da un solo encoder alla volta, senza tenere il mutex
+            bool skip;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                progress.wait(lock, [&] { return written == frame; });
+                skip = failed;
+            }
+            const bool ok = skip || (packedOk && std::fwrite(&frameHeader, sizeof(frameHeader), 1, file) == 1
+                                     && std::fwrite(packed.data(), 1, packedBytes, file) == packedBytes);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!skip && ok) {
+                    if (keyframe) {
+                        index.push_back(ArchiveIndexEntry{.step = current.step, .offset = offset, .frame = static_cast<uint64_t>(frame)});
+                        archiveStats.keyframes++;
+                    }
+                    offset += sizeof(frameHeader) + packedBytes;
+                    archiveStats.frames++;
+                    archiveStats.rawBytes += static_cast<long long>(header.count) * 4 * sizeof(float);
+                    archiveStats.storedBytes += static_cast<long long>(sizeof(frameHeader) + packedBytes);
+                }
+                failed = failed || !ok;
+                archiveStats.encodeSeconds += encodeSeconds;
+                written++;
+            }
+            progress.notify_all();
+        }
+    }
+};
+
+// frame decodificato
+struct TrajectoryFrame {
+    long long frame = -1; // numero progressivo nell'archivio
+    long long step = 0;
+    bool keyframe = false;
+    int count = 0;
+    std::vector<float> x, y, vx, vy;
+};
+
+// lato replay / analisi: decodifica in streaming, accesso casuale tramite i keyframe
+class TrajectoryArchiveReader
+{
+public:
+    ~TrajectoryArchiveReader()
+    {
+        if (file)
+            std::fclose(file);
+    }
+
+    // legge intestazione e indice; senza footer (archivio non chiuso) l'indice viene ricostruito scorrendo le intestazioni
+    // dei frame completi
+    bool open(const std::string& path)
+    {
+        if (file)
+            std::fclose(file);
+        file = std::fopen(path.c_str(), "rb");
+        if (!file || std::fread(&fileHeader, sizeof(fileHeader), 1, file) != 1 || fileHeader.magic != trajectory_archive_magic
+            || fileHeader.version != trajectory_archive_version || fileHeader.count < 0) {
+            std::cerr << "Error opening trajectory archive " << path << "." << std::endl;
+            return false;
+        }
+        index.clear();
+        dataEnd = -1;
+        numFrames = 0;
+
+        ArchiveFooter footer;
+        if (fseeko(file, -static_cast<off_t>(sizeof(footer)), SEEK_END) == 0 && std::fread(&footer, sizeof(footer), 1, file) == 1
+            && footer.magic == trajectory_index_magic) {
+            index.resize(footer.numKeyframes);
+            if (fseeko(file, static_cast<off_t>(footer.indexOffset), SEEK_SET) != 0
+                || std::fread(index.data(), sizeof(ArchiveIndexEntry), index.size(), file) != index.size()) {
+                std::cerr << "Corrupted trajectory archive index in " << path << "." << std::endl;
+                return false;
+            }
+            dataEnd = static_cast<off_t>(footer.indexOffset);
+            numFrames = static_cast<long long>(footer.numFrames);
+        } else {
+            rebuild_index();
+        }
+        rewind();
+        return true;
+    }
+
+    const ArchiveFileHeader& header() const
+    {
+        return fileHeader;
+    }
+
+    const std::vector<ArchiveIndexEntry>& keyframes() const
+    {
+        return index;
+    }
+
+    // frame completi nell'archivio all'apertura
+    long long frames() const
+    {
+        return numFrames;
+    }
+
+    // torna al primo frame
+    void rewind()
+    {
+        fseeko(file, static_cast<off_t>(sizeof(ArchiveFileHeader)), SEEK_SET);
+        havePrevious = false;
+        frameNumber = -1;
+    }
+
+    // decodifica il frame successivo; false a fine archivio o su un frame incompleto (un archivio ancora in scrittura
+    // può essere riletto più tardi dallo stesso punto)
+    bool next(TrajectoryFrame& out)
+    {
+        if (!decode_next())
+            return false;
+        dequantize(out);
+        return true;
+    }
+
+    // accesso casuale: decodifica dal keyframe precedente il primo frame con time step >= step; next prosegue da lì
+    bool seek(long long step, TrajectoryFrame& out)
+    {
+        if (index.empty())
+            return false;
+        auto it = std::upper_bound(index.begin(), index.end(), step, [](long long s, const ArchiveIndexEntry& e) { return s < e.step; });
+        const ArchiveIndexEntry& entry = it == index.begin() ? *it : *(it - 1);
+        fseeko(file, static_cast<off_t>(entry.offset), SEEK_SET);
+        havePrevious = false;
+        frameNumber = static_cast<long long>(entry.frame) - 1;
+        do {
+            if (!decode_next())
+                return false;
+        } while (previous.step < step);
+        dequantize(out);
+        return true;
+    }
+
+private:
+    FILE* file = nullptr;
+    ArchiveFileHeader fileHeader = {};
+    std::vector<ArchiveIndexEntry> index;
+    off_t dataEnd = -1; // inizio dell'indice, -1 senza footer
+    long long numFrames = 0;
+
+    // previous è l'ultimo frame decodificato, riferimento del successivo
+    QuantizedFrame previous, current;
+    bool havePrevious = false;
+    bool previousKeyframe = false;
+    long long frameNumber = -1;
+    ArchiveScratch scratch;
+    std::vector<uint8_t> raw, packed;
+
+    bool read_frame_header(ArchiveFrameHeader& frameHeader)
+    {
+        const off_t position = ftello(file);
+        if (dataEnd >= 0 && position >= dataEnd)
+            return false;
+        if (std::fread(&frameHeader, sizeof(frameHeader), 1, file) != 1 || frameHeader.magic != trajectory_frame_magic) {
+            std::clearerr(file);
+            fseeko(file, position, SEEK_SET);
+            return false;
+        }
+        return true;
+    }
+
+    bool decode_next()
+    {
+        const off_t position = ftello(file);
+        ArchiveFrameHeader frameHeader;
+        if (!read_frame_header(frameHeader))
+            return false;
+        if (packed.size() < frameHeader.compressedBytes)
+            packed.resize(frameHeader.compressedBytes);
+        if (raw.size() < frameHeader.rawBytes)
+            raw.resize(frameHeader.rawBytes);
+        if (std::fread(packed.data(), 1, frameHeader.compressedBytes, file) != frameHeader.compressedBytes) {
+            std::clearerr(file);
+            fseeko(file, position, SEEK_SET);
+            return false;
+        }
+
+        uLongf rawBytes = frameHeader.rawBytes;
+        if (!frameHeader.keyframe && !havePrevious) {
+            std::cerr << "Trajectory archive: delta frame without its reference frame." << std::endl;
+            return false;
+        }
+        if (uncompress(raw.data(), &rawBytes, packed.data(), frameHeader.compressedBytes) != Z_OK || rawBytes != frameHeader.rawBytes
+            || !archive_decode_frame(fileHeader, raw.data(), rawBytes, frameHeader.keyframe ? nullptr : &previous, current, scratch)) {
+            std::cerr << "Corrupted trajectory archive frame (time step " << frameHeader.step << ")." << std::endl;
+            return false;
+        }
+        current.step = frameHeader.step;
+        std::swap(previous, current);
+        havePrevious = true;
+        previousKeyframe = frameHeader.keyframe != 0;
+        frameNumber++;
+        return true;
+    }
+
+    void dequantize(TrajectoryFrame& out) const
+    {
+        const int count = fileHeader.count;
+        out.frame = frameNumber;
+        out.step = previous.step;
+        out.keyframe = previousKeyframe;
+        out.count = count;
+        out.x.resize(count);
+        out.y.resize(count);
+        out.vx.resize(count);
+        out.vy.resize(count);
+        const float positionStep = fileHeader.positionStep;
+        const float velocityStep = fileHeader.velocityStep;
+        #pragma omp parallel for schedule(static)
+        for (int i = 0; i < count; ++i) {
+            out.x[i] = static_cast<float>(previous.field[0][i]) * positionStep;
+            out.y[i] = static_cast<float>(previous.field[1][i]) * positionStep;
+            out.vx[i] = static_cast<float>(previous.field[2][i]) * velocityStep;
+            out.vy[i] = static_cast<float>(previous.field[3][i]) * velocityStep;
+        }
+    }
+
+    // scorre le intestazioni dei frame completi (archivio non chiuso) registrando i keyframe
+    void rebuild_index()
+    {
+        fseeko(file, static_cast<off_t>(sizeof(ArchiveFileHeader)), SEEK_SET);
+        ArchiveFrameHeader frameHeader;
+        while (true) {
+            const off_t position = ftello(file);
+            if (!read_frame_header(frameHeader))
+                break;
+            // l'ultimo frame può essere stato scritto solo in parte
+            if (fseeko(file, static_cast<off_t>(frameHeader.compressedBytes), SEEK_CUR) != 0 || ftello(file) > file_size())
+                break;
+            if (frameHeader.keyframe)
+                index.push_back(ArchiveIndexEntry{.step = frameHeader.step, .offset = static_cast<uint64_t>(position), .frame = static_cast<uint64_t>(numFrames)});
+            numFrames++;
+        }
+    }
+
+    off_t file_size()
+    {
+        const off_t position = ftello(file);
+        fseeko(file, 0, SEEK_END);
+        const off_t size = ftello(file);
+        fseeko(file, position, SEEK_SET);
+        return size;
+    }
+};
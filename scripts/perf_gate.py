@@ -0,0 +1,177 @@
+#!/usr/bin/env python3
+"""Gate delle prestazioni: confronta i file perfgate_<engine>.csv prodotti dai driver con --perf-gate (o perf_gate_on) con una baseline JSON.
+
+Ogni scenario (motore, thread, agenti) ha perf_gate_runs ripetizioni dello stesso stato iniziale con time step fisso.
+Uno scenario è una regressione solo se entrambe le condizioni valgono:
+  - la mediana del tempo per time step supera quella della baseline di più di --tolerance (default 5%)
+  - il test di Mann-Whitney a una coda (tempi attuali più lenti) ha p < --alpha (default 0.01)
+così il rumore fra una ripetizione e l'altra non fa fallire il gate, ma un rallentamento consistente sì.
+
+Le baseline valgono solo sulla macchina dove sono state registrate (host, modello della CPU e processori sono salvati
+nel JSON): su una macchina diversa il gate si ferma con codice 2 invece di confrontare tempi non confrontabili.
+
+Uso:
+  python3 scripts/perf_gate.py record perfgate_*.csv [--baseline scripts/perf_baseline.json]
+  python3 scripts/perf_gate.py check perfgate_*.csv [--baseline scripts/perf_baseline.json] [--tolerance 0.05] [--alpha 0.01]
+Codici di uscita di check: 0 nessuna regressione, 1 almeno una regressione, 2 baseline assente o di un'altra macchina.
+"""
+
+import argparse
+import csv
+import glob
+import json
+import math
+import os
+import platform
+import statistics
+import sys
+from collections import defaultdict
+
+DEFAULT_BASELINE = os.path.join(os.path.dirname(os.path.abspath(__file__)), "perf_baseline.json")
+
+
+def machine():
+    """Identità della macchina: i tempi sono confrontabili solo a parità di questi campi."""
+    cpu = platform.processor() or "unknown"
+    try:
+        with open("/proc/cpuinfo") as f:
+            for line in f:
+                if line.startswith("model name"):
+                    cpu = line.split(":", 1)[1].strip()
+                    break
+    except OSError:
+        pass
+    return {"host": platform.node(), "cpu": cpu, "procs": os.cpu_count()}
+
+
+def scenario_key(engine, threads, agents):
+    return "%s/threads=%d/agents=%d" % (engine, threads, agents)
+
+
+def load(paths):
+    """Tempi per time step raggruppati per scenario."""
+    scenarios = defaultdict(lambda: {"step_seconds": []})
+    # i pattern vengono espansi anche qui (il target perf_gate di CMake non passa da una shell)
+    for path in sorted({p for pattern in paths for p in (glob.glob(pattern) or [pattern])}):
+        with open(path, newline="") as f:
+            for row in csv.DictReader(f):
+                key = scenario_key(row["engine"], int(row["threads"]), int(row["agents"]))
+                scenario = scenarios[key]
+                scenario.update(engine=row["engine"], threads=int(row["threads"]), agents=int(row["agents"]), steps=int(row["steps"]))
+                scenario["step_seconds"].append(float(row["step_seconds"]))
+    return dict(scenarios)
+
+
+def mann_whitney_greater(current, baseline):
+    """p-value del test di Mann-Whitney a una coda, ipotesi alternativa: current tende a essere maggiore di baseline.
+
+    Distribuzione esatta di U (conteggio per programmazione dinamica) per campioni piccoli come quelli del gate,
+    approssimazione normale con correzione di continuità oltre 20 ripetizioni per lato; i pareggi contano 1/2.
+    """
+    n, m = len(current), len(baseline)
+    u = sum(1.0 if c > b else 0.5 if c == b else 0.0 for c in current for b in baseline)
+    if n > 20 or m > 20:
+        mean = n * m / 2.0
+        sd = math.sqrt(n * m * (n + m + 1) / 12.0)
+        return 0.5 * math.erfc((u - 0.5 - mean) / (sd * math.sqrt(2.0)))
+
+    # counts[i][j][k]: sequenze di i valori "current" e j "baseline" con statistica U = k
+    counts = [[None] * (m + 1) for _ in range(n + 1)]
+    for i in range(n + 1):
+        for j in range(m + 1):
+            if i == 0 or j == 0:
+                counts[i][j] = [1]
+                continue
+            # l'ultimo elemento (il maggiore) è di current e supera tutti i j baseline, oppure è di baseline
+            with_current = [0] * j + counts[i - 1][j]
+            with_baseline = counts[i][j - 1]
+            size = max(len(with_current), len(with_baseline))
+            counts[i][j] = [(with_current[k] if k < len(with_current) else 0) + (with_baseline[k] if k < len(with_baseline) else 0) for k in range(size)]
+    distribution = counts[n][m]
+    total = sum(distribution)
+    threshold = math.ceil(u - 1e-9)
+    return sum(distribution[threshold:]) / total
+
+
+def record(args):
+    scenarios = load(args.csv)
+    if not scenarios:
+        sys.exit("nessuna misura nei file indicati")
+    for scenario in scenarios.values():
+        scenario["median_step_seconds"] = statistics.median(scenario["step_seconds"])
+    baseline = {"machine": machine(), "scenarios": dict(sorted(scenarios.items()))}
+    with open(args.baseline, "w") as f:
+        json.dump(baseline, f, indent=2)
+        f.write("\n")
+    print("Baseline con %d scenari salvata in %s" % (len(scenarios), args.baseline))
+    return 0
+
+
+def check(args):
+    if not os.path.exists(args.baseline):
+        print("baseline %s assente: registrarla con 'record' su questa macchina" % args.baseline, file=sys.stderr)
+        return 2
+    with open(args.baseline) as f:
+        baseline = json.load(f)
+    here = machine()
+    if baseline["machine"] != here and not args.ignore_machine:
+        print("baseline registrata su %s, questa macchina è %s: registrarla di nuovo con 'record' (o --ignore-machine)"
+              % (baseline["machine"], here), file=sys.stderr)
+        return 2
+
+    current = load(args.csv)
+    rows = []
+    regressions = 0
+    for key in sorted(set(current) | set(baseline["scenarios"])):
+        now = current.get(key)
+        before = baseline["scenarios"].get(key)
+        if now is None:
+            rows.append((key, "%.3f" % (1e3 * before["median_step_seconds"]), "-", "-", "-", "non eseguito"))
+            continue
+        now_median = statistics.median(now["step_seconds"])
+        if before is None:
+            rows.append((key, "-", "%.3f" % (1e3 * now_median), "-", "-", "nuovo"))
+            continue
+
+        before_median = statistics.median(before["step_seconds"])
+        change = now_median / before_median - 1.0
+        p_slower = mann_whitney_greater(now["step_seconds"], before["step_seconds"])
+        p_faster = mann_whitney_greater(before["step_seconds"], now["step_seconds"])
+        if change > args.tolerance and p_slower < args.alpha:
+            status = "REGRESSIONE"
+            regressions += 1
+        elif change < -args.tolerance and p_faster < args.alpha:
+            status = "più veloce"
+        else:
+            status = "ok"
+        p_value = p_slower if change >= 0 else p_faster
+        rows.append((key, "%.3f" % (1e3 * before_median), "%.3f" % (1e3 * now_median), "%+.1f%%" % (100 * change), "%.4f" % p_value, status))
+
+    header = ("scenario", "baseline ms", "attuale ms", "variazione", "p", "esito")
+    widths = [max(len(str(r[c])) for r in rows + [header]) for c in range(len(header))]
+    print("  ".join(h.ljust(w) for h, w in zip(header, widths)))
+    for r in rows:
+        print("  ".join(str(v).ljust(w) for v, w in zip(r, widths)))
+    print("Soglie: variazione della mediana > %.0f%% e p < %g (Mann-Whitney a una coda)." % (100 * args.tolerance, args.alpha))
+
+    if regressions:
+        print("%d scenari più lenti della baseline." % regressions, file=sys.stderr)
+        return 1
+    print("Nessuna regressione.")
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("mode", choices=["record", "check"])
+    parser.add_argument("csv", nargs="+", help="file perfgate_<engine>.csv")
+    parser.add_argument("--baseline", default=DEFAULT_BASELINE, help="file JSON della baseline")
+    parser.add_argument("--tolerance", type=float, default=0.05, help="rallentamento relativo della mediana tollerato")
+    parser.add_argument("--alpha", type=float, default=0.01, help="livello di significatività del test")
+    parser.add_argument("--ignore-machine", action="store_true", help="confronta anche con una baseline di un'altra macchina")
+    args = parser.parse_args()
+    sys.exit(record(args) if args.mode == "record" else check(args))
+
+
+if __name__ == "__main__":
+    main()
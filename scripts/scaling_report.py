@@ -0,0 +1,242 @@
+#!/usr/bin/env python3
+"""Analisi dei file scaling_<engine>.csv prodotti dai driver con scaling_study_on.
+
+Per ogni motore calcola, a partire dalla mediana delle ripetizioni:
+  - strong scaling: speedup, efficienza parallela, frazione seriale di Karp-Flatt e fit della legge di Amdahl
+  - weak scaling: efficienza, speedup scalato e fit della legge di Gustafson
+  - quota del tempo spesa in ogni fase (se i contatori erano attivi), per distinguere ad esempio
+    una grid.build() seriale da un update limitato dalla banda di memoria
+
+Con --baseline (ad esempio seq_grid) lo speedup dello strong scaling viene riportato anche rispetto al
+miglior codice sequenziale, oltre che rispetto al motore stesso eseguito con un thread.
+
+Scrive un riepilogo JSON e, se matplotlib è installato, un grafico PNG per motore.
+
+Uso: python3 scripts/scaling_report.py scaling_omp_soa_sp.csv [scaling_seq_grid.csv ...] [--baseline seq_grid] [--out scaling_report]
+"""
+
+import argparse
+import csv
+import json
+import os
+import statistics
+import sys
+from collections import defaultdict
+
+PHASES = ["grid_count_s", "grid_build_s", "grid_fill_s", "update_s"]
+
+
+def load(paths):
+    """Raggruppa le misure per (motore, modalità, thread)."""
+    samples = defaultdict(list)
+    for path in paths:
+        with open(path, newline="") as f:
+            for row in csv.DictReader(f):
+                key = (row["engine"], row["mode"], int(row["threads"]))
+                samples[key].append(row)
+    return samples
+
+
+def median_point(rows):
+    point = {
+        "agents": int(rows[0]["agents"]),
+        "world_width": int(rows[0]["world_width"]),
+        "world_height": int(rows[0]["world_height"]),
+        "runs": len(rows),
+        "seconds": statistics.median(float(r["seconds"]) for r in rows),
+    }
+    for phase in PHASES:
+        values = [float(r[phase]) for r in rows if r.get(phase)]
+        if values:
+            point[phase] = statistics.median(values)
+    return point
+
+
+def fit_through_origin(xs, ys):
+    """Minimi quadrati di y = a * x."""
+    den = sum(x * x for x in xs)
+    return sum(x * y for x, y in zip(xs, ys)) / den if den > 0 else None
+
+
+def analyse_strong(points):
+    t1 = points[1]["seconds"] if 1 in points else None
+    result = []
+    for p in sorted(points):
+        pt = dict(points[p], threads=p)
+        if t1:
+            speedup = t1 / pt["seconds"]
+            pt["speedup"] = speedup
+            pt["efficiency"] = speedup / p
+            # metrica di Karp-Flatt: frazione seriale sperimentale
+            pt["karp_flatt"] = (1.0 / speedup - 1.0 / p) / (1.0 - 1.0 / p) if p > 1 else None
+        result.append(pt)
+
+    # legge di Amdahl: 1/S - 1/p = s * (1 - 1/p)
+    fit = [(1.0 - 1.0 / r["threads"], 1.0 / r["speedup"] - 1.0 / r["threads"]) for r in result if r["threads"] > 1 and "speedup" in r]
+    serial_fraction = fit_through_origin([x for x, _ in fit], [y for _, y in fit]) if fit else None
+    amdahl = None
+    if serial_fraction is not None:
+        amdahl = {
+            "serial_fraction": serial_fraction,
+            "max_speedup": 1.0 / serial_fraction if serial_fraction > 0 else None,
+        }
+    return result, amdahl
+
+
+def analyse_weak(points):
+    t1 = points[1]["seconds"] if 1 in points else None
+    result = []
+    for p in sorted(points):
+        pt = dict(points[p], threads=p)
+        if t1:
+            pt["efficiency"] = t1 / pt["seconds"]
+            pt["scaled_speedup"] = p * t1 / pt["seconds"]
+        result.append(pt)
+
+    # legge di Gustafson: p - S = alpha * (p - 1)
+    fit = [(r["threads"] - 1.0, r["threads"] - r["scaled_speedup"]) for r in result if r["threads"] > 1 and "scaled_speedup" in r]
+    alpha = fit_through_origin([x for x, _ in fit], [y for _, y in fit]) if fit else None
+    return result, ({"serial_fraction": alpha} if alpha is not None else None)
+
+
+def phase_shares(rows):
+    """Quota del tempo totale per fase al numero massimo di thread (solo se misurata)."""
+    if not rows or "update_s" not in rows[-1]:
+        return None
+    last = rows[-1]
+    return {phase[:-2]: last[phase] / last["seconds"] for phase in PHASES if phase in last and last["seconds"] > 0}
+
+
+def diagnose(strong, amdahl, shares):
+    """Indicazione sintetica sul perché la scalabilità si ferma."""
+    notes = []
+    if amdahl and amdahl["serial_fraction"] is not None and amdahl["serial_fraction"] > 0.05:
+        notes.append("frazione seriale stimata %.1f%%" % (100 * amdahl["serial_fraction"]))
+    if shares and shares.get("grid_build", 0) > 0.05:
+        notes.append("grid.build() seriale pesa %.1f%% del tempo" % (100 * shares["grid_build"]))
+    kf = [r["karp_flatt"] for r in strong if r.get("karp_flatt") is not None]
+    if len(kf) >= 2 and kf[-1] > kf[0] * 1.5:
+        notes.append("Karp-Flatt crescente con i thread: overhead di parallelizzazione o saturazione della banda di memoria")
+    return notes
+
+
+def plot(engine, strong, weak, amdahl, out_dir):
+    try:
+        import matplotlib
+        matplotlib.use("Agg")
+        import matplotlib.pyplot as plt
+    except ImportError:
+        return None
+
+    fig, axes = plt.subplots(1, 3, figsize=(15, 4.5))
+    if strong and "speedup" in strong[0]:
+        ps = [r["threads"] for r in strong]
+        axes[0].plot(ps, [r["speedup"] for r in strong], "o-", label="misurato")
+        axes[0].plot(ps, ps, "k--", label="ideale")
+        if amdahl and amdahl["serial_fraction"] is not None:
+            s = amdahl["serial_fraction"]
+            axes[0].plot(ps, [1.0 / (s + (1.0 - s) / p) for p in ps], ":", label="Amdahl s=%.3f" % s)
+        axes[0].set_title("Strong scaling (N=%d)" % strong[0]["agents"])
+        axes[0].set_xlabel("threads")
+        axes[0].set_ylabel("speedup")
+        axes[0].legend()
+
+        axes[1].plot(ps, [r["efficiency"] for r in strong], "o-", label="strong")
+    if weak and "efficiency" in weak[0]:
+        axes[1].plot([r["threads"] for r in weak], [r["efficiency"] for r in weak], "s-", label="weak")
+    axes[1].set_title("Efficienza parallela")
+    axes[1].set_xlabel("threads")
+    axes[1].set_ylim(0, 1.1)
+    axes[1].legend()
+
+    if strong and "update_s" in strong[0]:
+        ps = [r["threads"] for r in strong]
+        bottom = [0.0] * len(ps)
+        for phase in PHASES:
+            values = [r.get(phase, 0.0) for r in strong]
+            axes[2].bar(ps, values, bottom=bottom, label=phase[:-2])
+            bottom = [b + v for b, v in zip(bottom, values)]
+        axes[2].set_title("Tempo per fase (strong)")
+        axes[2].set_xlabel("threads")
+        axes[2].set_ylabel("secondi")
+        axes[2].legend()
+    else:
+        axes[2].set_axis_off()
+
+    fig.suptitle(engine)
+    fig.tight_layout()
+    path = os.path.join(out_dir, "scaling_%s.png" % engine)
+    fig.savefig(path, dpi=120)
+    plt.close(fig)
+    return path
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("csv", nargs="+", help="file scaling_<engine>.csv")
+    parser.add_argument("--out", default="scaling_report", help="cartella di output")
+    parser.add_argument("--baseline", help="motore sequenziale di riferimento per lo speedup assoluto (es. seq_grid)")
+    args = parser.parse_args()
+
+    samples = load(args.csv)
+    os.makedirs(args.out, exist_ok=True)
+
+    engines = sorted({engine for engine, _, _ in samples})
+    baseline_seconds = None
+    if args.baseline:
+        rows = samples.get((args.baseline, "strong", 1))
+        if not rows:
+            sys.exit("motore di riferimento %s senza misure di strong scaling a 1 thread" % args.baseline)
+        baseline_seconds = median_point(rows)["seconds"]
+
+    report = {}
+    for engine in engines:
+        by_mode = {mode: {p: median_point(rows) for (e, m, p), rows in samples.items() if e == engine and m == mode} for mode in ("strong", "weak")}
+        strong, amdahl = analyse_strong(by_mode["strong"]) if by_mode["strong"] else ([], None)
+        weak, gustafson = analyse_weak(by_mode["weak"]) if by_mode["weak"] else ([], None)
+        shares = phase_shares(strong)
+        if baseline_seconds is not None and engine != args.baseline:
+            for r in strong:
+                r["speedup_vs_baseline"] = baseline_seconds / r["seconds"]
+        report[engine] = {
+            "strong": strong,
+            "weak": weak,
+            "amdahl": amdahl,
+            "gustafson": gustafson,
+            "phase_shares_at_max_threads": shares,
+            "notes": diagnose(strong, amdahl, shares),
+        }
+        image = plot(engine, strong, weak, amdahl, args.out)
+        if image:
+            report[engine]["plot"] = image
+
+        print("== %s ==" % engine)
+        for r in strong:
+            line = "strong p=%2d  T=%.3fs" % (r["threads"], r["seconds"])
+            if "speedup" in r:
+                line += "  S=%.2f  E=%.2f" % (r["speedup"], r["efficiency"])
+            if r.get("karp_flatt") is not None:
+                line += "  e=%.3f" % r["karp_flatt"]
+            if "speedup_vs_baseline" in r:
+                line += "  S(%s)=%.2f" % (args.baseline, r["speedup_vs_baseline"])
+            print(line)
+        for r in weak:
+            line = "weak   p=%2d  N=%d  T=%.3fs" % (r["threads"], r["agents"], r["seconds"])
+            if "efficiency" in r:
+                line += "  E=%.2f" % r["efficiency"]
+            print(line)
+        if amdahl:
+            print("Amdahl: frazione seriale %.4f" % amdahl["serial_fraction"])
+        if gustafson:
+            print("Gustafson: frazione seriale %.4f" % gustafson["serial_fraction"])
+        for note in report[engine]["notes"]:
+            print("- " + note)
+
+    with open(os.path.join(args.out, "scaling_report.json"), "w") as f:
+        json.dump(report, f, indent=2)
+    if not any("plot" in r for r in report.values()):
+        print("matplotlib non disponibile: grafici non generati", file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
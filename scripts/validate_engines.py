@@ -0,0 +1,253 @@
+#!/usr/bin/env python3
+"""Validazione incrociata dei motori: confronta i file validation_<engine>.bin prodotti dai driver con --validate (o validation_on).
+
+Tutti i motori partono dagli stessi stati iniziali (scenari x seed, vedi common/validation.h) con lo stesso time step fisso.
+Il confronto avviene in due fasi:
+  - fase esatta: nei time step prima di --min-exact-steps lo stato completo (x, y, vx, vy) di ogni boid deve coincidere
+    con quello del motore di riferimento entro |a - b| <= --atol + --rtol * |b|; un solo boid fuori tolleranza fa fallire
+    il motore (un vicino perso o contato due volte, anche solo per i boids vicini al bordo, sposta subito qualche boid);
+    il modello è caotico, quindi dopo quei time step le differenze di arrotondamento (ordine delle somme sui vicini, FMA)
+    possono crescere e, con le soglie sulle distanze, spostare di colpo qualche boid: da lì in poi --diverged-fraction
+    segna solo la divergenza caotica (il primo time step con più di quella frazione di boids fuori tolleranza)
+  - fase statistica: dopo la divergenza gli stati non sono più confrontabili boid per boid, si confrontano le metriche dello
+    stormo (polarizzazione, velocità media, dispersione, frazione fuori dalla finestra) mediate sugli ultimi --tail time step
+    di ogni seed; una metrica fallisce solo se la media differisce di più di --metric-tolerance (relativa, con un minimo
+    assoluto) e il test di Mann-Whitney a due code sui seed ha p < --alpha
+Stati o metriche non finiti (NaN, inf) fanno sempre fallire il motore.
+
+Controllo di mutazione: i motori il cui nome corrisponde a un pattern di --mutants sono versioni volutamente sbagliate
+(ad esempio omp_soa_sp_border_mutant, con le celle di bordo della griglia avvolte invece che limitate) e devono essere
+rifiutati; la validazione fallisce se una mutazione supera i controlli.
+
+Uso:
+  python3 scripts/validate_engines.py validation_*.bin [--reference seq] [--min-exact-steps 5] [--mutants "*_border_mutant"]
+Codici di uscita: 0 motori equivalenti, 1 almeno un motore non equivalente, 2 file mancanti o incompatibili.
+"""
+
+import argparse
+import fnmatch
+import glob
+import math
+import os
+import statistics
+import struct
+import sys
+from array import array
+
+MAGIC = 0x4C415642
+VERSION = 1
+SCENARIOS = ["in movimento", "da fermi", "fuori finestra"]
+METRICS = ["polarizzazione", "velocità media", "dispersione", "fuori finestra"]
+FIELDS = ["x", "y", "vx", "vy"]
+
+
+def engine_name(path):
+    name = os.path.basename(path)
+    return name[len("validation_"):-len(".bin")] if name.startswith("validation_") and name.endswith(".bin") else name
+
+
+def load(path):
+    """Intestazione, stati completi runs[(scenario, seed)]["states"][t][campo] e metriche runs[...]["metrics"][t][metrica]."""
+    with open(path, "rb") as f:
+        data = f.read()
+    magic, version, agents, steps, exact_steps, seeds, scenarios, metrics = struct.unpack_from("<8I", data, 0)
+    if magic != MAGIC or version != VERSION:
+        raise ValueError("%s non è un file di validazione (versione %d)" % (path, VERSION))
+    header = {"agents": agents, "steps": steps, "exact_steps": exact_steps, "seeds": seeds, "scenarios": scenarios, "metrics": metrics}
+
+    values = array("f")
+    values.frombytes(data[32:])
+    if sys.byteorder != "little":
+        values.byteswap()
+    state_size = len(FIELDS) * agents
+    run_size = (exact_steps + 1) * state_size + (steps + 1) * metrics
+    if len(values) != scenarios * seeds * run_size:
+        raise ValueError("%s è troncato" % path)
+
+    runs = {}
+    offset = 0
+    for scenario in range(scenarios):
+        for seed in range(seeds):
+            states = []
+            for _ in range(exact_steps + 1):
+                states.append([values[offset + k * agents:offset + (k + 1) * agents] for k in range(len(FIELDS))])
+                offset += state_size
+            series = [values[offset + t * metrics:offset + (t + 1) * metrics] for t in range(steps + 1)]
+            offset += (steps + 1) * metrics
+            runs[(scenario, seed)] = {"states": states, "metrics": series}
+    return header, runs
+
+
+def mann_whitney_two_sided(a, b):
+    """p-value del test di Mann-Whitney a due code: distribuzione esatta di U per campioni piccoli (i seed), i pareggi contano 1/2."""
+    n, m = len(a), len(b)
+    u = sum(1.0 if x > y else 0.5 if x == y else 0.0 for x in a for y in b)
+    if n > 20 or m > 20:
+        mean = n * m / 2.0
+        sd = math.sqrt(n * m * (n + m + 1) / 12.0)
+        return min(1.0, math.erfc(max(abs(u - mean) - 0.5, 0.0) / (sd * math.sqrt(2.0))))
+
+    # counts[i][j][k]: sequenze di i valori di a e j di b con statistica U = k (stessa costruzione di perf_gate.py)
+    counts = [[None] * (m + 1) for _ in range(n + 1)]
+    for i in range(n + 1):
+        for j in range(m + 1):
+            if i == 0 or j == 0:
+                counts[i][j] = [1]
+                continue
+            with_a = [0] * j + counts[i - 1][j]
+            with_b = counts[i][j - 1]
+            size = max(len(with_a), len(with_b))
+            counts[i][j] = [(with_a[k] if k < len(with_a) else 0) + (with_b[k] if k < len(with_b) else 0) for k in range(size)]
+    distribution = counts[n][m]
+    total = sum(distribution)
+    # la distribuzione è simmetrica: coda della distanza dalla media
+    distance = abs(u - n * m / 2.0)
+    tail = sum(c for k, c in enumerate(distribution) if abs(k - n * m / 2.0) >= distance - 1e-9)
+    return min(1.0, tail / total)
+
+
+def finite(values):
+    return all(math.isfinite(v) for v in values)
+
+
+def exact_phase(reference, runs, args):
+    """Per ogni (scenario, seed): primo time step prima di --min-exact-steps con boids oltre la tolleranza e quanti sono
+    (None se nessuno), primo time step con più di --diverged-fraction boids oltre la tolleranza (None se mai), massima
+    differenza nei time step precedenti e presenza di valori non finiti."""
+    result = {}
+    for key, run in runs.items():
+        early, divergence, max_diff, nonfinite = None, None, 0.0, False
+        for t, (state, ref_state) in enumerate(zip(run["states"], reference[key]["states"])):
+            step_diff, beyond = 0.0, set()
+            for field, ref_field in zip(state, ref_state):
+                nonfinite = nonfinite or not finite(field)
+                for i, (v, r) in enumerate(zip(field, ref_field)):
+                    d = abs(v - r)
+                    step_diff = max(step_diff, d)
+                    if d > args.atol + args.rtol * abs(r):
+                        beyond.add(i)
+            if beyond and t < args.min_exact_steps and early is None:
+                early = (t, len(beyond))
+            if len(beyond) > args.diverged_fraction * len(state[0]) or nonfinite:
+                divergence = t
+                break
+            max_diff = max(max_diff, step_diff)
+        result[key] = (early, divergence, max_diff, nonfinite)
+    return result
+
+
+def tail_means(runs, scenario, seeds, metric, steps, tail):
+    return [statistics.fmean(run[metric] for run in runs[(scenario, seed)]["metrics"][steps - tail + 1:]) for seed in range(seeds)]
+
+
+def validate(args):
+    paths = sorted({p for pattern in args.files for p in (glob.glob(pattern) or [pattern])})
+    engines = {}
+    for path in paths:
+        if not os.path.exists(path):
+            print("file %s assente" % path, file=sys.stderr)
+            return 2
+        engines[engine_name(path)] = load(path)
+    if args.reference not in engines:
+        print("manca il motore di riferimento %s (validation_%s.bin)" % (args.reference, args.reference), file=sys.stderr)
+        return 2
+    header, reference = engines.pop(args.reference)
+    if not engines:
+        print("nessun motore da confrontare con %s" % args.reference, file=sys.stderr)
+        return 2
+    mutants = {name for name in engines if any(fnmatch.fnmatch(name, pattern) for pattern in args.mutants)}
+    for pattern in args.mutants:
+        if not any(fnmatch.fnmatch(name, pattern) for name in engines):
+            print("nessun motore corrisponde alla mutazione %s" % pattern, file=sys.stderr)
+            return 2
+    for name, (other, _) in engines.items():
+        if other != header:
+            print("%s ha parametri di validazione diversi da %s: %s" % (name, args.reference, other), file=sys.stderr)
+            return 2
+
+    seeds, steps = header["seeds"], header["steps"]
+    tail = min(args.tail, steps)
+    failures = 0
+    print("Riferimento: %s (%d boids, %d time step, %d seed per scenario, stato completo per %d time step)"
+          % (args.reference, header["agents"], steps, seeds, header["exact_steps"]))
+    for name, (_, runs) in sorted(engines.items()):
+        print("\n== %s%s ==" % (name, " (mutazione, deve essere rifiutata)" if name in mutants else ""))
+        engine_failures = 0
+
+        # fase esatta
+        exact = exact_phase(reference, runs, args)
+        for scenario in range(header["scenarios"]):
+            earlies, divergences = [], []
+            worst = 0.0
+            for seed in range(seeds):
+                early, divergence, max_diff, nonfinite = exact[(scenario, seed)]
+                worst = max(worst, max_diff)
+                if nonfinite:
+                    print("  %-15s seed %d: stato non finito (NaN o inf)" % (SCENARIOS[scenario], seed))
+                    engine_failures += 1
+                if early is not None:
+                    earlies.append(early)
+                divergences.append(divergence)
+            first = min((d for d in divergences if d is not None), default=None)
+            status = "ok"
+            if earlies:
+                step, beyond = min(earlies)
+                status = "FUORI TOLLERANZA AL TIME STEP %d (%d boids)" % (step, beyond)
+                engine_failures += 1
+            shown = "mai (entro %d)" % header["exact_steps"] if first is None else "time step %d" % first
+            print("  esatta      %-15s prima divergenza: %-20s max diff prima: %.3g  %s" % (SCENARIOS[scenario], shown, worst, status))
+
+        # fase statistica
+        for scenario in range(header["scenarios"]):
+            for metric in range(header["metrics"]):
+                ref = tail_means(reference, scenario, seeds, metric, steps, tail)
+                now = tail_means(runs, scenario, seeds, metric, steps, tail)
+                if not finite(now):
+                    print("  statistica  %-15s %-15s metrica non finita  DIFFERENTE" % (SCENARIOS[scenario], METRICS[metric]))
+                    engine_failures += 1
+                    continue
+                ref_mean, now_mean = statistics.fmean(ref), statistics.fmean(now)
+                allowed = max(args.metric_tolerance * abs(ref_mean), args.metric_floor)
+                p_value = mann_whitney_two_sided(now, ref)
+                status = "ok"
+                if abs(now_mean - ref_mean) > allowed and p_value < args.alpha:
+                    status = "DIFFERENTE"
+                    engine_failures += 1
+                print("  statistica  %-15s %-15s rif %10.4f  attuale %10.4f  p %.4f  %s"
+                      % (SCENARIOS[scenario], METRICS[metric], ref_mean, now_mean, p_value, status))
+
+        if name in mutants:
+            print("  -> %s" % ("mutazione rilevata (%d controlli falliti)" % engine_failures if engine_failures else "MUTAZIONE NON RILEVATA"))
+            failures += engine_failures == 0
+        else:
+            print("  -> %s" % ("equivalente" if engine_failures == 0 else "NON EQUIVALENTE (%d controlli falliti)" % engine_failures))
+            failures += engine_failures > 0
+
+    print("\nSoglie: stato entro %g + %g*|rif| per tutti i boids nei primi %d time step, poi divergenza oltre il %g%% dei boids fuori; metriche sugli ultimi %d time step entro %.0f%% (minimo %g) o p >= %g."
+          % (args.atol, args.rtol, args.min_exact_steps, 100 * args.diverged_fraction, tail, 100 * args.metric_tolerance, args.metric_floor, args.alpha))
+    if failures:
+        print("%d motori non equivalenti a %s o mutazioni non rilevate." % (failures, args.reference), file=sys.stderr)
+        return 1
+    print("Tutti i motori sono equivalenti a %s%s." % (args.reference, " e tutte le mutazioni sono state rilevate" if mutants else ""))
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("files", nargs="+", help="file validation_<engine>.bin")
+    parser.add_argument("--reference", default="seq", help="motore di riferimento")
+    parser.add_argument("--atol", type=float, default=1e-3, help="tolleranza assoluta sullo stato")
+    parser.add_argument("--rtol", type=float, default=1e-5, help="tolleranza relativa sullo stato")
+    parser.add_argument("--diverged-fraction", type=float, default=0.01, help="frazione di boids fuori tolleranza che segna la divergenza caotica (dopo --min-exact-steps)")
+    parser.add_argument("--min-exact-steps", type=int, default=5, help="time step iniziali in cui nessun boid può uscire dalla tolleranza")
+    parser.add_argument("--tail", type=int, default=100, help="time step finali usati per le metriche")
+    parser.add_argument("--metric-tolerance", type=float, default=0.05, help="differenza relativa tollerata sulle metriche")
+    parser.add_argument("--metric-floor", type=float, default=0.01, help="differenza assoluta sempre tollerata sulle metriche")
+    parser.add_argument("--alpha", type=float, default=0.01, help="livello di significatività del test")
+    parser.add_argument("--mutants", nargs="*", default=[], help="pattern dei motori mutati che devono essere rifiutati")
+    args = parser.parse_args()
+    sys.exit(validate(args))
+
+
+if __name__ == "__main__":
+    main()
@@ -9,13 +9,21 @@
 #define matching_factor 0.05f
 #define avoid_factor 0.025f
 #define turn_factor 0.4f
-#define max_bias 0.01f
-#define bias_increment 0.00004f
 #define min_speed 3.0f
 #define max_speed 6.0f
 
 // algoritmo riadattato da https://vanhunteradams.com/Pico/Animal_Movement/Boids-algorithm.html
 
+// funzione per aggiornare la posizione di tutti i boids
+void update_all_boids(const Boid* boids, Boid* new_boids, const int num_boids, float deltaTime, int windowWidth, int windowHeight) {
+    for (int i = 0; i < num_boids; i++) {
+        // copia dal vecchio al nuovo buffer e aggiorna leggendo gli altri boids solo dal vecchio
+        // (aggiornando sul posto i boids successivi vedrebbero lo stato già avanzato dei precedenti)
+        new_boids[i] = boids[i];
+        update_boid_position(&new_boids[i], boids, num_boids, deltaTime, windowWidth, windowHeight);
+    }
+}
+
 // funzione per aggiornare la posizione di un boid
 void update_boid_position(Boid* boid, const Boid* otherboids, const int num_boids, float deltaTime, int windowWidth, int windowHeight) {
     // inizializza le variabili necessarie
@@ -81,7 +89,7 @@ void update_boid_position(Boid* boid, const Boid* otherboids, const int num_boid
     //# Slow step! Lookup the "alpha max plus beta min" algorithm
     // calcolo della norma della velocità e clamp fra minima e massima velocità
     float speed = sqrtf(boid->vx * boid->vx + boid->vy * boid->vy);
-    if (speed < min_speed) {
+    if (speed < min_speed && speed > 0.0f) {
         boid->vx = (boid->vx / speed) * min_speed;
         boid->vy = (boid->vy / speed) * min_speed;
     }
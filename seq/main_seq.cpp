@@ -4,11 +4,15 @@
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <SFML/Graphics.hpp>
 #include <SFML/System.hpp>
 #include <SFML/Window.hpp>
 
+#include "../common/validation.h"
+
 #include "boids_seq.h"
 
 #define visuals_on true
@@ -35,6 +39,25 @@ int main(int argc, char* argv[])
 
     const int windowWidth = 1280;
     const int windowHeight = 720;
+
+    if (validation_requested(argc, argv)) {
+        // motore di riferimento della validazione incrociata (stessi stati iniziali e time step fisso degli altri motori)
+        std::vector<Boid> current, updated;
+        return run_validation("seq", windowWidth, windowHeight, [&](const ValidationState& state, ValidationState& next, int, float deltaTime, int worldWidth, int worldHeight) {
+            const int agents = state.count();
+            current.resize(agents);
+            updated.resize(agents);
+            for (int i = 0; i < agents; ++i)
+                current[i] = Boid{state.x[i], state.y[i], state.vx[i], state.vy[i]};
+            update_all_boids(current.data(), updated.data(), agents, deltaTime, worldWidth, worldHeight);
+            for (int i = 0; i < agents; ++i) {
+                next.x[i] = updated[i].x;
+                next.y[i] = updated[i].y;
+                next.vx[i] = updated[i].vx;
+                next.vy[i] = updated[i].vy;
+            }
+        });
+    }
     #if visuals_on
     sf::RenderWindow window(sf::VideoMode(windowWidth, windowHeight), "Boids Simulation");
     #endif
@@ -48,8 +71,9 @@ int main(int argc, char* argv[])
             window.setTitle("Boids Simulation (n. " + std::to_string(ri + 1) + ", " + std::to_string(numberOfAgents[ai]) + " agents)");
             #endif
 
-            // inizializzazione stato boids (posizione iniziale random e velocità nulla)
+            // inizializzazione stato boids (posizione iniziale random e velocità nulla), i buffer rappresentano rispettivamente lo stato corrente e successivo
             Boid* boids = new Boid[numberOfAgents[ai]];
+            Boid* new_boids = new Boid[numberOfAgents[ai]];
             for (int i = 0; i < numberOfAgents[ai]; ++i) {
                 boids[i].x = rand() % windowWidth;
                 boids[i].y = rand() % windowHeight;
@@ -97,8 +121,7 @@ int main(int argc, char* argv[])
                 auto start = std::chrono::high_resolution_clock::now();
 
                 // aggiorna lo stato dei boids
-                for (int i = 0; i < numberOfAgents[ai]; ++i)
-                    update_boid_position(&boids[i], boids, numberOfAgents[ai], deltaTime.asSeconds() * speedUpSimulation, windowWidth, windowHeight);
+                update_all_boids(boids, new_boids, numberOfAgents[ai], deltaTime.asSeconds() * speedUpSimulation, windowWidth, windowHeight);
 
                 // campiona il punto di fine di questo time step con un clock ad alta risoluzione
                 auto stop = std::chrono::high_resolution_clock::now();
@@ -106,6 +129,9 @@ int main(int argc, char* argv[])
                 // somma al tempo di esecuzione dell'algoritmo sugli altri boids
                 totalSimulationTime += std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count();
 
+                // il nuovo buffer diventa lo stato corrente per il disegno e per il prossimo time step
+                std::swap(boids, new_boids);
+
                 #if visuals_on
                 // aggiorna i 4 vertici dei quadrati (i boids)
                 for (int i = 0; i < numberOfAgents[ai]; ++i)
@@ -133,6 +159,7 @@ int main(int argc, char* argv[])
 
             // dealloca gli array per evitare memory leaks
             delete[] boids;
+            delete[] new_boids;
             #if visuals_on
             delete boidsQuads;
             #endif
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cmath>
+
+#include "spatial_grid.h"
+
+// kernel sulla griglia ordinata per cella condiviso da seq_grid e da ensemble: le regole sono parametrizzate
+// da FlockParams, così l'ensemble può dare a ogni stormo i suoi parametri senza duplicare il codice
+
+// algoritmo riadattato da https://vanhunteradams.com/Pico/Animal_Movement/Boids-algorithm.html
+
+// parametri del modello (i valori di default sono quelli degli altri motori, dove sono costanti di compilazione)
+struct FlockParams {
+    float visualRange = 40.0f;
+    float protectedRange = 8.0f;
+    float centeringFactor = 0.002f;
+    float matchingFactor = 0.05f;
+    float avoidFactor = 0.025f;
+    float turnFactor = 0.4f;
+    float minSpeed = 3.0f;
+    float maxSpeed = 6.0f;
+};
+
+// interazioni e integrazione dei boids nelle righe [rowBegin, rowEnd) della griglia; il nuovo stato di un boid è scritto
+// all'indice originale grid.id[k] dei buffer di uscita (il chiamante li sposta all'inizio del proprio intervallo di boids);
+// righe diverse scrivono boids diversi, quindi più thread possono elaborare righe disgiunte della stessa griglia
+inline void interact_rows(const SortedGrid& grid, const FlockParams& p, int rowBegin, int rowEnd,
+                          float* newX, float* newY, float* newVx, float* newVy, float deltaTime, int windowWidth, int windowHeight)
+{
+    const float visualRangeSquared = p.visualRange * p.visualRange;
+    const float protectedRangeSquared = p.protectedRange * p.protectedRange;
+
+    const float* sx = grid.x.data();
+    const float* sy = grid.y.data();
+    const float* svx = grid.vx.data();
+    const float* svy = grid.vy.data();
+
+    // visita le celle in ordine: i boids della stessa cella condividono lo stencil, che resta in cache
+    for (int cy = rowBegin; cy < rowEnd; ++cy) {
+        for (int cx = 0; cx < grid.gridWidth; ++cx) {
+            const int cell = grid.cell_index(cx, cy);
+
+            // intervalli contigui delle 3 righe dello stencil 3x3 (celle fuori dalla griglia escluse)
+            int stencilBegin[3], stencilEnd[3];
+            int numRows = 0;
+            const int firstX = cx > 0 ? cx - 1 : cx;
+            const int lastX = cx < grid.gridWidth - 1 ? cx + 1 : cx;
+            for (int ry = cy - 1; ry <= cy + 1; ++ry) {
+                if (ry < 0 || ry >= grid.gridHeight)
+                    continue;
+                stencilBegin[numRows] = grid.cellStart[grid.cell_index(firstX, ry)];
+                stencilEnd[numRows] = grid.cellStart[grid.cell_index(lastX, ry) + 1];
+                numRows++;
+            }
+
+            for (int k = grid.cellStart[cell]; k < grid.cellStart[cell + 1]; ++k) {
+                const float bx = sx[k];
+                const float by = sy[k];
+
+                // inizializza le variabili necessarie
+                float xpos_avg = 0.0f, ypos_avg = 0.0f;
+                float xvel_avg = 0.0f, yvel_avg = 0.0f;
+                int neighboring_boids = 0;
+                float close_dx = 0.0f, close_dy = 0.0f;
+
+                for (int r = 0; r < numRows; ++r) {
+                    // il boid stesso ha distanza nulla e contribuisce zero alla separazione: non serve escluderlo
+                    #pragma omp simd reduction(+:xpos_avg,ypos_avg,xvel_avg,yvel_avg,close_dx,close_dy,neighboring_boids)
+                    for (int j = stencilBegin[r]; j < stencilEnd[r]; ++j) {
+                        // calcola la differenza di posizione con l'altro boid
+                        const float dx = bx - sx[j];
+                        const float dy = by - sy[j];
+                        const float squared_distance = dx * dx + dy * dy;
+
+                        // maschere al posto dei branch (protected range oppure visual range)
+                        const bool close = squared_distance < protectedRangeSquared;
+                        const bool visible = !close && squared_distance < visualRangeSquared;
+
+                        close_dx += close ? dx : 0.0f;
+                        close_dy += close ? dy : 0.0f;
+                        xpos_avg += visible ? sx[j] : 0.0f;
+                        ypos_avg += visible ? sy[j] : 0.0f;
+                        xvel_avg += visible ? svx[j] : 0.0f;
+                        yvel_avg += visible ? svy[j] : 0.0f;
+                        neighboring_boids += visible ? 1 : 0;
+                    }
+                }
+
+                float vx = svx[k];
+                float vy = svy[k];
+
+                // se ci sono boids vicini, calcola il centro dello stormo
+                if (neighboring_boids > 0) {
+                    xpos_avg /= static_cast<float>(neighboring_boids);
+                    ypos_avg /= static_cast<float>(neighboring_boids);
+                    xvel_avg /= static_cast<float>(neighboring_boids);
+                    yvel_avg /= static_cast<float>(neighboring_boids);
+
+                    // aggiusta la velocità del boid con il centering factor per avvicinarsi al centro dei vicini (cohesion rule)
+                    vx += (xpos_avg - bx) * p.centeringFactor;
+                    vy += (ypos_avg - by) * p.centeringFactor;
+
+                    // aggiusta la velocità del boid con il matching factor per avvicinarsi alla velocità media dei vicini (alignment rule)
+                    vx += (xvel_avg - vx) * p.matchingFactor;
+                    vy += (yvel_avg - vy) * p.matchingFactor;
+                }
+
+                // aggiusta la velocità con il avoid factor per allontanarsi dai boids vicini (separation rule)
+                vx += close_dx * p.avoidFactor;
+                vy += close_dy * p.avoidFactor;
+
+                // gestione dei margini dello schermo
+                if (by < windowHeight * 0.05f) vy += p.turnFactor;
+                if (bx > windowWidth  * 0.95f) vx -= p.turnFactor;
+                if (bx < windowWidth  * 0.05f) vx += p.turnFactor;
+                if (by > windowHeight * 0.95f) vy -= p.turnFactor;
+
+                // calcolo della norma della velocità e clamp fra minima e massima velocità (a velocità nulla la direzione non è definita)
+                float speed = sqrtf(vx * vx + vy * vy);
+                if (speed < p.minSpeed && speed > 0.0f) {
+                    vx = (vx / speed) * p.minSpeed;
+                    vy = (vy / speed) * p.minSpeed;
+                }
+                if (speed > p.maxSpeed) {
+                    vx = (vx / speed) * p.maxSpeed;
+                    vy = (vy / speed) * p.maxSpeed;
+                }
+
+                // aggiornamento finale nel nuovo buffer, all'indice originale del boid
+                const int i = grid.id[k];
+                newVx[i] = vx;
+                newVy[i] = vy;
+                newX[i] = bx + vx * deltaTime;
+                newY[i] = by + vy * deltaTime;
+            }
+        }
+    }
+}
@@ -0,0 +1,26 @@
+#include "boids_seq_grid.h"
+#include "boids_kernel.h"
+
+// algoritmo riadattato da https://vanhunteradams.com/Pico/Animal_Movement/Boids-algorithm.html
+
+// versione sequenziale di riferimento: stesse regole e stesso double buffering dei motori paralleli,
+// ma con griglia piatta ordinata per cella e ciclo interno vettorizzabile (miglior codice su un solo core);
+// il kernel (boids_kernel.h) è condiviso con l'ensemble, qui con i parametri di default del modello
+
+// funzione per aggiornare le posizioni di tutti i boids
+void update_all_boids(const Boids& boids, Boids& new_boids, SortedGrid& grid, float deltaTime, int windowWidth, int windowHeight)
+{
+    constexpr FlockParams params;
+
+    grid.resize(params.visualRange, windowWidth, windowHeight, boids.count);
+    grid.build(boids.x, boids.y, boids.vx, boids.vy, boids.count);
+
+    interact_rows(grid, params, 0, grid.gridHeight, new_boids.x, new_boids.y, new_boids.vx, new_boids.vy, deltaTime, windowWidth, windowHeight);
+}
+
+// come sopra con una griglia locale: rientrante, ma alloca la griglia a ogni chiamata
+void update_all_boids(const Boids& boids, Boids& new_boids, float deltaTime, int windowWidth, int windowHeight)
+{
+    SortedGrid grid;
+    update_all_boids(boids, new_boids, grid, deltaTime, windowWidth, windowHeight);
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+// struttura per rappresentare dei boids (stesso layout SoA di omp_soa)
+struct Boids {
+    float* x;
+    float* y;
+    float* vx;
+    float* vy;
+    int count;
+};
+
+class SortedGrid;
+
+// funzione per aggiornare la posizione di tutti i boids (single thread, double buffering: legge da boids e scrive in new_boids);
+// grid (spatial_grid.h) appartiene al chiamante ed è riusata fra i time step, quindi nessuna allocazione a regime
+void update_all_boids(const Boids& boids, Boids& new_boids, SortedGrid& grid, float deltaTime, int windowWidth, int windowHeight);
+// come sopra con una griglia locale (alloca a ogni chiamata)
+void update_all_boids(const Boids& boids, Boids& new_boids, float deltaTime, int windowWidth, int windowHeight);
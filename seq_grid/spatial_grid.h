@@ -0,0 +1,92 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// griglia uniforme piatta con copia dei boids ordinata per cella (counting sort):
+// i boids di celle consecutive sulla stessa riga sono contigui in memoria, quindi le 3 celle di una riga
+// dello stencil 3x3 formano un unico intervallo che il kernel può scorrere con load vettoriali
+class SortedGrid
+{
+public:
+    // copia ordinata per cella dello stato corrente
+    std::vector<float> x, y, vx, vy;
+    // indice originale di ogni boid ordinato
+    std::vector<int> id;
+    // inizio di ogni cella nella copia ordinata (numCells + 1 elementi)
+    std::vector<int> cellStart;
+
+    int gridWidth = 0;
+    int gridHeight = 0;
+
+    // adatta le dimensioni della griglia e dei buffer (nessuna allocazione se non cambiano)
+    void resize(float cellSize, int worldWidth, int worldHeight, int numBoids)
+    {
+        this->cellSize = cellSize;
+        gridWidth  = static_cast<int>(std::ceil(worldWidth  / cellSize));
+        gridHeight = static_cast<int>(std::ceil(worldHeight / cellSize));
+
+        cellStart.resize(gridWidth * gridHeight + 1);
+        cellOf.resize(numBoids);
+        x.resize(numBoids);
+        y.resize(numBoids);
+        vx.resize(numBoids);
+        vy.resize(numBoids);
+        id.resize(numBoids);
+    }
+
+    // ordina i boids per cella
+    void build(const float* bx, const float* by, const float* bvx, const float* bvy, int numBoids)
+    {
+        const int numCells = gridWidth * gridHeight;
+
+        // conteggio (spostato di una posizione per ottenere direttamente gli inizi con la prefix sum)
+        std::fill(cellStart.begin(), cellStart.end(), 0);
+        for (int i = 0; i < numBoids; ++i) {
+            cellOf[i] = world_to_cell(bx[i], by[i]);
+            cellStart[cellOf[i] + 1]++;
+        }
+
+        // prefix sum
+        for (int c = 0; c < numCells; ++c)
+            cellStart[c + 1] += cellStart[c];
+
+        // scatter nella copia ordinata (cellOf viene riusato come cursore di scrittura)
+        for (int i = 0; i < numBoids; ++i) {
+            const int k = cellStart[cellOf[i]]++;
+            x[k] = bx[i];
+            y[k] = by[i];
+            vx[k] = bvx[i];
+            vy[k] = bvy[i];
+            id[k] = i;
+        }
+
+        // lo scatter ha spostato ogni inizio alla fine della propria cella: ripristina
+        for (int c = numCells; c > 0; --c)
+            cellStart[c] = cellStart[c - 1];
+        cellStart[0] = 0;
+    }
+
+    // indice 1d della cella (cx, cy)
+    inline int cell_index(int cx, int cy) const
+    {
+        return cy * gridWidth + cx;
+    }
+
+private:
+    float cellSize = 1.0f;
+    std::vector<int> cellOf;
+
+    // trasforma coordinate da world a grid 1d (i boids fuori dal mondo finiscono nelle celle di bordo)
+    inline int world_to_cell(float px, float py) const
+    {
+        int cx = static_cast<int>(std::floor(px / cellSize));
+        int cy = static_cast<int>(std::floor(py / cellSize));
+
+        cx = std::clamp(cx, 0, gridWidth  - 1);
+        cy = std::clamp(cy, 0, gridHeight - 1);
+
+        return cy * gridWidth + cx;
+    }
+};
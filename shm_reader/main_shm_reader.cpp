@@ -0,0 +1,77 @@
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+
+#include "../omp_soa/shm_frames.h"
+
+// lettore d'esempio del ring di frame pubblicato dal driver SoA (shm_publish_on): copia ogni nuovo frame,
+// calcola centro e velocità media dello stormo e stampa ogni secondo i frame letti, quelli persi e le copie scartate
+// uso: PP_mid_assignment_shm_reader [nome segmento] [secondi massimi]
+
+int main(int argc, char* argv[])
+{
+    const char* name = argc > 1 ? argv[1] : shm_frames_name;
+    const double maxSeconds = argc > 2 ? std::atof(argv[2]) : 60.0;
+
+    // attende che il writer crei il segmento
+    ShmFrameReader reader;
+    const auto start = std::chrono::steady_clock::now();
+    while (!reader.open(name)) {
+        if (std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() > maxSeconds) {
+            std::cerr << "Shared memory segment " << name << " not found." << std::endl;
+            return 1;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    std::cout << "Segmento " << name << ": " << reader.header().numFrames << " frame da " << reader.header().capacity << " boids." << std::endl;
+
+    ShmFrameCopy frame;
+    long long framesRead = 0, framesMissed = 0, retries = 0;
+    long long windowFrames = 0;
+    auto windowStart = std::chrono::steady_clock::now();
+    auto lastFrame = windowStart;
+
+    while (true) {
+        const uint64_t previous = frame.generation;
+        if (reader.read_latest(frame, &retries)) {
+            // generazioni saltate: frame pubblicati mentre il lettore era occupato
+            if (previous > 0)
+                framesMissed += static_cast<long long>(frame.generation - previous - 1);
+            framesRead++;
+            windowFrames++;
+            lastFrame = std::chrono::steady_clock::now();
+        } else {
+            if (reader.writer_closed())
+                break;
+            // nessun frame nuovo: il lettore non scrive mai nel segmento, quindi può solo attendere
+            // (se resta indietro salta direttamente all'ultimo frame, i frame intermedi vengono contati come persi)
+            if (std::chrono::duration<double>(std::chrono::steady_clock::now() - lastFrame).count() > 5.0)
+                break;
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        const double elapsed = std::chrono::duration<double>(now - windowStart).count();
+        if (elapsed >= 1.0 && frame.count > 0) {
+            // statistiche dell'ultimo frame copiato (lo stato condiviso non viene mai letto fuori dal seqlock)
+            double cx = 0.0, cy = 0.0, speed = 0.0;
+            for (int i = 0; i < frame.count; ++i) {
+                cx += frame.x[i];
+                cy += frame.y[i];
+                speed += std::sqrt(frame.vx[i] * frame.vx[i] + frame.vy[i] * frame.vy[i]);
+            }
+            std::cout << "time step " << frame.step << ", " << frame.count << " boids: " << windowFrames / elapsed << " frame/s, centro ("
+                      << cx / frame.count << ", " << cy / frame.count << "), velocità media " << speed / frame.count
+                      << " | letti " << framesRead << ", persi " << framesMissed << ", copie scartate " << retries << std::endl;
+            windowFrames = 0;
+            windowStart = now;
+        }
+        if (std::chrono::duration<double>(now - start).count() > maxSeconds)
+            break;
+    }
+
+    std::cout << "Frame letti: " << framesRead << ", persi: " << framesMissed << ", copie scartate: " << retries << "." << std::endl;
+    return 0;
+}